@@ -0,0 +1,118 @@
+#include <print>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "../include/BodyStore.h"
+#include "../include/Forces.h"
+#include "../include/Fmm.h"
+#include "../include/SimdKernels.h"
+
+// FMM误差与展开阶数的关系：对均匀与成团两种分布，分别只开引力或只开库仑力，
+// 以合并内核的精确两两求和为参考，逐阶输出相对误差（rms/最大）与耗时，自适应树与均匀树各一组
+static void FillBodies(BodyStore& bodies, size_t n, bool clustered, bool charged) {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> mass(1.0f, 100.0f);
+    std::normal_distribution<float> spread(0.0f, 0.08f);
+
+    // 成团分布：8个高斯团，团的中心均匀分布
+    float centerX[8], centerY[8];
+    for (int c = 0; c < 8; c++) {
+        centerX[c] = 0.8f * unit(rng);
+        centerY[c] = 0.8f * unit(rng);
+    }
+
+    bodies.clear();
+    bodies.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        float x = unit(rng), y = unit(rng);
+        if (clustered) {
+            x = std::clamp(centerX[i % 8] + spread(rng), -1.0f, 1.0f);
+            y = std::clamp(centerY[i % 8] + spread(rng), -1.0f, 1.0f);
+        }
+        const float charge = charged ? (i % 2 ? 1e-6f : -1e-6f) : 0.0f;
+        bodies.add(x, y, 0.01f, mass(rng), charge, BODY_MOVABLE);
+    }
+}
+
+static void ClearAcceleration(BodyStore& bodies) {
+    std::fill(bodies.ax.begin(), bodies.ax.end(), 0.0f);
+    std::fill(bodies.ay.begin(), bodies.ay.end(), 0.0f);
+}
+
+template <typename F>
+static double TimeMilliseconds(BodyStore& bodies, F&& kernel) {
+    ClearAcceleration(bodies);
+    kernel();  // 预热（FMM的容器增长到所需大小）
+    ClearAcceleration(bodies);
+    const auto start = std::chrono::steady_clock::now();
+    kernel();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 10000;
+    const int maxOrder = argc > 2 ? std::clamp(std::atoi(argv[2]), 1, FmmSolver::MAX_ORDER) : 10;
+    const unsigned threads = argc > 3 ? static_cast<unsigned>(std::max(1, std::atoi(argv[3]))) : 1;
+    const SimdLevel level = DetectSimdLevel();
+
+    ThreadPool pool;
+    pool.resize(threads);
+    std::println("{} bodies, orders 1..{}, {} threads, near field: {}", n, maxOrder, threads, SimdLevelName(level));
+    std::println("{:<10} {:<8} {:<9} {:>3} {:>10} {:>10} {:>10} {:>8}", "scene", "kernel", "tree", "p",
+                 "rms err", "max err", "ms", "speedup");
+
+    BodyStore bodies;
+    for (bool clustered : { false, true }) {
+        for (bool charged : { false, true }) {
+            FillBodies(bodies, n, clustered, charged);
+            const char* scene = clustered ? "clustered" : "uniform";
+            const char* kernel = charged ? "coulomb" : "gravity";
+            FusedForceParams params;
+            params.gravity = !charged;
+            params.coulomb = charged;
+
+            // 参考：标量合并内核的精确两两求和；计时用最快的向量内核
+            ClearAcceleration(bodies);
+            ApplyFusedForces(bodies, 0, n, params, SimdLevel::Scalar);
+            const AlignedVector<float> refX = bodies.ax;
+            const AlignedVector<float> refY = bodies.ay;
+            const double exactMs = TimeMilliseconds(bodies, [&] { ApplyFusedForces(bodies, 0, n, params, level); });
+            std::println("{:<10} {:<8} {:<9} {:>3} {:>10} {:>10} {:>10.2f} {:>8}", scene, kernel, "exact", "-",
+                         "-", "-", exactMs, "1.00");
+
+            if (!charged) {
+                const GravityAccuracyReport report = MeasureBarnesHutAccuracy(bodies, 0.5f);
+                std::println("{:<10} {:<8} {:<9} {:>3} {:>10.2e} {:>10.2e} {:>10.2f} {:>8.2f}", scene, kernel,
+                             "bh 0.5", "-", report.rmsRelativeError, report.maxRelativeError,
+                             report.treeMilliseconds, exactMs / report.treeMilliseconds);
+            }
+
+            for (bool adaptive : { true, false }) {
+                for (int p = 1; p <= maxOrder; p++) {
+                    FmmSolver fmm;
+                    fmm.settings.order = p;
+                    fmm.settings.adaptive = adaptive;
+                    const double ms = TimeMilliseconds(bodies, [&] { fmm.apply(bodies, pool, params, level); });
+
+                    double sumSq = 0.0, worst = 0.0;
+                    size_t samples = 0;
+                    for (size_t i = 0; i < n; i++) {
+                        const double ref = std::hypot(refX[i], refY[i]);
+                        if (ref == 0.0) continue;
+                        const double err = std::hypot(bodies.ax[i] - refX[i], bodies.ay[i] - refY[i]) / ref;
+                        sumSq += err * err;
+                        worst = std::max(worst, err);
+                        samples++;
+                    }
+                    std::println("{:<10} {:<8} {:<9} {:>3} {:>10.2e} {:>10.2e} {:>10.2f} {:>8.2f}", scene, kernel,
+                                 adaptive ? "adaptive" : "uniform", p, std::sqrt(sumSq / std::max<size_t>(1, samples)),
+                                 worst, ms, exactMs / ms);
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <print>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "../include/BodyStore.h"
+#include "../include/Forces.h"
+#include "../include/SimdKernels.h"
+
+// 两两作用力内核的基准：原标量路径（引力+库仑两遍）与合并内核各指令集的每秒相互作用数
+static void FillBodies(BodyStore& bodies, size_t n) {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> pos(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> mass(1.0f, 100.0f);
+    std::uniform_real_distribution<float> charge(-1e-6f, 1e-6f);
+
+    bodies.clear();
+    bodies.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        // 随机数依次取出，不依赖参数的求值顺序
+        const float x = pos(rng);
+        const float y = pos(rng);
+        const float m = mass(rng);
+        const float q = charge(rng);
+        bodies.add(x, y, 0.01f, m, q, BODY_MOVABLE);
+    }
+}
+
+static void ClearAcceleration(BodyStore& bodies) {
+    std::fill(bodies.ax.begin(), bodies.ax.end(), 0.0f);
+    std::fill(bodies.ay.begin(), bodies.ay.end(), 0.0f);
+}
+
+template <typename F>
+static double TimeSteps(BodyStore& bodies, int steps, F&& kernel) {
+    ClearAcceleration(bodies);
+    kernel();  // 预热
+    const auto start = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) {
+        ClearAcceleration(bodies);
+        kernel();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / steps;
+}
+
+// 与参考加速度的最大相对误差
+static double MaxRelativeError(const BodyStore& bodies, const AlignedVector<float>& refX, const AlignedVector<float>& refY) {
+    double worst = 0.0;
+    for (size_t i = 0; i < bodies.size(); i++) {
+        const double ref = std::hypot(refX[i], refY[i]);
+        if (ref == 0.0) continue;
+        const double err = std::hypot(bodies.ax[i] - refX[i], bodies.ay[i] - refY[i]);
+        worst = std::max(worst, err / ref);
+    }
+    return worst;
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 4096;
+    const int steps = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+
+    BodyStore bodies;
+    FillBodies(bodies, n);
+    const double interactions = static_cast<double>(n) * static_cast<double>(n - 1);
+
+    std::println("{} bodies, {} steps, detected SIMD: {}", n, steps, SimdLevelName(DetectSimdLevel()));
+
+    const double legacy = TimeSteps(bodies, steps, [&] {
+        ApplyUniversalGravitation(bodies);
+        ApplyCoulombForce(bodies);
+    });
+    std::println("{:<16} {:>10.3f} ms/step {:>10.1f} M interactions/s", "legacy scalar",
+                 legacy * 1e3, interactions / legacy * 1e-6);
+
+    FusedForceParams params;
+    ClearAcceleration(bodies);
+    ApplyFusedForces(bodies, 0, n, params, SimdLevel::Scalar);
+    const AlignedVector<float> refX = bodies.ax;
+    const AlignedVector<float> refY = bodies.ay;
+
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::NEON, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level != SimdLevel::Scalar && level != DetectSimdLevel() &&
+            !(level == SimdLevel::AVX2 && DetectSimdLevel() == SimdLevel::AVX512)) {
+            continue;
+        }
+        const double seconds = TimeSteps(bodies, steps, [&] { ApplyFusedForces(bodies, 0, n, params, level); });
+        std::println("fused {:<10} {:>10.3f} ms/step {:>10.1f} M interactions/s  (x{:.2f}, max rel err {:.2e})",
+                     SimdLevelName(level), seconds * 1e3, interactions / seconds * 1e-6, legacy / seconds,
+                     MaxRelativeError(bodies, refX, refY));
+    }
+    return 0;
+}
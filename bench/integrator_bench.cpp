@@ -0,0 +1,88 @@
+#include <print>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "../include/World.h"
+
+// 积分方法的能量漂移与耗时：保守的引力场景（无外场、不休眠、物体很小基本不碰撞），
+// 每种方法在几个步长下推进相同的模拟时间，逐步测量总能量相对初值的偏差。
+// 计时只含world.step，能量测量不计入；比较同等误差下各方法的CPU时间
+static void BuildOrbit(World& world, int bodies) {
+    // 固定中心质量加上一盘试验粒子般的卫星（与physics2d_bench的galaxy相似，但卫星轻得多，
+    // 相互引力不会把轨道扰乱）。轨道半径各不相同且间距大于物体直径，圆轨道互不相交，避免碰撞改变能量
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float centralMass = 1e10f;
+    const float radius = std::min(0.0005f, 0.15f / bodies);
+    world.addCircle(0.0f, 0.0f, 0.03f, centralMass, 0.0f, false, 16);
+    for (int i = 1; i < bodies; i++) {
+        const float r = 0.15f + 0.7f * i / bodies;
+        const float angle = 6.2831853f * unit(rng);
+        const float speed = std::sqrt(static_cast<float>(G) * centralMass / r);
+        Circle& body = world.addCircle(r * std::cos(angle), r * std::sin(angle), radius, 1.0f, 0.0f, true, 16);
+        body.setVelocity(-speed * std::sin(angle), speed * std::cos(angle));
+    }
+}
+
+static void BuildBinary(World& world, int) {
+    // 两个等质量物体的偏心轨道（e = 0.5，半长轴0.3），从远点出发，近点处步长误差最大
+    const float mass = 1e10f;
+    const float semiMajor = 0.3f, eccentricity = 0.5f;
+    const float apoapsis = semiMajor * (1.0f + eccentricity);
+    const float speed = std::sqrt(static_cast<float>(G) * 2.0f * mass * (1.0f - eccentricity) / apoapsis);
+    world.addCircle(-apoapsis / 2, 0.0f, 0.01f, mass, 0.0f, true, 16).setVelocity(0.0f, -speed / 2);
+    world.addCircle(apoapsis / 2, 0.0f, 0.01f, mass, 0.0f, true, 16).setVelocity(0.0f, speed / 2);
+}
+
+struct BenchScene {
+    const char* name;
+    void (*build)(World& world, int bodies);
+};
+
+int main(int argc, char** argv) {
+    const int bodies = argc > 1 ? std::max(2, std::atoi(argv[1])) : 100;
+    const float seconds = argc > 2 ? std::max(0.1f, std::strtof(argv[2], nullptr)) : 10.0f;
+    const unsigned threads = argc > 3 ? static_cast<unsigned>(std::max(1, std::atoi(argv[3]))) : 1;
+
+    const BenchScene scenes[] = { { "orbit", BuildOrbit }, { "binary", BuildBinary } };
+    const float rates[] = { 60.0f, 120.0f, 240.0f, 480.0f };
+
+    std::println("{} orbit bodies, {:.1f} s simulated, {} threads", bodies, seconds, threads);
+    std::println("{:<7} {:<9} {:>5} {:>6} {:>7} {:>9} {:>11} {:>11}", "scene", "method", "Hz", "steps", "evals",
+                 "ms", "max |dE/E|", "end |dE/E|");
+
+    for (const BenchScene& scene : scenes) {
+        for (int k = 0; k < INTEGRATOR_COUNT; k++) {
+            const Integrator integrator = static_cast<Integrator>(k);
+            for (float rate : rates) {
+                World world;
+                world.gf.magnitude = 0.0;
+                world.sleep.enabled = false;
+                world.integrator = integrator;
+                world.setThreadCount(threads);
+                scene.build(world, bodies);
+
+                const float dt = 1.0f / rate;
+                const int steps = static_cast<int>(std::lround(seconds * rate));
+                const double e0 = MeasureEnergy(world.bodies, world.gf, world.ef, world.fusedForces.softening).total();
+
+                double elapsed = 0.0, maxDrift = 0.0, drift = 0.0;
+                for (int s = 0; s < steps; s++) {
+                    const auto start = std::chrono::steady_clock::now();
+                    world.step(dt);
+                    elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                    const double e = MeasureEnergy(world.bodies, world.gf, world.ef, world.fusedForces.softening).total();
+                    drift = std::abs((e - e0) / e0);
+                    maxDrift = std::max(maxDrift, drift);
+                }
+                std::println("{:<7} {:<9} {:>5.0f} {:>6} {:>7} {:>9.2f} {:>11.3e} {:>11.3e}", scene.name,
+                             IntegratorName(integrator), rate, steps, steps * IntegratorStages(integrator),
+                             elapsed * 1e3, maxDrift, drift);
+            }
+        }
+    }
+    return 0;
+}
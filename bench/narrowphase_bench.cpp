@@ -0,0 +1,62 @@
+#include <print>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <algorithm>
+#include "../include/World.h"
+
+// 窄相基准：圆与多边形各半的场景，粗检测得到候选配对后，
+// 分别统计只做检测、检测加处理两种情况下每秒处理的配对数
+int main(int argc, char** argv) {
+    const int bodyCount = argc > 1 ? std::max(2, std::atoi(argv[1])) : 4000;
+    const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 200;
+
+    World world;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> pos(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> sides(3, 8);
+    for (int i = 0; i < bodyCount; i++) {
+        // 随机数依次取出，不依赖参数的求值顺序，各编译器得到相同的场景
+        const int sideCount = i % 2 ? 0 : sides(rng);
+        const float x = pos(rng);
+        const float y = pos(rng);
+        const float vx = pos(rng);
+        const float vy = pos(rng);
+        if (i % 2) {
+            world.addCircle(x, y, 0.02f, 1.0f, 0.0f, true);
+        } else {
+            world.addPolygon(sideCount, 0.02f, x, y, 1.0f, 0.0f, true);
+        }
+        world.objects.back()->setVelocity(vx, vy);
+    }
+
+    world.broadphase->findPairs(world.bodies, world.collisionPairs);
+    const PairList& pairs = world.collisionPairs;
+
+    size_t hits = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++) {
+        for (const BroadphasePair& pair : pairs) {
+            hits += TestCollision(world.bodies, pair.a, pair.b);
+        }
+    }
+    const double testSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 每轮先恢复初始状态，只计处理配对的时间
+    const BodyStore initial = world.bodies;
+    double fullSeconds = 0.0;
+    for (int it = 0; it < iterations; it++) {
+        world.bodies = initial;
+        const auto begin = std::chrono::steady_clock::now();
+        for (const BroadphasePair& pair : pairs) {
+            CollidePair(world.bodies, pair.a, pair.b);
+        }
+        fullSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    const double processed = static_cast<double>(pairs.size()) * iterations;
+    std::println("{} bodies, {} candidate pairs, {} contacts", bodyCount, pairs.size(), hits / iterations);
+    std::println("test only:      {:.2f} M pairs/s", processed / testSeconds * 1e-6);
+    std::println("test + resolve: {:.2f} M pairs/s", processed / fullSeconds * 1e-6);
+    return 0;
+}
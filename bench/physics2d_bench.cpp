@@ -0,0 +1,385 @@
+#include <print>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include "../include/World.h"
+
+// 整步基准：几个固定种子的典型场景，逐步计时后输出中位数、p99与每秒处理的物体·步数（JSON），
+// 同一场景可以在不同引力求解器、粗检测、力内核与积分方法组合下运行，用于回归门禁和后端比较
+
+namespace {
+
+struct SceneInfo {
+    const char* name;
+    int defaultBodies;
+    void (*build)(World& world, int bodies, std::mt19937& rng);
+};
+
+// 重力场下堆积的圆，底部开始按网格排列
+void BuildPile(World& world, int bodies, std::mt19937& rng) {
+    std::uniform_real_distribution<float> jitter(-0.002f, 0.002f);
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(bodies))));
+    const float radius = 0.9f / columns;
+    for (int i = 0; i < bodies; i++) {
+        const float x = -0.95f + (2.0f * (i % columns) + 1.0f) * radius + jitter(rng);
+        const float y = -0.95f + (2.0f * (i / columns) + 1.0f) * radius;
+        world.addCircle(x, y, radius * 0.9f, 1.0f, 0.0f, true, 16);
+    }
+}
+
+// 围绕固定中心质量做圆周运动的盘，外场为零，主要负载是两两引力
+void BuildGalaxy(World& world, int bodies, std::mt19937& rng) {
+    world.gf.magnitude = 0.0;
+    const float centralMass = 1e10f;
+    world.addCircle(0.0f, 0.0f, 0.03f, centralMass, 0.0f, false, 16);
+
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 1; i < bodies; i++) {
+        const float r = 0.1f + 0.8f * std::sqrt(unit(rng));
+        const float angle = 6.2831853f * unit(rng);
+        const float speed = std::sqrt(static_cast<float>(G) * centralMass / r);
+        Circle& body = world.addCircle(r * std::cos(angle), r * std::sin(angle), 0.004f, 1e5f, 0.0f, true, 16);
+        body.setVelocity(-speed * std::sin(angle), speed * std::cos(angle));
+    }
+}
+
+// 正负电荷各半的等离子体，没有重力场
+void BuildPlasma(World& world, int bodies, std::mt19937& rng) {
+    world.gf.magnitude = 0.0;
+    std::uniform_real_distribution<float> pos(-0.9f, 0.9f);
+    std::uniform_real_distribution<float> vel(-0.2f, 0.2f);
+    for (int i = 0; i < bodies; i++) {
+        // 随机数先依次取到局部变量：参数的求值顺序由编译器决定，直接写在参数里不同编译器得到的场景不同
+        const float x = pos(rng);
+        const float y = pos(rng);
+        const float vx = vel(rng);
+        const float vy = vel(rng);
+        world.addCircle(x, y, 0.005f, 1.0f, i % 2 ? 1e-4f : -1e-4f, true, 16).setVelocity(vx, vy);
+    }
+}
+
+// 圆与3~8边形混合，重力场下下落
+void BuildMixed(World& world, int bodies, std::mt19937& rng) {
+    std::uniform_real_distribution<float> pos(-0.9f, 0.9f);
+    std::uniform_int_distribution<int> sides(3, 8);
+    for (int i = 0; i < bodies; i++) {
+        const int sideCount = i % 2 ? 0 : sides(rng);
+        const float x = pos(rng);
+        const float y = pos(rng);
+        if (i % 2) {
+            world.addCircle(x, y, 0.012f, 1.0f, 0.0f, true, 16);
+        } else {
+            world.addPolygon(sideCount, 0.012f, x, y, 1.0f, 0.0f, true);
+        }
+    }
+}
+
+// 稀疏气体：小半径、随机速度、无外场，碰撞很少
+void BuildGas(World& world, int bodies, std::mt19937& rng) {
+    world.gf.magnitude = 0.0;
+    std::uniform_real_distribution<float> pos(-0.95f, 0.95f);
+    std::uniform_real_distribution<float> vel(-1.0f, 1.0f);
+    for (int i = 0; i < bodies; i++) {
+        const float x = pos(rng);
+        const float y = pos(rng);
+        const float vx = vel(rng);
+        const float vy = vel(rng);
+        world.addCircle(x, y, 0.002f, 1.0f, 0.0f, true, 16).setVelocity(vx, vy);
+    }
+}
+
+const SceneInfo SCENES[] = {
+    { "pile", 2000, BuildPile },
+    { "galaxy", 2000, BuildGalaxy },
+    { "plasma", 2000, BuildPlasma },
+    { "mixed", 2000, BuildMixed },
+    { "gas", 4000, BuildGas },
+};
+
+struct Backend {
+    GravitySolver gravity;
+    BroadphaseType broadphase;
+    ForceKernel kernel;
+    Integrator integrator;
+};
+
+const char* GravityName(GravitySolver solver) {
+    switch (solver) {
+        case GravitySolver::BarnesHut: return "barnes-hut";
+        case GravitySolver::Fmm: return "fmm";
+        case GravitySolver::ParticleMesh: return "pm";
+        default: return "exact";
+    }
+}
+
+const char* BroadphaseName(BroadphaseType type) {
+    switch (type) {
+        case BroadphaseType::BruteForce: return "brute-force";
+        case BroadphaseType::SweepAndPrune: return "sap";
+        case BroadphaseType::AabbTree: return "aabb-tree";
+        default: return "spatial-hash";
+    }
+}
+
+const char* KernelName(ForceKernel kernel) {
+    return kernel == ForceKernel::Scalar ? "scalar" : "simd";
+}
+
+// 逗号分隔的列表，"all"表示全部取值
+template <typename T>
+bool ParseList(const std::string& text, const std::vector<std::pair<const char*, T>>& values, std::vector<T>& out) {
+    out.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        const size_t comma = std::min(text.find(',', start), text.size());
+        const std::string item = text.substr(start, comma - start);
+        bool found = false;
+        for (const auto& [name, value] : values) {
+            if (item == "all" || item == name) {
+                if (std::find(out.begin(), out.end(), value) == out.end()) out.push_back(value);
+                found = true;
+            }
+        }
+        if (!found) return false;
+        start = comma + 1;
+    }
+    return true;
+}
+
+// 结果的比较键：场景、物体数与后端组合都相同才可比较
+std::string ResultKey(const std::string& scene, size_t bodies, const std::string& gravity,
+                      const std::string& broadphase, const std::string& kernel, const std::string& integrator) {
+    return scene + "/" + std::to_string(bodies) + "/" + gravity + "/" + broadphase + "/" + kernel + "/" + integrator;
+}
+
+// 取出一行结果中某个字段的值（去掉引号）
+std::string Field(const std::string& line, const std::string& key) {
+    const std::string pattern = "\"" + key + "\": ";
+    const size_t at = line.find(pattern);
+    if (at == std::string::npos) return {};
+    const size_t begin = at + pattern.size();
+    const size_t end = line.find_first_of(",}", begin);
+    std::string value = line.substr(begin, end - begin);
+    std::erase(value, '"');
+    while (!value.empty() && value.back() == ' ') value.pop_back();
+    return value;
+}
+
+// 读取本程序先前输出的报告（每个结果一行），得到各组合的中位数
+bool LoadBaseline(const std::string& path, std::map<std::string, double>& medians) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        const std::string scene = Field(line, "scene");
+        if (scene.empty()) continue;
+        // 早先的报告没有积分方法字段，都是半隐式欧拉
+        std::string integrator = Field(line, "integrator");
+        if (integrator.empty()) integrator = IntegratorName(Integrator::SemiImplicitEuler);
+        const std::string key = ResultKey(scene, std::strtoull(Field(line, "bodies").c_str(), nullptr, 10),
+                                          Field(line, "gravity"), Field(line, "broadphase"), Field(line, "kernel"),
+                                          integrator);
+        medians[key] = std::strtod(Field(line, "median_ms").c_str(), nullptr);
+    }
+    return true;
+}
+
+void PrintUsage() {
+    std::println("Usage: physics2d_bench [options]");
+    std::println("  --scene <list>       pile,galaxy,plasma,mixed,gas or all (default all)");
+    std::println("  --bodies <n>         override the body count of every scene");
+    std::println("  --steps <n>          timed steps per run (default 200)");
+    std::println("  --warmup <n>         untimed steps before timing (default 20)");
+    std::println("  --seed <n>           scene random seed (default 42)");
+    std::println("  --threads <n>        worker threads for force kernels (default 1)");
+    std::println("  --gravity <list>     exact,barnes-hut,fmm,pm or all (default exact)");
+    std::println("  --broadphase <list>  spatial-hash,sap,aabb-tree,brute-force or all (default spatial-hash)");
+    std::println("  --kernel <list>      simd,scalar or all (default simd)");
+    std::println("  --integrator <list>  euler,leapfrog,yoshida4,rk4 or all (default euler)");
+    std::println("  --out <file>         write the JSON report to a file instead of stdout");
+    std::println("  --baseline <file>    compare medians with an earlier report, exit 3 on regression");
+    std::println("  --tolerance <frac>   allowed median slowdown against the baseline (default 0.10)");
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string sceneList = "all";
+    int bodiesOverride = 0;
+    int steps = 200;
+    int warmup = 20;
+    unsigned seed = 42;
+    unsigned threads = 1;
+    std::string outPath;
+    std::string baselinePath;
+    double tolerance = 0.10;
+
+    std::vector<const SceneInfo*> scenes;
+    std::vector<GravitySolver> gravities { GravitySolver::Exact };
+    std::vector<BroadphaseType> broadphases { BroadphaseType::SpatialHash };
+    std::vector<ForceKernel> kernels { ForceKernel::Simd };
+    std::vector<Integrator> integrators { Integrator::SemiImplicitEuler };
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        bool ok = true;
+
+        if (arg == "--scene" && hasValue) {
+            sceneList = argv[++i];
+        } else if (arg == "--bodies" && hasValue) {
+            bodiesOverride = std::max(2, std::atoi(argv[++i]));
+        } else if (arg == "--steps" && hasValue) {
+            steps = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--warmup" && hasValue) {
+            warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--threads" && hasValue) {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--gravity" && hasValue) {
+            ok = ParseList<GravitySolver>(argv[++i], { { "exact", GravitySolver::Exact },
+                                                       { "barnes-hut", GravitySolver::BarnesHut },
+                                                       { "fmm", GravitySolver::Fmm },
+                                                       { "pm", GravitySolver::ParticleMesh } }, gravities);
+        } else if (arg == "--broadphase" && hasValue) {
+            ok = ParseList<BroadphaseType>(argv[++i], { { "spatial-hash", BroadphaseType::SpatialHash },
+                                                        { "sap", BroadphaseType::SweepAndPrune },
+                                                        { "aabb-tree", BroadphaseType::AabbTree },
+                                                        { "brute-force", BroadphaseType::BruteForce } }, broadphases);
+        } else if (arg == "--kernel" && hasValue) {
+            ok = ParseList<ForceKernel>(argv[++i], { { "simd", ForceKernel::Simd },
+                                                     { "scalar", ForceKernel::Scalar } }, kernels);
+        } else if (arg == "--integrator" && hasValue) {
+            std::vector<std::pair<const char*, Integrator>> integratorValues;
+            for (int k = 0; k < INTEGRATOR_COUNT; k++) {
+                integratorValues.emplace_back(IntegratorName(static_cast<Integrator>(k)), static_cast<Integrator>(k));
+            }
+            ok = ParseList<Integrator>(argv[++i], integratorValues, integrators);
+        } else if (arg == "--out" && hasValue) {
+            outPath = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            baselinePath = argv[++i];
+        } else if (arg == "--tolerance" && hasValue) {
+            tolerance = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::println(stderr, "Unknown or incomplete argument: {}", arg);
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::vector<std::pair<const char*, const SceneInfo*>> sceneValues;
+    for (const SceneInfo& scene : SCENES) {
+        sceneValues.emplace_back(scene.name, &scene);
+    }
+    if (!ParseList<const SceneInfo*>(sceneList, sceneValues, scenes)) {
+        std::println(stderr, "Unknown scene in: {}", sceneList);
+        return 1;
+    }
+
+    std::vector<Backend> backends;
+    for (GravitySolver gravity : gravities) {
+        for (BroadphaseType broadphase : broadphases) {
+            for (ForceKernel kernel : kernels) {
+                for (Integrator integrator : integrators) {
+                    backends.push_back({ gravity, broadphase, kernel, integrator });
+                }
+            }
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty() && !LoadBaseline(baselinePath, baseline)) {
+        std::println(stderr, "Error: cannot read {}", baselinePath);
+        return 1;
+    }
+
+    FILE* out = outPath.empty() ? stdout : std::fopen(outPath.c_str(), "w");
+    if (!out) {
+        std::println(stderr, "Error: cannot write {}", outPath);
+        return 1;
+    }
+
+    World probe;
+    std::println(out, "{{");
+    std::println(out, "  \"seed\": {}, \"steps\": {}, \"warmup\": {}, \"threads\": {}, \"simd\": \"{}\",",
+                 seed, steps, warmup, threads, SimdLevelName(probe.simdLevel));
+    std::println(out, "  \"results\": [");
+
+    bool first = true;
+    int regressions = 0;
+    for (const SceneInfo* scene : scenes) {
+        const int bodies = bodiesOverride > 0 ? bodiesOverride : scene->defaultBodies;
+        for (const Backend& backend : backends) {
+            // 每种组合都从相同种子重新生成场景，保证输入完全一致
+            World world;
+            std::mt19937 rng(seed);
+            scene->build(world, bodies, rng);
+            world.gravitySolver = backend.gravity;
+            world.setBroadphase(backend.broadphase);
+            world.forceKernel = backend.kernel;
+            world.integrator = backend.integrator;
+            world.setThreadCount(threads);
+
+            const float dt = world.clock.getFixedDeltaTime();
+            for (int s = 0; s < warmup; s++) {
+                world.step(dt);
+            }
+
+            std::vector<double> times(steps);
+            for (int s = 0; s < steps; s++) {
+                const auto start = std::chrono::steady_clock::now();
+                world.step(dt);
+                times[s] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            double total = 0.0;
+            for (double t : times) total += t;
+            std::sort(times.begin(), times.end());
+            const double median = times[times.size() / 2];
+            const double p99 = times[std::min(times.size() - 1, static_cast<size_t>(std::ceil(0.99 * times.size())) - 1)];
+            const double bodySteps = static_cast<double>(world.bodies.size()) * steps / total;
+
+            std::println(stderr, "{:<7} {:>6} bodies  {:<10} {:<12} {:<6} {:<8}  median {:8.3f} ms  p99 {:8.3f} ms",
+                         scene->name, world.bodies.size(), GravityName(backend.gravity),
+                         BroadphaseName(backend.broadphase), KernelName(backend.kernel),
+                         IntegratorName(backend.integrator), median * 1e3, p99 * 1e3);
+
+            std::print(out, "{}    {{ \"scene\": \"{}\", \"bodies\": {}, \"gravity\": \"{}\", \"broadphase\": \"{}\", "
+                       "\"kernel\": \"{}\", \"integrator\": \"{}\", \"median_ms\": {:.4f}, \"p99_ms\": {:.4f}, \"mean_ms\": {:.4f}, "
+                       "\"body_steps_per_second\": {:.0f} }}",
+                       first ? "" : ",\n", scene->name, world.bodies.size(), GravityName(backend.gravity),
+                       BroadphaseName(backend.broadphase), KernelName(backend.kernel),
+                       IntegratorName(backend.integrator), median * 1e3, p99 * 1e3, total / steps * 1e3, bodySteps);
+            first = false;
+
+            const auto base = baseline.find(ResultKey(scene->name, world.bodies.size(), GravityName(backend.gravity),
+                                                      BroadphaseName(backend.broadphase), KernelName(backend.kernel),
+                                                      IntegratorName(backend.integrator)));
+            if (base != baseline.end() && median * 1e3 > base->second * (1.0 + tolerance)) {
+                std::println(stderr, "  regression: median {:.3f} ms vs baseline {:.3f} ms", median * 1e3, base->second);
+                regressions++;
+            }
+        }
+    }
+
+    std::println(out, "\n  ]");
+    std::println(out, "}}");
+    if (out != stdout) std::fclose(out);
+    return regressions > 0 ? 3 : 0;
+}
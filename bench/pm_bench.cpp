@@ -0,0 +1,119 @@
+#include <print>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "../include/BodyStore.h"
+#include "../include/ParticleMesh.h"
+#include "../include/SimdKernels.h"
+
+// 粒子-网格方法的误差与耗时：对均匀与成团两种分布，分别只开引力或只开库仑力，
+// 逐个网格尺寸比较纯PM与P3M、TSC与CIC分配。参考为前SAMPLE_COUNT个物体（随机排列）的精确两两求和，
+// 精确求和的全量耗时按这部分目标的耗时外推
+constexpr size_t SAMPLE_COUNT = 1024;
+
+static void FillBodies(BodyStore& bodies, size_t n, bool clustered, bool charged) {
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> mass(1.0f, 100.0f);
+    std::normal_distribution<float> spread(0.0f, 0.08f);
+
+    float centerX[8], centerY[8];
+    for (int c = 0; c < 8; c++) {
+        centerX[c] = 0.8f * unit(rng);
+        centerY[c] = 0.8f * unit(rng);
+    }
+
+    bodies.clear();
+    bodies.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        float x = unit(rng), y = unit(rng);
+        if (clustered) {
+            x = std::clamp(centerX[i % 8] + spread(rng), -1.0f, 1.0f);
+            y = std::clamp(centerY[i % 8] + spread(rng), -1.0f, 1.0f);
+        }
+        const float charge = charged ? (i % 2 ? 1e-6f : -1e-6f) : 0.0f;
+        bodies.add(x, y, 0.01f, mass(rng), charge, BODY_MOVABLE);
+    }
+}
+
+static void ClearAcceleration(BodyStore& bodies) {
+    std::fill(bodies.ax.begin(), bodies.ax.end(), 0.0f);
+    std::fill(bodies.ay.begin(), bodies.ay.end(), 0.0f);
+}
+
+template <typename F>
+static double TimeMilliseconds(BodyStore& bodies, F&& kernel) {
+    ClearAcceleration(bodies);
+    kernel();  // 预热（网格与核的频谱分配到所需大小）
+    ClearAcceleration(bodies);
+    const auto start = std::chrono::steady_clock::now();
+    kernel();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::max<size_t>(SAMPLE_COUNT, static_cast<size_t>(std::atoll(argv[1]))) : 100000;
+    const int maxGrid = argc > 2 ? std::clamp(std::atoi(argv[2]), ParticleMeshSolver::MIN_GRID, ParticleMeshSolver::MAX_GRID) : 512;
+    const unsigned threads = argc > 3 ? static_cast<unsigned>(std::max(1, std::atoi(argv[3]))) : 1;
+    const SimdLevel level = DetectSimdLevel();
+
+    ThreadPool pool;
+    pool.resize(threads);
+    std::println("{} bodies, grids 64..{}, {} threads, error over {} targets", n, maxGrid, threads, SAMPLE_COUNT);
+    std::println("{:<10} {:<8} {:<8} {:>5} {:>10} {:>10} {:>10} {:>8} {:>12}", "scene", "kernel", "mode", "grid",
+                 "rms err", "max err", "ms", "speedup", "pairs");
+
+    BodyStore bodies;
+    for (bool clustered : { false, true }) {
+        for (bool charged : { false, true }) {
+            FillBodies(bodies, n, clustered, charged);
+            const char* scene = clustered ? "clustered" : "uniform";
+            const char* kernel = charged ? "coulomb" : "gravity";
+            FusedForceParams params;
+            params.gravity = !charged;
+            params.coulomb = charged;
+
+            const ForceArrays arrays { bodies.x.data(), bodies.y.data(), bodies.mass.data(), bodies.charge.data(),
+                                       bodies.invMass.data(), bodies.flags.data(), bodies.ax.data(), bodies.ay.data() };
+            ClearAcceleration(bodies);
+            ApplyFusedForcesRange(arrays, 0, SAMPLE_COUNT, 0, n, params, SimdLevel::Scalar);
+            const std::vector<float> refX(bodies.ax.begin(), bodies.ax.begin() + SAMPLE_COUNT);
+            const std::vector<float> refY(bodies.ay.begin(), bodies.ay.begin() + SAMPLE_COUNT);
+            const double exactMs = TimeMilliseconds(bodies, [&] {
+                ApplyFusedForcesRange(arrays, 0, SAMPLE_COUNT, 0, n, params, level);
+            }) * static_cast<double>(n) / SAMPLE_COUNT;
+            std::println("{:<10} {:<8} {:<8} {:>5} {:>10} {:>10} {:>10.2f} {:>8} {:>12}", scene, kernel, "exact", "-",
+                         "-", "-", exactMs, "1.00", "-");
+
+            const char* modeNames[2][2] = { { "pm-tsc", "pm-cic" }, { "p3m-tsc", "p3m-cic" } };
+            for (bool p3m : { false, true }) {
+                for (MeshAssignment assignment : { MeshAssignment::Tsc, MeshAssignment::Cic }) {
+                    for (int grid = 64; grid <= maxGrid; grid *= 2) {
+                        ParticleMeshSolver mesh;
+                        mesh.settings.gridSize = grid;
+                        mesh.settings.p3m = p3m;
+                        mesh.settings.assignment = assignment;
+                        const double ms = TimeMilliseconds(bodies, [&] { mesh.apply(bodies, pool, params); });
+
+                        double sumSq = 0.0, worst = 0.0;
+                        size_t samples = 0;
+                        for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+                            const double ref = std::hypot(refX[i], refY[i]);
+                            if (ref == 0.0) continue;
+                            const double err = std::hypot(bodies.ax[i] - refX[i], bodies.ay[i] - refY[i]) / ref;
+                            sumSq += err * err;
+                            worst = std::max(worst, err);
+                            samples++;
+                        }
+                        std::println("{:<10} {:<8} {:<8} {:>5} {:>10.2e} {:>10.2e} {:>10.2f} {:>8.2f} {:>12}", scene, kernel,
+                                     modeNames[p3m][static_cast<int>(assignment)], grid, std::sqrt(sumSq / std::max<size_t>(1, samples)),
+                                     worst, ms, exactMs / ms, mesh.shortRangePairCount());
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
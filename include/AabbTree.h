@@ -0,0 +1,184 @@
+#ifndef AABB_TREE_H
+#define AABB_TREE_H
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "BodyStore.h"
+
+struct Aabb {
+    float minX, minY, maxX, maxY;
+
+    bool overlaps(const Aabb& other) const {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+    bool contains(const Aabb& other) const {
+        return minX <= other.minX && minY <= other.minY && other.maxX <= maxX && other.maxY <= maxY;
+    }
+    // 2D中以周长代替面积作为插入代价
+    float perimeter() const { return 2.0f * ((maxX - minX) + (maxY - minY)); }
+
+    static Aabb merge(const Aabb& a, const Aabb& b) {
+        return { a.minX < b.minX ? a.minX : b.minX, a.minY < b.minY ? a.minY : b.minY,
+                 a.maxX > b.maxX ? a.maxX : b.maxX, a.maxY > b.maxY ? a.maxY : b.maxY };
+    }
+};
+
+// 动态包围盒树：叶子保存放大过的包围盒（fat AABB），物体在放大范围内移动时树不变，
+// 移出时才删除并重新插入该叶子（增量更新）。插入时沿代价最小的方向下降，
+// 回溯时对高度相差超过1的节点做旋转，保持树的平衡。节点放在数组里，用下标相连
+class DynamicAabbTree {
+public:
+    static constexpr int32_t NULL_NODE = -1;
+
+    int32_t createProxy(const Aabb& fat, uint32_t body);
+    void destroyProxy(int32_t proxy);
+    // 用新的fat包围盒替换叶子（删除后重新插入）
+    void moveProxy(int32_t proxy, const Aabb& fat);
+    void clear();
+
+    const Aabb& fatAabb(int32_t proxy) const { return nodes[proxy].box; }
+    uint32_t body(int32_t proxy) const { return nodes[proxy].body; }
+    int32_t height() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+    size_t proxyCount() const { return proxies; }
+
+    // 对与box重叠的每个叶子调用callback(proxy)，callback返回false时提前结束
+    template <typename Callback>
+    void query(const Aabb& box, Callback&& callback) const {
+        if (root == NULL_NODE) return;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const int32_t id = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[id];
+            if (!node.box.overlaps(box)) continue;
+            if (node.isLeaf()) {
+                if (!callback(id)) return;
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    // 树内所有fat包围盒重叠的叶子对，每对调用一次callback(proxyA, proxyB)。
+    // 同时下降两棵子树，包围盒不重叠的子树对整体跳过，比逐个叶子从根查询少走很多节点
+    template <typename Callback>
+    void selfOverlaps(Callback&& callback) const {
+        if (root == NULL_NODE) return;
+        pairStack.clear();
+        pairStack.push_back({ root, root });
+        while (!pairStack.empty()) {
+            const auto [ia, ib] = pairStack.back();
+            pairStack.pop_back();
+            const Node& a = nodes[ia];
+            if (ia == ib) {
+                // 子树与自身：两个孩子各自与自身，以及两个孩子之间
+                if (a.isLeaf()) continue;
+                pairStack.push_back({ a.child1, a.child1 });
+                pairStack.push_back({ a.child2, a.child2 });
+                pairStack.push_back({ a.child1, a.child2 });
+                continue;
+            }
+            const Node& b = nodes[ib];
+            if (!a.box.overlaps(b.box)) continue;
+            if (a.isLeaf() && b.isLeaf()) {
+                callback(ia, ib);
+            } else if (b.isLeaf() || (!a.isLeaf() && a.box.perimeter() > b.box.perimeter())) {
+                pairStack.push_back({ a.child1, ib });
+                pairStack.push_back({ a.child2, ib });
+            } else {
+                pairStack.push_back({ ia, b.child1 });
+                pairStack.push_back({ ia, b.child2 });
+            }
+        }
+    }
+
+    // 射线(ox, oy) + t·(dx, dy)，t∈[0, maxT]。callback(proxy, maxT)返回新的maxT：
+    // 返回更小的值可裁剪射线（找最近命中），返回0结束
+    template <typename Callback>
+    void rayCast(float ox, float oy, float dx, float dy, float maxT, Callback&& callback) const {
+        if (root == NULL_NODE) return;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const int32_t id = stack.back();
+            stack.pop_back();
+            const Node& node = nodes[id];
+            if (!RayHitsBox(node.box, ox, oy, dx, dy, maxT)) continue;
+            if (node.isLeaf()) {
+                maxT = callback(id, maxT);
+                if (maxT <= 0.0f) return;
+            } else {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+private:
+    struct Node {
+        Aabb box;
+        int32_t parent;  // 空闲节点中为下一个空闲节点
+        int32_t child1;
+        int32_t child2;
+        int32_t height;  // 叶子为0，空闲节点为-1
+        uint32_t body;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    std::vector<Node> nodes;
+    int32_t root = NULL_NODE;
+    int32_t freeList = NULL_NODE;
+    size_t proxies = 0;
+    mutable std::vector<int32_t> stack;
+    mutable std::vector<std::pair<int32_t, int32_t>> pairStack;
+
+    int32_t allocateNode();
+    void freeNode(int32_t id);
+    void insertLeaf(int32_t leaf);
+    void removeLeaf(int32_t leaf);
+    // 以id为根做一次旋转，返回旋转后的子树根
+    int32_t balance(int32_t id);
+
+    static bool RayHitsBox(const Aabb& box, float ox, float oy, float dx, float dy, float maxT);
+};
+
+struct RayHit {
+    uint32_t body;
+    float t;       // 命中点 = 起点 + t·方向
+    float nx, ny;  // 命中处的表面法线
+};
+
+// 与BodyStore同步的树：每个物体一个叶子，按物体下标对应。
+// 包围盒按半径的一定比例放大，并沿本步位移方向再延伸，慢速物体很少需要重新插入
+class BodyTree {
+public:
+    float marginRatio = 0.1f;  // 放大量 = 半径 × marginRatio
+
+    // 物体数变化时增删叶子，之后只重新插入移出fat包围盒的物体
+    void update(const BodyStore& bodies);
+    void clear();
+
+    const DynamicAabbTree& tree() const { return aabbTree; }
+    size_t reinsertedCount() const { return reinserted; }
+
+    // 形状包含点(x, y)的全部物体
+    void queryPoint(const BodyStore& bodies, float x, float y, std::vector<uint32_t>& out) const;
+    // 包围盒与区域重叠的全部物体
+    void queryRegion(const Aabb& region, std::vector<uint32_t>& out) const;
+    // 射线与物体形状的最近交点，maxT内没有命中时返回false
+    bool rayCast(const BodyStore& bodies, float ox, float oy, float dx, float dy, float maxT, RayHit& hit) const;
+    // 鼠标拾取：形状边界到点的距离不超过tolerance的物体中距离最近的一个，没有时返回-1
+    int pick(const BodyStore& bodies, float x, float y, float tolerance) const;
+
+private:
+    DynamicAabbTree aabbTree;
+    std::vector<int32_t> leafOf;  // 物体下标 -> 叶子
+    size_t reinserted = 0;
+
+    Aabb fatBox(const BodyStore& bodies, size_t i) const;
+};
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+#include <cstdint>
+
+// 全局operator new的调用次数，用来检查稳态下每帧/每步没有堆分配。
+// 编译时定义PHYSICS2D_COUNT_ALLOCATIONS才替换operator new，否则计数始终为0
+bool HeapAllocationCountingEnabled();
+// 整个进程的计数
+uint64_t HeapAllocationCount();
+// 调用线程自己的计数，多线程时用来区分各线程的分配
+uint64_t ThreadHeapAllocationCount();
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef BARNES_HUT_H
+#define BARNES_HUT_H
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include "axioms.h"
+#include "BodyStore.h"
+
+// 每一步重建的四叉树，用于Barnes-Hut近似万有引力
+class QuadTree {
+public:
+    static constexpr int MAX_DEPTH = 24;
+    static constexpr int LEAF_CAPACITY = 8;
+
+    void build(const BodyStore& bodies) {
+        const size_t n = bodies.size();
+        nodes.clear();
+        next.assign(n, -1);
+        if (n == 0) return;
+
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        for (size_t i = 0; i < n; i++) {
+            minX = std::min(minX, bodies.x[i]);
+            minY = std::min(minY, bodies.y[i]);
+            maxX = std::max(maxX, bodies.x[i]);
+            maxY = std::max(maxY, bodies.y[i]);
+        }
+
+        float halfSize = 0.5f * std::max(maxX - minX, maxY - minY) + 1e-4f;
+        nodes.reserve(n / 2 + 1);
+        nodes.push_back(makeNode(0.5f * (minX + maxX), 0.5f * (minY + maxY), halfSize));
+
+        bodyX.assign(bodies.x.begin(), bodies.x.end());
+        bodyY.assign(bodies.y.begin(), bodies.y.end());
+        bodyMass.assign(bodies.mass.begin(), bodies.mass.end());
+        for (size_t i = 0; i < n; i++) {
+            insert(static_cast<int>(i));
+        }
+
+        for (Node& node : nodes) {
+            if (node.mass > 0.0) {
+                node.comX = static_cast<float>(node.sumX / node.mass);
+                node.comY = static_cast<float>(node.sumY / node.mass);
+            }
+        }
+    }
+
+    // 计算树中所有物体对body施加的引力（不含自身）
+    void computeForce(int body, float x, float y, float mass, float theta, float& fx, float& fy) const {
+        fx = 0.0f;
+        fy = 0.0f;
+        if (nodes.empty()) return;
+
+        const float thetaSq = theta * theta;
+        int stack[MAX_DEPTH * 3 + 4];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (node.mass <= 0.0) continue;
+
+            if (node.firstChild < 0) {
+                for (int b = node.body; b != -1; b = next[b]) {
+                    if (b == body) continue;
+                    addPairForce(x, y, mass, bodyX[b], bodyY[b], bodyMass[b], fx, fy);
+                }
+                continue;
+            }
+
+            const float dx = node.comX - x;
+            const float dy = node.comY - y;
+            const float distanceSq = dx * dx + dy * dy;
+            const float size = 2.0f * node.halfSize;
+
+            if (size * size < thetaSq * distanceSq) {
+                addPairForce(x, y, mass, node.comX, node.comY, static_cast<float>(node.mass), fx, fy);
+            } else {
+                for (int c = 0; c < 4; c++) {
+                    stack[top++] = node.firstChild + c;
+                }
+            }
+        }
+    }
+
+    size_t nodeCount() const { return nodes.size(); }
+
+private:
+    struct Node {
+        float cx, cy, halfSize;
+        float comX, comY;
+        double mass, sumX, sumY;
+        int firstChild;
+        int body;
+        int count;
+        int depth;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> next;
+    std::vector<float> bodyX, bodyY, bodyMass;
+
+    static Node makeNode(float cx, float cy, float halfSize, int depth = 0) {
+        return Node{cx, cy, halfSize, 0.0f, 0.0f, 0.0, 0.0, 0.0, -1, -1, 0, depth};
+    }
+
+    static void addPairForce(float x, float y, float mass, float ox, float oy, float otherMass, float& fx, float& fy) {
+        const float dx = ox - x;
+        const float dy = oy - y;
+        const float distance = sqrtf(dx * dx + dy * dy);
+
+        if (distance < 0.001f) return;
+
+        float forceMagnitude = G * mass * otherMass / (distance * distance);
+        fx += forceMagnitude * dx / distance;
+        fy += forceMagnitude * dy / distance;
+    }
+
+    int childFor(const Node& node, float x, float y) const {
+        return node.firstChild + (x >= node.cx ? 1 : 0) + (y >= node.cy ? 2 : 0);
+    }
+
+    void subdivide(int index) {
+        const float h = nodes[index].halfSize * 0.5f;
+        const float cx = nodes[index].cx;
+        const float cy = nodes[index].cy;
+        const int depth = nodes[index].depth + 1;
+        const int first = static_cast<int>(nodes.size());
+
+        nodes.push_back(makeNode(cx - h, cy - h, h, depth));
+        nodes.push_back(makeNode(cx + h, cy - h, h, depth));
+        nodes.push_back(makeNode(cx - h, cy + h, h, depth));
+        nodes.push_back(makeNode(cx + h, cy + h, h, depth));
+        nodes[index].firstChild = first;
+    }
+
+    void insert(int body) {
+        const float x = bodyX[body];
+        const float y = bodyY[body];
+        const float mass = bodyMass[body];
+
+        int index = 0;
+        while (true) {
+            Node& node = nodes[index];
+            node.mass += mass;
+            node.sumX += static_cast<double>(mass) * x;
+            node.sumY += static_cast<double>(mass) * y;
+
+            if (node.firstChild >= 0) {
+                index = childFor(node, x, y);
+                continue;
+            }
+
+            next[body] = node.body;
+            node.body = body;
+            node.count++;
+            if (node.count <= LEAF_CAPACITY || node.depth >= MAX_DEPTH) return;
+
+            // 叶子超出容量：细分后把原有物体下推到子节点
+            int resident = node.body;
+            nodes[index].body = -1;
+            nodes[index].count = 0;
+            subdivide(index);
+
+            while (resident != -1) {
+                const int following = next[resident];
+                Node& childNode = nodes[childFor(nodes[index], bodyX[resident], bodyY[resident])];
+                childNode.mass += bodyMass[resident];
+                childNode.sumX += static_cast<double>(bodyMass[resident]) * bodyX[resident];
+                childNode.sumY += static_cast<double>(bodyMass[resident]) * bodyY[resident];
+                next[resident] = childNode.body;
+                childNode.body = resident;
+                childNode.count++;
+                resident = following;
+            }
+            return;
+        }
+    }
+};
+
+// Barnes-Hut相对精确两两求和的误差统计
+struct GravityAccuracyReport {
+    float theta = 0.0f;
+    size_t samples = 0;
+    double rmsRelativeError = 0.0;
+    double maxRelativeError = 0.0;
+    double treeMilliseconds = 0.0;
+};
+
+inline void ComputeExactGravity(const BodyStore& bodies, size_t i, float& fx, float& fy) {
+    fx = 0.0f;
+    fy = 0.0f;
+    for (size_t j = 0; j < bodies.size(); j++) {
+        if (j == i) continue;
+        const float dx = bodies.x[j] - bodies.x[i];
+        const float dy = bodies.y[j] - bodies.y[i];
+        const float distance = sqrtf(dx * dx + dy * dy);
+
+        if (distance < 0.001f) continue;
+
+        float forceMagnitude = G * bodies.mass[i] * bodies.mass[j] / (distance * distance);
+        fx += forceMagnitude * dx / distance;
+        fy += forceMagnitude * dy / distance;
+    }
+}
+
+// 以最多maxSamples个物体为样本，比较树近似与精确求和的引力
+inline GravityAccuracyReport MeasureBarnesHutAccuracy(const BodyStore& bodies, float theta, size_t maxSamples = 512) {
+    GravityAccuracyReport report;
+    report.theta = theta;
+    if (bodies.size() < 2) return report;
+
+    QuadTree tree;
+    auto start = std::chrono::steady_clock::now();
+    tree.build(bodies);
+    for (size_t i = 0; i < bodies.size(); i++) {
+        float fx, fy;
+        tree.computeForce(static_cast<int>(i), bodies.x[i], bodies.y[i], bodies.mass[i], theta, fx, fy);
+    }
+    report.treeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const size_t stride = std::max<size_t>(1, bodies.size() / maxSamples);
+    double sumSq = 0.0;
+    for (size_t i = 0; i < bodies.size(); i += stride) {
+        float ex, ey, tx, ty;
+        ComputeExactGravity(bodies, i, ex, ey);
+        tree.computeForce(static_cast<int>(i), bodies.x[i], bodies.y[i], bodies.mass[i], theta, tx, ty);
+
+        const double exactMagnitude = std::sqrt(static_cast<double>(ex) * ex + static_cast<double>(ey) * ey);
+        if (exactMagnitude <= 0.0) continue;
+
+        const double ddx = static_cast<double>(tx) - ex;
+        const double ddy = static_cast<double>(ty) - ey;
+        const double relative = std::sqrt(ddx * ddx + ddy * ddy) / exactMagnitude;
+
+        sumSq += relative * relative;
+        report.maxRelativeError = std::max(report.maxRelativeError, relative);
+        report.samples++;
+    }
+    if (report.samples > 0) {
+        report.rmsRelativeError = std::sqrt(sumSq / static_cast<double>(report.samples));
+    }
+    return report;
+}
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef BODY_STORE_H
+#define BODY_STORE_H
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+
+// 按缓存行对齐的分配器，保证每个数组的起始地址可直接用于向量化加载
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    friend bool operator==(const AlignedAllocator&, const AlignedAllocator&) { return true; }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+enum BodyFlags : uint32_t {
+    BODY_MOVABLE = 1u << 0,
+    BODY_SLEEPING = 1u << 1,  // 静止足够久，积分与窄相都跳过，直到被唤醒
+};
+
+// 形状类型标签，窄相按(类型A, 类型B)查表分发
+enum ShapeType : uint32_t {
+    SHAPE_CIRCLE = 0,
+    SHAPE_POLYGON = 1,
+    SHAPE_TYPE_COUNT
+};
+
+// 结构数组形式的刚体存储：每个属性一个连续数组，积分、受力与碰撞均可线性遍历
+class BodyStore {
+public:
+    AlignedVector<float> x, y;
+    AlignedVector<float> prevX, prevY;
+    AlignedVector<float> vx, vy;
+    AlignedVector<float> ax, ay;
+    AlignedVector<float> mass, invMass;
+    AlignedVector<float> charge;
+    AlignedVector<float> radius;
+    AlignedVector<uint32_t> flags;
+    AlignedVector<uint32_t> shape;     // ShapeType
+    AlignedVector<uint32_t> vertices;  // 圆为绘制分辨率，多边形为边数
+    AlignedVector<float> sleepTime;    // 速度持续低于阈值的时间
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+
+    size_t add(float px, float py, float r, float m, float q, uint32_t f,
+               ShapeType type = SHAPE_CIRCLE, uint32_t vertexCount = 0) {
+        x.push_back(px);
+        y.push_back(py);
+        prevX.push_back(px);
+        prevY.push_back(py);
+        vx.push_back(0.0f);
+        vy.push_back(0.0f);
+        ax.push_back(0.0f);
+        ay.push_back(0.0f);
+        mass.push_back(m);
+        invMass.push_back(1.0f / m);
+        charge.push_back(q);
+        radius.push_back(r);
+        flags.push_back(f);
+        shape.push_back(type);
+        vertices.push_back(vertexCount);
+        sleepTime.push_back(0.0f);
+        return size() - 1;
+    }
+
+    // 保持顺序删除，使界面中的物体编号保持稳定
+    void remove(size_t i) {
+        forEachArray([i](auto& array) { array.erase(array.begin() + i); });
+    }
+
+    void clear() {
+        forEachArray([](auto& array) { array.clear(); });
+    }
+
+    void reserve(size_t n) {
+        forEachArray([n](auto& array) { array.reserve(n); });
+    }
+
+    // 每个固定步开始前记录位置，渲染时在上一步与当前步之间插值
+    void savePreviousPositions() {
+        std::copy(x.begin(), x.end(), prevX.begin());
+        std::copy(y.begin(), y.end(), prevY.begin());
+    }
+
+    float renderX(size_t i, float alpha) const { return prevX[i] + (x[i] - prevX[i]) * alpha; }
+    float renderY(size_t i, float alpha) const { return prevY[i] + (y[i] - prevY[i]) * alpha; }
+
+    bool isMovable(size_t i) const { return (flags[i] & BODY_MOVABLE) != 0; }
+    bool isSleeping(size_t i) const { return (flags[i] & BODY_SLEEPING) != 0; }
+    // 可移动且未休眠，需要积分与碰撞检测
+    bool isAwake(size_t i) const { return (flags[i] & (BODY_MOVABLE | BODY_SLEEPING)) == BODY_MOVABLE; }
+
+    void wake(size_t i) {
+        flags[i] &= ~BODY_SLEEPING;
+        sleepTime[i] = 0.0f;
+    }
+
+    void wakeAll() {
+        for (size_t i = 0; i < size(); i++) wake(i);
+    }
+
+    void setMovable(size_t i, bool movable) {
+        if (movable) flags[i] |= BODY_MOVABLE;
+        else flags[i] &= ~BODY_MOVABLE;
+    }
+
+    void setMass(size_t i, float m) {
+        mass[i] = m;
+        invMass[i] = 1.0f / m;
+    }
+
+    // 按固定顺序访问全部数组，增删行与快照都依赖这一顺序
+    template <typename F>
+    void forEachArray(F&& f) {
+        f(x); f(y);
+        f(prevX); f(prevY);
+        f(vx); f(vy);
+        f(ax); f(ay);
+        f(mass); f(invMass);
+        f(charge);
+        f(radius);
+        f(flags);
+        f(shape);
+        f(vertices);
+        f(sleepTime);
+    }
+
+    template <typename F>
+    void forEachArray(F&& f) const {
+        const_cast<BodyStore*>(this)->forEachArray([&f](const auto& array) { f(array); });
+    }
+
+    static constexpr uint32_t ARRAY_COUNT = 16;
+};
+
+#endif
@@ -0,0 +1,318 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+#include "BodyStore.h"
+#include "AabbTree.h"
+
+// 候选碰撞对，始终满足 a < b
+struct BroadphasePair {
+    uint32_t a;
+    uint32_t b;
+};
+
+// 每步重建的配对列表，World从步内arena分配
+using PairList = std::pmr::vector<BroadphasePair>;
+
+// 上一次findPairs的工作量，供界面比较不同的粗检测
+struct BroadphaseStats {
+    size_t tests = 0;  // 包围盒重叠测试次数
+    size_t swaps = 0;  // 排序扫掠中插入排序的移动次数
+    size_t reinserts = 0;  // AABB树中移出fat包围盒、重新插入的叶子数
+};
+
+// 粗检测接口：根据包围盒给出可能碰撞的物体对，交给窄相精确检测
+class Broadphase {
+public:
+    virtual ~Broadphase() = default;
+    virtual const char* name() const = 0;
+    virtual void findPairs(const BodyStore& bodies, PairList& pairs) = 0;
+
+    const BroadphaseStats& stats() const { return lastStats; }
+
+protected:
+    BroadphaseStats lastStats;
+
+    static bool overlaps(const BodyStore& bodies, size_t a, size_t b) {
+        const float reach = bodies.radius[a] + bodies.radius[b];
+        return std::fabs(bodies.x[a] - bodies.x[b]) <= reach && std::fabs(bodies.y[a] - bodies.y[b]) <= reach;
+    }
+};
+
+// 两两检测包围盒，作为其它粗检测的参照
+class BruteForceBroadphase : public Broadphase {
+public:
+    const char* name() const override { return "Brute Force"; }
+
+    void findPairs(const BodyStore& bodies, PairList& pairs) override {
+        pairs.clear();
+        const size_t n = bodies.size();
+        lastStats = { n > 1 ? n * (n - 1) / 2 : 0, 0 };
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = i + 1; j < n; j++) {
+                if (overlaps(bodies, i, j)) {
+                    pairs.push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(j)});
+                }
+            }
+        }
+    }
+};
+
+// 均匀网格/空间哈希：格子边长取最大包围盒的边长，每个物体只登记在中心所在的格子，
+// 周围3x3个格子即可覆盖所有可能重叠的物体。物体分布较密时直接按行列编号（相邻格在内存中也相邻），
+// 分布稀疏时退化为哈希表；格内数据按桶顺序复制一份以便连续访问
+class SpatialHashBroadphase : public Broadphase {
+public:
+    const char* name() const override { return "Spatial Hash"; }
+
+    void findPairs(const BodyStore& bodies, PairList& pairs) override {
+        pairs.clear();
+        lastStats = {};
+        const size_t n = bodies.size();
+        if (n < 2) return;
+
+        float maxRadius = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            maxRadius = std::max(maxRadius, bodies.radius[i]);
+        }
+        const float cellSize = std::max(2.0f * maxRadius, 1e-4f);
+        const float invCellSize = 1.0f / cellSize;
+
+        cellX.resize(n);
+        cellY.resize(n);
+        bucketOf.resize(n);
+        entries.resize(n);
+
+        int32_t minCellX = INT32_MAX, minCellY = INT32_MAX;
+        int32_t maxCellX = INT32_MIN, maxCellY = INT32_MIN;
+        for (size_t i = 0; i < n; i++) {
+            cellX[i] = static_cast<int32_t>(std::floor(bodies.x[i] * invCellSize));
+            cellY[i] = static_cast<int32_t>(std::floor(bodies.y[i] * invCellSize));
+            minCellX = std::min(minCellX, cellX[i]);
+            minCellY = std::min(minCellY, cellY[i]);
+            maxCellX = std::max(maxCellX, cellX[i]);
+            maxCellY = std::max(maxCellY, cellY[i]);
+        }
+
+        const int64_t gridWidth = static_cast<int64_t>(maxCellX) - minCellX + 1;
+        const int64_t gridHeight = static_cast<int64_t>(maxCellY) - minCellY + 1;
+        denseGrid = gridWidth * gridHeight <= static_cast<int64_t>(4 * n);
+        originX = minCellX;
+        originY = minCellY;
+        width = static_cast<int32_t>(std::min<int64_t>(gridWidth, INT32_MAX));
+        height = static_cast<int32_t>(std::min<int64_t>(gridHeight, INT32_MAX));
+
+        size_t tableSize = 1;
+        if (denseGrid) {
+            tableSize = static_cast<size_t>(gridWidth * gridHeight);
+        } else {
+            while (tableSize < 2 * n) tableSize <<= 1;
+        }
+        mask = static_cast<uint32_t>(tableSize - 1);
+        bucketStart.assign(tableSize + 1, 0);
+
+        for (size_t i = 0; i < n; i++) {
+            bucketOf[i] = bucketFor(cellX[i], cellY[i]);
+            bucketStart[bucketOf[i] + 1]++;
+        }
+        for (size_t b = 0; b < tableSize; b++) {
+            bucketStart[b + 1] += bucketStart[b];
+        }
+        fill.assign(bucketStart.begin(), bucketStart.end() - 1);
+        sortedX.resize(n);
+        sortedY.resize(n);
+        sortedRadius.resize(n);
+        sortedCellX.resize(n);
+        sortedCellY.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            const uint32_t e = fill[bucketOf[i]]++;
+            entries[e] = static_cast<uint32_t>(i);
+            sortedX[e] = bodies.x[i];
+            sortedY[e] = bodies.y[i];
+            sortedRadius[e] = bodies.radius[i];
+            sortedCellX[e] = cellX[i];
+            sortedCellY[e] = cellY[i];
+        }
+
+        // 按桶顺序遍历：本格内只取排在后面的物体，相邻格只查一半方向，保证每对只出现一次
+        static const int32_t forward[4][2] = { {1, 0}, {-1, 1}, {0, 1}, {1, 1} };
+        for (size_t b = 0; b < tableSize; b++) {
+            for (uint32_t ei = bucketStart[b]; ei < bucketStart[b + 1]; ei++) {
+                const uint32_t i = entries[ei];
+                const float xi = sortedX[ei];
+                const float yi = sortedY[ei];
+                const float ri = sortedRadius[ei];
+                const int32_t cxi = sortedCellX[ei];
+                const int32_t cyi = sortedCellY[ei];
+
+                for (uint32_t e = ei + 1; e < bucketStart[b + 1]; e++) {
+                    if (sortedCellX[e] != cxi || sortedCellY[e] != cyi) continue;
+                    emitIfOverlapping(pairs, i, entries[e], xi, yi, ri, sortedX[e], sortedY[e], sortedRadius[e]);
+                }
+
+                for (const auto& offset : forward) {
+                    const int32_t cx = cxi + offset[0];
+                    const int32_t cy = cyi + offset[1];
+                    const uint32_t bucket = bucketFor(cx, cy);
+                    if (bucket == EMPTY_BUCKET) continue;
+
+                    for (uint32_t e = bucketStart[bucket]; e < bucketStart[bucket + 1]; e++) {
+                        if (sortedCellX[e] != cx || sortedCellY[e] != cy) continue;
+                        emitIfOverlapping(pairs, i, entries[e], xi, yi, ri, sortedX[e], sortedY[e], sortedRadius[e]);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t EMPTY_BUCKET = UINT32_MAX;
+
+    bool denseGrid = false;
+    int32_t originX = 0, originY = 0, width = 0, height = 0;
+    uint32_t mask = 0;
+    std::vector<int32_t> cellX, cellY;
+    std::vector<uint32_t> bucketOf, bucketStart, fill, entries;
+    std::vector<float> sortedX, sortedY, sortedRadius;
+    std::vector<int32_t> sortedCellX, sortedCellY;
+
+    void emitIfOverlapping(PairList& pairs, uint32_t i, uint32_t j,
+                           float xi, float yi, float ri, float xj, float yj, float rj) {
+        lastStats.tests++;
+        const float reach = ri + rj;
+        if (std::fabs(xi - xj) <= reach && std::fabs(yi - yj) <= reach) {
+            pairs.push_back({std::min(i, j), std::max(i, j)});
+        }
+    }
+
+    uint32_t bucketFor(int32_t cx, int32_t cy) const {
+        if (denseGrid) {
+            const int64_t gx = static_cast<int64_t>(cx) - originX;
+            const int64_t gy = static_cast<int64_t>(cy) - originY;
+            if (gx < 0 || gy < 0 || gx >= width || gy >= height) return EMPTY_BUCKET;
+            return static_cast<uint32_t>(gy * width + gx);
+        }
+        return (static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u) & mask;
+    }
+};
+
+// 排序扫掠：包围盒的x区间按左端点排序，排序结果跨帧保留。物体每步只移动一点时（静止的堆、轨道运动）
+// 顺序几乎不变，插入排序只需少量移动，整步接近线性；之后沿x扫描，只对x区间重叠的物体再比较y。
+// 顺序被打乱得太厉害时（移动次数超出预算）改用std::sort，避免插入排序退化为平方复杂度。
+// 配对按端点顺序给出，依赖于之前各帧；World::step会重新排序
+class SweepAndPruneBroadphase : public Broadphase {
+public:
+    const char* name() const override { return "Sweep and Prune"; }
+
+    void findPairs(const BodyStore& bodies, PairList& pairs) override {
+        pairs.clear();
+        lastStats = {};
+        const size_t n = bodies.size();
+
+        // 物体数变化（增删、清空、读取快照）时重新编号；数目不变时端点数组总是0..n-1的一个排列
+        if (endpoints.size() != n) {
+            endpoints.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                endpoints[i].body = static_cast<uint32_t>(i);
+            }
+        }
+        for (Endpoint& e : endpoints) {
+            const float r = bodies.radius[e.body];
+            e.x = bodies.x[e.body];
+            e.y = bodies.y[e.body];
+            e.minX = e.x - r;
+            e.maxX = e.x + r;
+            e.radius = r;
+        }
+        if (!insertionSort(8 * n + 64)) {
+            std::sort(endpoints.begin(), endpoints.end(),
+                      [](const Endpoint& l, const Endpoint& r) { return l.minX < r.minX; });
+        }
+
+        for (size_t k = 0; k < n; k++) {
+            const Endpoint& a = endpoints[k];
+            for (size_t m = k + 1; m < n && endpoints[m].minX <= a.maxX; m++) {
+                const Endpoint& b = endpoints[m];
+                lastStats.tests++;
+                // 与其它粗检测使用同一判据，端点舍入不改变结果
+                const float reach = a.radius + b.radius;
+                if (std::fabs(a.x - b.x) <= reach && std::fabs(a.y - b.y) <= reach) {
+                    pairs.push_back({ std::min(a.body, b.body), std::max(a.body, b.body) });
+                }
+            }
+        }
+    }
+
+private:
+    struct Endpoint {
+        float minX, maxX, x, y, radius;
+        uint32_t body;
+    };
+    std::vector<Endpoint> endpoints;
+
+    // 移动次数超过budget时放弃，返回false
+    bool insertionSort(size_t budget) {
+        for (size_t i = 1; i < endpoints.size(); i++) {
+            const Endpoint e = endpoints[i];
+            size_t j = i;
+            while (j > 0 && endpoints[j - 1].minX > e.minX) {
+                endpoints[j] = endpoints[j - 1];
+                j--;
+                if (++lastStats.swaps > budget) {
+                    endpoints[j] = e;
+                    return false;
+                }
+            }
+            endpoints[j] = e;
+        }
+        return true;
+    }
+};
+
+// 动态AABB树：网格的格子边长取决于最大的物体，物体大小相差悬殊时小物体挤在同一格里；
+// 树按每个物体自己的包围盒组织，不受大小分布影响。配对由树的自重叠遍历给出，再用精确包围盒筛选；
+// 遍历顺序取决于树的形状，也就是插入与重新插入的历史，回放时从快照新建的树并不相同，
+// 所以World::step会把配对重新排序
+class AabbTreeBroadphase : public Broadphase {
+public:
+    const char* name() const override { return "AABB Tree"; }
+
+    void findPairs(const BodyStore& bodies, PairList& pairs) override {
+        pairs.clear();
+        lastStats = {};
+        bodyTree.update(bodies);
+        lastStats.reinserts = bodyTree.reinsertedCount();
+
+        const DynamicAabbTree& tree = bodyTree.tree();
+        tree.selfOverlaps([&](int32_t proxyA, int32_t proxyB) {
+            const uint32_t a = tree.body(proxyA);
+            const uint32_t b = tree.body(proxyB);
+            lastStats.tests++;
+            if (overlaps(bodies, a, b)) pairs.push_back({ std::min(a, b), std::max(a, b) });
+        });
+    }
+
+    const BodyTree& tree() const { return bodyTree; }
+
+private:
+    BodyTree bodyTree;
+};
+
+enum class BroadphaseType { BruteForce, SpatialHash, SweepAndPrune, AabbTree };
+
+inline std::unique_ptr<Broadphase> CreateBroadphase(BroadphaseType type) {
+    switch (type) {
+        case BroadphaseType::BruteForce: return std::make_unique<BruteForceBroadphase>();
+        case BroadphaseType::SpatialHash: return std::make_unique<SpatialHashBroadphase>();
+        case BroadphaseType::SweepAndPrune: return std::make_unique<SweepAndPruneBroadphase>();
+        case BroadphaseType::AabbTree: return std::make_unique<AabbTreeBroadphase>();
+    }
+    return nullptr;
+}
+
+#endif
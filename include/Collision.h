@@ -0,0 +1,51 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+#include <cstdint>
+#include "BodyStore.h"
+
+// 窄相碰撞：直接作用于BodyStore中的两行，不经过Object与RTTI。
+// 按两者的形状标签查静态函数表，圆-多边形与多边形-圆使用同一实现，结果与配对顺序无关。
+
+// 接触求解器使用的接触：物体不转动，每对物体一个法向接触即可
+struct ContactPoint {
+    uint32_t a;
+    uint32_t b;
+    uint32_t feature;  // 法线来源（多边形的边号等），与a、b一起作为跨帧的接触编号
+    float nx, ny;      // 单位法线，由a指向b
+    float depth;       // 穿透深度，为负表示尚未接触
+};
+
+using CollisionTestFn = bool (*)(const BodyStore& bodies, uint32_t a, uint32_t b);
+using CollisionResolveFn = void (*)(BodyStore& bodies, uint32_t a, uint32_t b);
+// 相交时填写法线、深度与特征编号（不填a、b）
+using CollisionManifoldFn = bool (*)(const BodyStore& bodies, uint32_t a, uint32_t b, ContactPoint& contact);
+
+struct CollisionHandler {
+    CollisionTestFn test;
+    CollisionResolveFn resolve;
+    CollisionManifoldFn manifold;
+};
+
+const CollisionHandler& GetCollisionHandler(uint32_t shapeA, uint32_t shapeB);
+
+inline bool TestCollision(const BodyStore& bodies, uint32_t a, uint32_t b) {
+    return GetCollisionHandler(bodies.shape[a], bodies.shape[b]).test(bodies, a, b);
+}
+
+// 检测并处理一对物体的碰撞，返回是否接触
+inline bool CollidePair(BodyStore& bodies, uint32_t a, uint32_t b) {
+    const CollisionHandler& handler = GetCollisionHandler(bodies.shape[a], bodies.shape[b]);
+    if (!handler.test(bodies, a, b)) return false;
+    handler.resolve(bodies, a, b);
+    return true;
+}
+
+// 生成一对物体的接触，不修改物体状态
+inline bool ComputeContact(const BodyStore& bodies, uint32_t a, uint32_t b, ContactPoint& contact) {
+    if (!GetCollisionHandler(bodies.shape[a], bodies.shape[b]).manifold(bodies, a, b, contact)) return false;
+    contact.a = a;
+    contact.b = b;
+    return true;
+}
+
+#endif
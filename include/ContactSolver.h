@@ -0,0 +1,94 @@
+#ifndef CONTACT_SOLVER_H
+#define CONTACT_SOLVER_H
+#include <vector>
+#include <cstdint>
+#include "BodyStore.h"
+#include "Broadphase.h"
+#include "Collision.h"
+#include "ThreadPool.h"
+
+// 边界作为一个质量无穷大的物体参与求解，ContactPoint::b为此值，feature为哪一侧
+constexpr uint32_t WALL_BODY = UINT32_MAX;
+
+enum class PositionCorrection : uint32_t {
+    Baumgarte,     // 把穿透量折算为速度偏置，会给系统注入少量能量
+    SplitImpulse,  // 用单独的伪速度推开物体，不影响真实速度
+};
+
+struct ContactSolverSettings {
+    bool enabled = true;             // 关闭时退回逐对处理一次的旧方法
+    int iterations = 8;
+    PositionCorrection correction = PositionCorrection::SplitImpulse;
+    float baumgarte = 0.2f;          // 每步修正的穿透比例
+    float slop = 0.0005f;            // 允许的穿透量，避免接触反复断开
+    float restitution = 0.8f;
+    float restitutionThreshold = 0.3f;  // 接近速度低于此值时不反弹，静止接触才能稳定
+    bool warmStarting = true;
+
+    bool operator==(const ContactSolverSettings&) const = default;
+};
+
+// 跨帧保存的累积冲量，按(a, b, feature)对应
+struct ContactImpulse {
+    uint32_t a;
+    uint32_t b;
+    uint32_t feature;
+    float normalImpulse;
+};
+
+// 顺序冲量接触求解器：每步先生成全部接触（含与边界的接触），用上一步同一接触的累积冲量热启动，
+// 再对所有接触迭代若干次，每次把累积冲量钳制为非负。穿透用Baumgarte偏置或分离冲量修正。
+// 接触在积分后的位置上生成，静止接触每步都因重力重新压入一点，因此不会时有时无
+class ContactSolver {
+public:
+    ContactSolverSettings settings;
+
+    // 在积分之后调用，只依赖物体位置，可以与粗检测同时进行
+    void findWallContacts(const BodyStore& bodies, float aspect);
+
+    // 在findWallContacts之后调用。pairs为粗检测配对，窄相在pool上分块并行；两端都在休眠的配对不求解，
+    // 但写入islandPairs，其余实际接触的物体对也写入。迭代求解本身是顺序的。
+    // 接触列表与每个配对的窄相结果只在本次求解内使用，从scratch分配
+    void solve(BodyStore& bodies, const PairList& pairs, float dt, float aspect, ThreadPool& pool,
+               PairList& islandPairs, std::pmr::memory_resource* scratch);
+
+    // 物体编号改变（删除、清空、重建）后旧冲量不再对应，需要清除
+    void reset() { impulses.clear(); }
+
+    // 上一次solve的接触数
+    size_t contactCount() const { return lastContacts; }
+
+    // 快照与回放保存/恢复热启动所需的冲量
+    const std::vector<ContactImpulse>& cachedImpulses() const { return impulses; }
+    void restoreImpulses(const ContactImpulse* data, size_t count) { impulses.assign(data, data + count); }
+
+private:
+    struct SolverContact {
+        ContactPoint point;
+        float normalMass;
+        float velocityBias;
+        float positionBias;
+        float normalImpulse;
+        float positionImpulse;
+    };
+
+    // 窄相每块的配对数
+    static constexpr size_t NARROWPHASE_GRAIN = 256;
+
+    enum PairState : uint8_t { PAIR_SEPARATED, PAIR_TOUCHING, PAIR_SLEEPING };
+
+    using ContactList = std::pmr::vector<SolverContact>;
+
+    void generateContacts(const BodyStore& bodies, const PairList& pairs, ThreadPool& pool, PairList& islandPairs,
+                          ContactList& contacts, std::pmr::memory_resource* scratch);
+    void applyWarmStart(ContactList& contacts);
+    void correctPositions(BodyStore& bodies, ContactList& contacts, float dt);
+
+    // 墙面接触与粗检测同时生成，不能用步内arena（它不是线程安全的），保留为跨步复用的成员
+    std::vector<SolverContact> wallContacts;
+    std::vector<ContactImpulse> impulses;  // 按(a, b, feature)排序
+    size_t lastContacts = 0;
+    AlignedVector<float> pseudoVx, pseudoVy;
+};
+
+#endif
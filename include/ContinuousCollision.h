@@ -0,0 +1,47 @@
+#ifndef CONTINUOUS_COLLISION_H
+#define CONTINUOUS_COLLISION_H
+#include <vector>
+#include <memory_resource>
+#include <cstdint>
+#include "BodyStore.h"
+
+struct ContinuousCollisionSettings {
+    bool enabled = true;
+    float motionThreshold = 0.5f;  // 本步位移超过半径的这一倍数才做扫掠
+    int maxSubsteps = 8;           // 每个物体每步最多处理的碰撞次数，用完后停在最后一次碰撞的位置
+
+    bool operator==(const ContinuousCollisionSettings&) const = default;
+};
+
+// 连续碰撞检测：积分之后找出位移过大的物体，把它从上一步位置到当前位置的线段与其它物体的
+// 外接圆及边界求最早碰撞时间；命中时退回到碰撞位置、沿法线反弹，再用剩余时间继续扫掠（子步）。
+// 只有快速物体会被子步处理，其余物体照常交给离散的碰撞检测，因此可以用较大的dt而不会穿透。
+// 多边形按外接圆处理，偏保守
+class ContinuousCollision {
+public:
+    ContinuousCollisionSettings settings;
+
+    // 在积分之后、粗检测之前调用；prevX/prevY为本步起点。scratch提供本步的临时内存
+    void apply(BodyStore& bodies, float dt, float aspect, float restitution,
+               std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+    size_t fastBodyCount() const { return fast.size(); }
+    size_t impactCount() const { return impacts; }
+
+private:
+    // 全部物体按中心登记在均匀网格中，只在本步有快速物体时构建
+    void buildGrid(const BodyStore& bodies, std::pmr::memory_resource* scratch);
+
+    // 线段(sx, sy)->(ex, ey)上物体i与其它物体外接圆的最早碰撞，返回是否命中
+    bool sweepBodies(const BodyStore& bodies, uint32_t i, float sx, float sy, float ex, float ey,
+                     float& toi, uint32_t& hit) const;
+
+    std::vector<uint32_t> fast;
+    size_t impacts = 0;
+
+    float originX = 0.0f, originY = 0.0f, cellSize = 1.0f, maxRadius = 0.0f;
+    int32_t columns = 0, rows = 0;
+    std::vector<uint32_t> cellStart, cellBodies, cellOf;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef FMM_H
+#define FMM_H
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include "BodyStore.h"
+#include "ThreadPool.h"
+#include "SimdKernels.h"
+
+struct FmmSettings {
+    int order = 6;           // 展开阶数p，1 ~ FmmSolver::MAX_ORDER
+    float theta = 0.5f;      // 两个格子的半径之和不超过theta倍中心距时用展开计算
+    int leafCapacity = 32;   // 自适应树叶子的最多物体数；均匀树据此选择层数
+    bool adaptive = true;    // false时为均匀四叉树，所有叶子在同一层
+
+    bool operator==(const FmmSettings&) const = default;
+};
+
+// 快速多极子方法：引力与库仑力都是1/r势的梯度（质量与电荷是两种源），
+// 每个格子保存两组关于格子中心的笛卡尔多极展开与局部展开（泰勒系数，阶数不超过p）。
+// 上行：叶子由物体生成多极展开（P2M），逐层合并到父格子（M2M）；
+// 双树遍历找出彼此分离足够远的格子对做M2L，其余的叶子对直接两两求和（P2P）；
+// 下行：局部展开逐层平移到子格子（L2L），最后在叶子中对物体求梯度（L2P）。
+// 各遍按格子/叶子分给线程池，每个格子只写自己的数据，结果与线程数无关。
+// 近场用合并内核（软化、库仑的距离与力限制都相同），远场为未软化的平方反比定律；
+// 库仑力的限制只在一定距离内起作用（由最大电荷量算出），间距小于它的格子对一律走近场
+class FmmSolver {
+public:
+    static constexpr int MAX_ORDER = 12;
+    static constexpr int MAX_DEPTH = 24;
+
+    FmmSettings settings;
+
+    // 对醒着的可移动物体累加加速度，代替ApplyFusedForces；近场用level指定的向量内核
+    void apply(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params, SimdLevel level);
+
+    size_t nodeCount() const { return nodes.size(); }
+    size_t leafCount() const { return leaves.size(); }
+    int depth() const { return static_cast<int>(levelStart.size()) - 1; }
+    // 上一次apply中M2L与P2P的格子对数（有向）
+    size_t farPairCount() const { return farSource.size(); }
+    size_t nearPairCount() const { return nearSource.size(); }
+
+private:
+    struct Node {
+        double cx, cy;      // 展开中心（格子几何中心）
+        double halfSize;
+        double radius;      // 格子内物体到中心的最大距离
+        uint32_t begin;     // 物体在order中的区间
+        uint32_t count;
+        int32_t firstChild; // 非空的子格子连续存放，叶子为-1
+        int32_t childCount;
+        int32_t parent;     // 根为-1
+        int32_t level;
+    };
+
+    std::vector<Node> nodes;           // 按层（广度优先）排列
+    std::vector<uint32_t> levelStart;  // 第l层为[levelStart[l], levelStart[l + 1])
+    std::vector<uint32_t> leaves;
+    std::vector<uint32_t> order, scratch;  // 树序 -> 物体下标
+
+    // 按树序排列的物体数据，近场的源与目标都是连续区间
+    std::vector<float> px, py, pm, pq, pInvMass, pax, pay;
+    std::vector<uint32_t> pFlags;
+
+    int terms = 0;  // (p + 1)(p + 2) / 2
+    std::vector<double> massMultipole, chargeMultipole, massLocal, chargeLocal;
+
+    // 按目标格子排列的相互作用表（CSR）
+    std::vector<std::pair<uint32_t, uint32_t>> farPairs, nearPairs, traversal;
+    std::vector<uint32_t> farStart, farSource, nearStart, nearSource;
+
+    void build(const BodyStore& bodies);
+    void upwardPass(ThreadPool& pool, bool gravity, bool coulomb);
+    void buildInteractions(double minSeparation);
+    void downwardPass(ThreadPool& pool, bool gravity, bool coulomb);
+    void evaluate(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params, SimdLevel level);
+
+    static void BuildCsr(const std::vector<std::pair<uint32_t, uint32_t>>& pairs, size_t targets,
+                         std::vector<uint32_t>& start, std::vector<uint32_t>& source);
+};
+
+#endif
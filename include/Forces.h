@@ -0,0 +1,30 @@
+#ifndef FORCES_H
+#define FORCES_H
+#include "BodyStore.h"
+#include "BarnesHut.h"
+#include "ThreadPool.h"
+
+// Fmm与ParticleMesh同时计算引力与库仑力，代替两两求和
+enum class GravitySolver { Exact, BarnesHut, Fmm, ParticleMesh };
+
+// 精确两两求和的万有引力，O(N²)
+void ApplyUniversalGravitation(BodyStore& bodies);
+
+// 两两库仑力，距离与力的大小都有上下限
+void ApplyCoulombForce(BodyStore& bodies);
+
+// 每组一份的加速度累加缓冲区
+struct ParallelForceBuffers {
+    std::vector<AlignedVector<float>> ax, ay;
+};
+
+// 多线程两两作用力：把i/j配对空间划分为块，按块编号轮流分给固定数量的组，
+// 每组只写自己的累加缓冲区，组由空闲线程领取，最后按组编号顺序归约，结果与线程数和调度都无关
+void ApplyPairwiseForcesParallel(BodyStore& bodies, ThreadPool& pool, ParallelForceBuffers& buffers,
+                                 bool gravity, bool coulomb);
+
+// Barnes-Hut近似万有引力：用已建好的树对[begin, end)中醒着的物体累加引力，theta为张角。
+// 各物体互不影响，可以分块并行
+void ApplyBarnesHutRange(BodyStore& bodies, const QuadTree& tree, float theta, size_t begin, size_t end);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+#include <memory_resource>
+#include <memory>
+#include <optional>
+#include <cstddef>
+
+// 每帧（或每步）的线性分配器：从一块预留的缓冲区顺序分配，释放是空操作，帧末reset一次全部回收。
+// 容器用std::pmr::vector / std::pmr::string并传入resource()即可。缓冲区不够时向堆申请新块，
+// reset时按本帧的用量把缓冲区扩大，之后各帧的用量不超过峰值就不再访问堆
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t initialBytes = 64 * 1024) { allocate(initialBytes); }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return this; }
+
+    // 帧末调用，此前从arena分配的内存全部失效
+    void reset();
+
+    size_t capacity() const { return capacityBytes; }
+    // 上一帧从arena分配的字节数
+    size_t lastFrameBytes() const { return lastBytes; }
+
+private:
+    // 记录monotonic_buffer_resource越过缓冲区后向堆申请的字节数
+    class OverflowCounter : public std::pmr::memory_resource {
+    public:
+        size_t bytes = 0;
+
+    private:
+        void* do_allocate(size_t size, size_t alignment) override {
+            bytes += size;
+            return std::pmr::new_delete_resource()->allocate(size, alignment);
+        }
+        void do_deallocate(void* p, size_t size, size_t alignment) override {
+            std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    std::unique_ptr<std::byte[]> buffer;
+    size_t capacityBytes = 0;
+    size_t usedBytes = 0;
+    size_t lastBytes = 0;
+    OverflowCounter overflow;
+    std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+
+    void allocate(size_t bytes);
+
+    void* do_allocate(size_t size, size_t alignment) override {
+        usedBytes += size;
+        return monotonic->allocate(size, alignment);
+    }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+#endif
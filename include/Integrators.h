@@ -0,0 +1,68 @@
+#ifndef INTEGRATORS_H
+#define INTEGRATORS_H
+#include <cstddef>
+#include "../Dependencies/cPhysics/include/cphysics.h"
+#include "BodyStore.h"
+
+// 时间积分方法。每步由一段可选的起始漂移和若干阶段组成，每个阶段之前求一次作用力（写入ax/ay）：
+//   SemiImplicitEuler  原来的半隐式欧拉，一次求力，一阶
+//   Leapfrog           漂移-踢-漂移形式的蛙跳（与速度Verlet等价），一次求力，二阶辛积分
+//   Yoshida4           三个蛙跳步按Yoshida系数组合，三次求力，四阶辛积分
+//   Rk4                经典四阶Runge-Kutta，四次求力；不是辛方法，能量会缓慢耗散，适合有阻尼等非保守的场合
+// 边界反弹与位置限制只在最后一个阶段处理；接触、连续碰撞等仍在积分之后按原来的顺序进行
+enum class Integrator { SemiImplicitEuler, Leapfrog, Yoshida4, Rk4 };
+
+constexpr int INTEGRATOR_COUNT = 4;
+
+const char* IntegratorName(Integrator integrator);
+
+// 每步求作用力的次数，即阶段数
+int IntegratorStages(Integrator integrator);
+
+// 第一次求力之前是否需要起始阶段（漂移或保存步初状态）
+bool IntegratorHasBegin(Integrator integrator);
+
+// 积分用到的均匀场加速度与边界
+struct IntegrationParams {
+    float dt = 0.0f;
+    float gx = 0.0f, gy = 0.0f;  // 重力场加速度
+    float ex = 0.0f, ey = 0.0f;  // 电场强度，加速度为 q·E/m
+    float aspect = 1.0f;
+    float restitution = 0.8f;
+    bool walls = true;  // 接触求解器启用时边界由求解器处理
+};
+
+IntegrationParams MakeIntegrationParams(float dt, const gravitational_field& gfield, const electric_field& efield,
+                                        float aspect, float restitution, bool walls);
+
+// RK4保存步初的状态与各阶段导数的加权和，其它方法不使用
+struct IntegratorScratch {
+    AlignedVector<float> x0, y0, vx0, vy0;
+    AlignedVector<float> sumX, sumY, sumVx, sumVy;
+
+    // 在求力与积分开始之前调用（单线程），容量跨步复用
+    void prepare(Integrator integrator, size_t count);
+};
+
+// 对[begin, end)中醒着的可移动物体执行起始阶段；静止与休眠的物体不受影响
+void BeginIntegrationRange(Integrator integrator, BodyStore& store, IntegratorScratch& scratch,
+                           const IntegrationParams& params, size_t begin, size_t end);
+
+// 第stage次求力之后：用ax/ay与均匀场更新速度和位置并清零加速度，最后一个阶段处理边界。
+// 各物体互不影响，可以分块并行
+void IntegrationStageRange(Integrator integrator, int stage, BodyStore& store, IntegratorScratch& scratch,
+                           const IntegrationParams& params, size_t begin, size_t end);
+
+// 系统总能量（双精度，O(N²)）：动能、两两引力势（与合并内核相同的Plummer软化）、
+// 库仑势（距离小于内核下限时按恒力延长，不计最大力限制）以及均匀场的势能，用于比较积分方法的能量漂移
+struct EnergyReport {
+    double kinetic = 0.0;
+    double potential = 0.0;
+
+    double total() const { return kinetic + potential; }
+};
+
+EnergyReport MeasureEnergy(const BodyStore& bodies, const gravitational_field& gfield,
+                           const electric_field& efield, float softening);
+
+#endif
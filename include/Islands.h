@@ -0,0 +1,42 @@
+#ifndef ISLANDS_H
+#define ISLANDS_H
+#include <vector>
+#include <cstdint>
+#include "BodyStore.h"
+#include "Broadphase.h"
+
+struct SleepSettings {
+    bool enabled = true;
+    float velocityThreshold = 0.02f;  // 本步位移除以dt低于此值开始计时
+    float timeToSleep = 0.5f;         // 整个岛都静止这么久后一起休眠
+
+    bool operator==(const SleepSettings&) const = default;
+};
+
+// 接触岛：以本步实际接触的物体对为边，用并查集把可移动物体分组（静止物体不连接岛）。
+// 岛内所有物体的静止时间都达到timeToSleep时整岛休眠；只要有一个物体在动，整岛保持唤醒，
+// 因此运动物体碰到休眠的堆时会把整个堆唤醒
+class IslandManager {
+public:
+    // contacts为本步窄相确认接触的配对，以及两端都在休眠的粗检测配对（保持休眠堆的连通）
+    void update(BodyStore& bodies, const PairList& contacts, const SleepSettings& settings, float dt);
+
+    size_t islandCount() const { return islands; }
+    size_t sleepingCount() const { return sleeping; }
+
+private:
+    uint32_t find(uint32_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    std::vector<uint32_t> parent;
+    std::vector<float> islandSleepTime;  // 以根为下标，岛内最短的静止时间
+    size_t islands = 0;
+    size_t sleeping = 0;
+};
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "World.h"
+
+// 对世界的每一次外部修改都表示为一条命令，GUI通过ExecuteCommand执行并写入日志，
+// 回放时在相同的步序号上重新执行，得到逐位相同的结果
+enum class CommandType : uint32_t {
+    AddCircle,        // body = 分辨率, values = x, y, radius, mass, charge, movable
+    AddPolygon,       // body = 边数,   values = x, y, radius, mass, charge, movable
+    RemoveObject,     // body
+    ClearWorld,
+    SetPosition,      // body, values = x, y（同时重置插值）
+    SetVelocity,      // body, values = vx, vy
+    SetMass,          // body, values = mass
+    SetCharge,        // body, values = charge
+    SetGravityField,  // values = magnitude, dir_x, dir_y
+    SetElectricField, // values = magnitude, dir_x, dir_y
+    SetBounds,        // values = aspect
+    SetTimeScale,     // values = scale（只影响每帧步数，回放时仅作记录）
+    SetFixedStep,     // values = dt
+    SetMaxSubsteps,   // body = 步数
+    SetGravitySolver, // body = GravitySolver
+    SetBarnesHutTheta,// values = theta
+    SetForceKernel,   // body = ForceKernel
+    SetThreadCount,   // body = 线程数
+    SetSleeping,      // body = 是否允许休眠, values = velocityThreshold, timeToSleep
+    SetContactSolver, // body = 是否启用, values = iterations, correction, restitution, baumgarte, slop, warmStarting
+    SetContinuousCollision, // body = 是否启用, values = motionThreshold, maxSubsteps
+    SetBroadphase,    // body = BroadphaseType
+    SetFmm,           // body = 展开阶数, values = theta, leafCapacity, adaptive
+    SetParticleMesh,  // body = 网格边长, values = p3m, splitCells, assignment
+    SetIntegrator,    // body = Integrator
+};
+
+struct WorldCommand {
+    CommandType type;
+    uint32_t body = 0;
+    double values[6] = {};
+};
+
+struct JournalEntry {
+    uint64_t stepIndex;  // 命令在第stepIndex步执行之前生效
+    WorldCommand command;
+};
+
+void ExecuteCommand(World& world, const WorldCommand& command);
+
+// 把接触求解器的设置打包为一条SetContactSolver命令
+WorldCommand ContactSolverCommand(const ContactSolverSettings& solver);
+WorldCommand ContinuousCollisionCommand(const ContinuousCollisionSettings& continuous);
+WorldCommand FmmCommand(const FmmSettings& fmm);
+WorldCommand ParticleMeshCommand(const ParticleMeshSettings& mesh);
+
+// 界面可直接修改的设置（场、边界、时钟、求解器、时间缩放等）
+struct WorldSettings {
+    double gravity[3];   // magnitude, dir_x, dir_y
+    double electric[3];
+    float aspect;
+    float fixedDeltaTime;
+    int maxSubsteps;
+    GravitySolver gravitySolver;
+    float barnesHutTheta;
+    ForceKernel forceKernel;
+    unsigned threadCount;
+    float timeScale;
+    SleepSettings sleep;
+    ContactSolverSettings contactSolver;
+    ContinuousCollisionSettings continuous;
+    BroadphaseType broadphase;
+    FmmSettings fmm;
+    ParticleMeshSettings particleMesh;
+    Integrator integrator;
+};
+
+// WorldSettings的每一组字段最多对应一条命令
+constexpr size_t MAX_SETTINGS_COMMANDS = 17;
+
+WorldSettings ReadWorldSettings(const World& world, float timeScale);
+
+// 把from到to的变化写成命令（out至少MAX_SETTINGS_COMMANDS条），返回条数；依次执行后世界的设置等于to
+size_t DiffWorldSettings(const WorldSettings& from, const WorldSettings& to, WorldCommand* out);
+
+// 对BodyStore全部数组与步序号做FNV-1a散列，用于校验回放结果
+uint64_t HashWorldState(const World& world);
+
+// 日志文件：文件头、录制开始时的二进制快照、按顺序排列的命令，以及录制结束时的步序号与状态散列
+constexpr char JOURNAL_MAGIC[8] = { 'P', '2', 'D', 'J', 'R', 'N', 'L', '\0' };
+constexpr uint32_t JOURNAL_VERSION = 1;
+
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianMark;
+    uint32_t threadCount;
+    uint32_t simdLevel;
+    uint64_t snapshotSize;
+    uint64_t commandCount;
+    uint64_t finalStepIndex;
+    uint64_t finalHash;
+};
+
+class CommandJournal {
+public:
+    bool isRecording() const { return recording; }
+    size_t commandCount() const { return entries.size(); }
+
+    // 保存当前世界为初始快照，开始记录命令
+    void start(const World& world);
+    void stop() { recording = false; }
+
+    // 执行命令；录制时同时写入日志
+    void submit(World& world, const WorldCommand& command);
+
+    // 写出日志，结尾记录当前世界的步序号与散列
+    bool save(const World& world, const std::string& path) const;
+
+private:
+    bool recording = false;
+    std::string initialSnapshot;
+    std::vector<JournalEntry> entries;
+    unsigned threadCount = 1;
+    SimdLevel simdLevel = SimdLevel::Scalar;
+};
+
+struct JournalData {
+    JournalHeader header;
+    std::vector<unsigned char> snapshot;
+    std::vector<JournalEntry> entries;
+};
+
+bool LoadJournal(const std::string& path, JournalData& journal, std::string& error);
+
+struct ReplayResult {
+    uint64_t steps = 0;
+    uint64_t finalHash = 0;
+    bool hashMatches = false;
+    double seconds = 0.0;
+};
+
+// 从日志中的快照开始，不经过窗口以最快速度重新模拟到录制结束时的步序号
+bool ReplayJournal(World& world, const JournalData& journal, ReplayResult& result, std::string& error);
+
+#endif
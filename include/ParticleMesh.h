@@ -0,0 +1,98 @@
+#ifndef PARTICLE_MESH_H
+#define PARTICLE_MESH_H
+#include <vector>
+#include <complex>
+#include <cstdint>
+#include "BodyStore.h"
+#include "ThreadPool.h"
+#include "SimdKernels.h"
+
+// 质量与电荷分配到网格（以及从网格插值）的权重
+enum class MeshAssignment : uint32_t {
+    Tsc,  // 三角形云，3×3个格点，力连续可导，平滑误差更小
+    Cic,  // 云中单元，2×2个格点，更便宜，但力的导数在格线上不连续，各向异性误差更大
+};
+
+struct ParticleMeshSettings {
+    int gridSize = 128;       // 每边的网格数，取不小于它的2的幂，MIN_GRID ~ MAX_GRID
+    bool p3m = true;          // 叠加截断半径内的直接修正（P3M）；false时为纯PM，力在分割尺度内被平滑
+    float splitCells = 2.0f;  // 长短程分割尺度rs，以网格间距为单位；越大网格部分越准，短程对数按平方增长
+    MeshAssignment assignment = MeshAssignment::Tsc;
+
+    bool operator==(const ParticleMeshSettings&) const = default;
+};
+
+// 粒子-网格方法：把质量与电荷用TSC（默认）或CIC权重分配到覆盖全部物体的正方形网格上，
+// 与平方反比力的长程部分（erf(r/rs)/r势的梯度）做卷积，再用同样的权重插值回物体。
+// 卷积在补零到两倍边长的网格上用自带的基2 FFT计算（非周期边界），质量放实部、电荷放虚部一次变换；
+// 核事先减去分配与插值带来的平滑偏差，几个网格以外网格力的误差按距离的四次方下降。
+// 默认用TSC：CIC的力在格线上有折角，同样网格下误差更大，而P3M的截断半径由网格间距决定，
+// 用CIC达到同样精度需要更细的网格与更多短程对；CIC作为更便宜的选项保留。
+// 平面内的平方反比力主要来自近邻，纯PM只适合作为平滑的背景场，精确到近邻需要P3M。
+// P3M模式下，截断半径内的物体对再直接加上精确力（软化与库仑限制与合并内核相同）减去长程部分，
+// 用链表网格按格子分给线程；每个格子、每行网格只由一个线程写入，结果与线程数无关
+class ParticleMeshSolver {
+public:
+    static constexpr int MIN_GRID = 32;
+    static constexpr int MAX_GRID = 1024;
+    static constexpr float CUTOFF_SPLITS = 3.5f;  // 短程截断半径 = 3.5 rs，erfc(3.5) < 1e-6
+
+    ParticleMeshSettings settings;
+
+    // 对醒着的可移动物体累加加速度，代替ApplyFusedForces
+    void apply(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params);
+
+    int gridSize() const { return n; }
+    double cellSize() const { return h; }
+    double cutoff() const { return cutoffRadius; }
+    // 上一次apply中短程修正的物体对数（有向）
+    size_t shortRangePairCount() const;
+
+private:
+    using Complex = std::complex<double>;
+
+    int n = 0;  // 网格边长
+    int m = 0;  // 补零后的边长 2n
+    double originX = 0.0, originY = 0.0, h = 0.0, rs = 0.0, cutoffRadius = 0.0;
+
+    // 变换表
+    std::vector<Complex> twiddles;
+    std::vector<uint32_t> bitReverse;
+
+    // 长程力核的频谱（以网格间距为单位，x、y两个分量合在一个复数数组里），网格尺寸与分割尺度不变时沿用
+    std::vector<Complex> green;
+    int greenSize = 0;
+    float greenSplit = 0.0f;
+    MeshAssignment greenAssignment = MeshAssignment::Tsc;
+    // grid依次存放核、密度与x方向的场，spectrum为密度的频谱，gridY为y方向的场。
+    // 质量放实部、电荷放虚部；只有一种源时（packed）密度为实数，grid的实部与虚部为x、y方向的场
+    std::vector<Complex> grid, spectrum, gridY;
+    bool packed = false;
+
+    // 按网格行计数排序的物体，用于确定性的并行分配
+    std::vector<uint32_t> bodyCell, rowStart, rowBodies;
+    // 短程修正的链表网格（格子边长不小于截断半径）
+    int chainCells = 0;
+    double chainSize = 0.0;
+    std::vector<uint32_t> chainStart, chainBodies;
+    std::vector<float> chainX, chainY, chainMass, chainCharge;  // 按链表网格顺序排列
+    std::vector<float> shortRangeTable;  // 长程部分的 g(r)/r，按r²等分
+    float tableStep = 0.0f;
+    std::vector<size_t> workerPairs;
+
+    void prepareTransform(int size);
+    void fft(Complex* data, bool inverse) const;
+    // 行变换、转置、再行变换：input被破坏，output为转置后的结果；正反变换都用它，两次转置互相抵消。
+    // 只变换input的前inputRows行（其余为0），只求output的前outputRows行
+    void transform(ThreadPool& pool, std::vector<Complex>& input, std::vector<Complex>& output, bool inverse,
+                   int inputRows, int outputRows);
+
+    void layout(const BodyStore& bodies);
+    void buildGreen(ThreadPool& pool);
+    void deposit(const BodyStore& bodies, ThreadPool& pool, bool gravity);
+    void solve(ThreadPool& pool);
+    void interpolate(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params);
+    void shortRange(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params, float clampDistance);
+};
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef POLYGON_SHAPE_H
+#define POLYGON_SHAPE_H
+#include <cstdint>
+#include "BodyStore.h"
+
+// 多边形都是不转动的正多边形，形状只由边数决定：单位外接圆上的顶点和各边外法线按边数
+// 预先算好一次，所有同边数的多边形共用。世界坐标顶点就是中心加半径乘单位顶点，
+// 只随位置和半径变化，法线与位置无关，窄相中不再需要三角函数、开方和堆分配
+constexpr uint32_t MAX_POLYGON_SIDES = 64;
+
+struct PolygonShape {
+    uint32_t count = 0;
+    float vx[MAX_POLYGON_SIDES];
+    float vy[MAX_POLYGON_SIDES];
+    float nx[MAX_POLYGON_SIDES];  // 边(i, i+1)的单位外法线
+    float ny[MAX_POLYGON_SIDES];
+};
+
+// sides须在[3, MAX_POLYGON_SIDES]内；表在第一次调用时构建，之后只读，可在多线程中使用
+const PolygonShape& GetPolygonShape(uint32_t sides);
+
+// 一个多边形的世界坐标顶点，放在栈上
+struct PolygonVertices {
+    const PolygonShape* shape = nullptr;
+    float x[MAX_POLYGON_SIDES];
+    float y[MAX_POLYGON_SIDES];
+
+    uint32_t size() const { return shape->count; }
+};
+
+inline void GetPolygonVertices(const BodyStore& bodies, uint32_t i, PolygonVertices& out) {
+    const PolygonShape& shape = GetPolygonShape(bodies.vertices[i]);
+    const float cx = bodies.x[i];
+    const float cy = bodies.y[i];
+    const float r = bodies.radius[i];
+    out.shape = &shape;
+    for (uint32_t k = 0; k < shape.count; k++) {
+        out.x[k] = cx + r * shape.vx[k];
+        out.y[k] = cy + r * shape.vy[k];
+    }
+}
+
+#endif
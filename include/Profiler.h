@@ -0,0 +1,148 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+// 分段计时：PROFILE_ZONE在作用域结束时把一段计时写入全局环形缓冲区，
+// 每帧开始时汇总上一帧各段的耗时，供界面画直方图与时间线，也可导出为Chrome trace。
+// 未定义PHYSICS2D_PROFILE时所有宏展开为空，不产生任何代码
+class Profiler {
+public:
+    static constexpr size_t EVENT_CAPACITY = 1 << 16;  // 必须是2的幂
+    static constexpr size_t FRAME_HISTORY = 240;
+    static constexpr size_t MAX_ZONES = 32;
+
+    struct Event {
+        const char* name;  // 字符串字面量，按指针区分
+        uint64_t start;    // 纳秒
+        uint64_t end;
+        uint32_t thread;
+        uint32_t depth;    // 同一线程上的嵌套层数
+    };
+
+    struct Frame {
+        uint64_t start = 0;
+        uint64_t end = 0;
+        float zoneMs[MAX_ZONES] = {};  // 各段在本帧内的总耗时（多线程时累加）
+    };
+
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // 按首次记录的先后为线程分配编号
+    static uint32_t threadIndex() {
+        static std::atomic<uint32_t> next { 0 };
+        thread_local const uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    static uint32_t& threadDepth() {
+        thread_local uint32_t depth = 0;
+        return depth;
+    }
+
+    // 多个线程可同时写入：fetch_add领取槽位，写完后发布序号，读者据此判断槽位是否完整
+    void record(const char* name, uint64_t start, uint64_t end, uint32_t depth) {
+        const uint64_t index = head.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots[index & (EVENT_CAPACITY - 1)];
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.event = { name, start, end, threadIndex(), depth };
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    // 结束上一帧并开始新的一帧，只能在主线程调用；其他线程此时尚未写完的计时不计入任何一帧
+    void beginFrame();
+
+    size_t zoneCount() const { return zones; }
+    const char* zoneName(size_t zone) const { return zoneNames[zone]; }
+
+    // 已完成的帧数（最多FRAME_HISTORY），age为0表示最近一帧
+    size_t frameCount() const { return std::min(completedFrames, FRAME_HISTORY); }
+    const Frame& frame(size_t age) const { return frames[(completedFrames - 1 - age) % FRAME_HISTORY]; }
+
+    // 按从旧到新的顺序取出某一段在最近frameCount()帧中的耗时
+    void zoneHistory(size_t zone, std::vector<float>& out) const;
+
+    // 最近一帧的全部计时，freeze为true时保持不变以便查看
+    const std::vector<Event>& lastFrameEvents() const { return frameEvents; }
+    bool freeze = false;
+
+    // 把环形缓冲区中仍然有效的计时写成Chrome trace（chrome://tracing、Perfetto可打开）
+    bool exportChromeTrace(const std::string& path) const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence { 0 };
+        Event event {};
+    };
+
+    Profiler() : slots(std::make_unique<Slot[]>(EVENT_CAPACITY)) {}
+
+    // 读取第index个计时；槽位已被覆盖或尚未写完时返回false
+    bool read(uint64_t index, Event& event) const;
+    size_t zoneIndex(const char* name);
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> head { 0 };
+
+    uint64_t frameStartIndex = 0;
+    uint64_t frameStartTime = 0;
+    size_t completedFrames = 0;
+    Frame frames[FRAME_HISTORY];
+    std::vector<Event> frameEvents;
+
+    const char* zoneNames[MAX_ZONES] = {};
+    size_t zones = 0;
+};
+
+// 作用域计时，析构时记录；也可提前调用end()
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name)
+        : name(name), depth(Profiler::threadDepth()++), start(Profiler::now()) {}
+    ~ProfileZone() { end(); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+    void end() {
+        if (!name) return;
+        Profiler::instance().record(name, start, Profiler::now(), depth);
+        Profiler::threadDepth()--;
+        name = nullptr;
+    }
+
+private:
+    const char* name;
+    uint32_t depth;
+    uint64_t start;
+};
+
+#ifdef PHYSICS2D_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_ZONE_BEGIN(var, name) ProfileZone var(name)
+#define PROFILE_ZONE_END(var) var.end()
+#define PROFILE_FRAME() Profiler::instance().beginFrame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_ZONE_BEGIN(var, name) ((void)0)
+#define PROFILE_ZONE_END(var) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <print>
+#include "axioms.h"
+#include "PolygonShape.h"
+#include "SimulationThread.h"
+
+// 物理库不依赖OpenGL，绘制代码只在GUI程序中使用。
+// 每种分辨率只有一份静态的单位圆/单位多边形网格，模拟线程发布的实例（上一步与当前步的位置、半径、颜色）
+// 在收到新帧时一次性上传到实例缓冲区，之后每次绘制只更新插值系数，由顶点着色器混合两步的位置；
+// 每批同形状同分辨率的物体用一次glDrawArraysInstanced画完。
+// 只用到OpenGL 3.3 core，Mesa llvmpipe上也能运行。
+class InstancedRenderer {
+public:
+    InstancedRenderer() = default;
+    ~InstancedRenderer() { release(); }
+
+    InstancedRenderer(const InstancedRenderer&) = delete;
+    InstancedRenderer& operator=(const InstancedRenderer&) = delete;
+
+    // 需要在GL上下文创建之后调用
+    bool init() {
+        program = linkProgram(VERTEX_SHADER, FRAGMENT_SHADER);
+        if (!program) return false;
+        viewScaleLocation = glGetUniformLocation(program, "viewScale");
+        alphaLocation = glGetUniformLocation(program, "alpha");
+        glGenBuffers(1, &instanceBuffer);
+        return true;
+    }
+
+    void release() {
+        for (auto& [key, mesh] : meshes) {
+            glDeleteVertexArrays(1, &mesh.vao);
+            glDeleteBuffers(1, &mesh.vbo);
+        }
+        meshes.clear();
+        if (instanceBuffer) glDeleteBuffers(1, &instanceBuffer);
+        if (program) glDeleteProgram(program);
+        instanceBuffer = 0;
+        program = 0;
+    }
+
+    // 与原来glOrtho相同的投影：短边为[-1, 1]，可见范围就是边界
+    void setAspect(float aspect) {
+        float xBound, yBound;
+        WallBounds(aspect, xBound, yBound);
+        viewScaleX = 1.0f / xBound;
+        viewScaleY = 1.0f / yBound;
+    }
+
+    // 上传一帧的实例，批的区间沿用模拟线程打包时的结果
+    void upload(const SimulationFrame& frame) {
+        batches.assign(frame.batches.begin(), frame.batches.end());
+        instanceCount = frame.instances.size();
+        if (instanceCount == 0) return;
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        // 先用nullptr重新分配（orphan），避免等待上一帧仍在使用的缓冲区
+        glBufferData(GL_ARRAY_BUFFER, instanceCount * sizeof(RenderInstance), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instanceCount * sizeof(RenderInstance), frame.instances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // alpha为上一步到当前步之间的插值系数
+    void draw(float alpha) {
+        if (!program || instanceCount == 0) return;
+
+        glUseProgram(program);
+        glUniform2f(viewScaleLocation, viewScaleX, viewScaleY);
+        glUniform1f(alphaLocation, alpha);
+
+        for (const RenderBatch& batch : batches) {
+            const Mesh& mesh = meshFor(batch.isCircle, batch.segments);
+            glBindVertexArray(mesh.vao);
+            bindInstanceAttributes(batch.first);
+            glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, mesh.vertexCount, static_cast<GLsizei>(batch.count));
+        }
+
+        glBindVertexArray(0);
+        glUseProgram(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+private:
+    struct Mesh {
+        GLuint vao = 0;
+        GLuint vbo = 0;
+        GLsizei vertexCount = 0;
+    };
+
+    struct BatchKey {
+        bool isCircle;
+        int segments;
+        bool operator<(const BatchKey& other) const {
+            return isCircle != other.isCircle ? isCircle < other.isCircle : segments < other.segments;
+        }
+    };
+
+    static constexpr const char* VERTEX_SHADER = R"(#version 330 core
+layout(location = 0) in vec2 unitPosition;
+layout(location = 1) in vec3 instance;
+layout(location = 2) in vec4 instanceColor;
+layout(location = 3) in vec2 previous;
+uniform vec2 viewScale;
+uniform float alpha;
+out vec4 color;
+void main() {
+    vec2 world = mix(previous, instance.xy, alpha) + unitPosition * instance.z;
+    gl_Position = vec4(world * viewScale, 0.0, 1.0);
+    color = instanceColor;
+}
+)";
+
+    static constexpr const char* FRAGMENT_SHADER = R"(#version 330 core
+in vec4 color;
+out vec4 fragColor;
+void main() {
+    fragColor = color;
+}
+)";
+
+    GLuint program = 0;
+    GLint viewScaleLocation = -1;
+    GLint alphaLocation = -1;
+    GLuint instanceBuffer = 0;
+    float viewScaleX = 1.0f;
+    float viewScaleY = 1.0f;
+    std::map<BatchKey, Mesh> meshes;
+    std::vector<RenderBatch> batches;
+    size_t instanceCount = 0;
+
+    // 圆：中心点加res+1个边界点组成三角扇；多边形：sides个顶点直接组成三角扇
+    const Mesh& meshFor(bool isCircle, int segments) {
+        auto it = meshes.find({ isCircle, segments });
+        if (it != meshes.end()) return it->second;
+
+        std::vector<float> vertices;
+        if (isCircle) {
+            vertices.push_back(0.0f);
+            vertices.push_back(0.0f);
+            for (int i = 0; i <= segments; i++) {
+                const float angle = 2.0f * PI * i / segments;
+                vertices.push_back(cosf(angle));
+                vertices.push_back(sinf(angle));
+            }
+        } else {
+            // 与窄相共用同一份单位多边形
+            const PolygonShape& shape = GetPolygonShape(static_cast<uint32_t>(segments));
+            for (uint32_t i = 0; i < shape.count; i++) {
+                vertices.push_back(shape.vx[i]);
+                vertices.push_back(shape.vy[i]);
+            }
+        }
+
+        Mesh mesh;
+        mesh.vertexCount = static_cast<GLsizei>(vertices.size() / 2);
+        glGenVertexArrays(1, &mesh.vao);
+        glGenBuffers(1, &mesh.vbo);
+        glBindVertexArray(mesh.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(2);
+        glVertexAttribDivisor(2, 1);
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, 1);
+        glBindVertexArray(0);
+
+        return meshes.emplace(BatchKey{ isCircle, segments }, mesh).first->second;
+    }
+
+    // GL 3.3没有baseInstance，用属性指针的偏移选中这一批实例
+    void bindInstanceAttributes(size_t first) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        const size_t base = first * sizeof(RenderInstance);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(RenderInstance),
+                              reinterpret_cast<const void*>(base + offsetof(RenderInstance, x)));
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(RenderInstance),
+                              reinterpret_cast<const void*>(base + offsetof(RenderInstance, color)));
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(RenderInstance),
+                              reinterpret_cast<const void*>(base + offsetof(RenderInstance, prevX)));
+    }
+
+    static GLuint compileShader(GLenum type, const char* source) {
+        GLuint shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+
+        GLint ok = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            std::println("Shader compile error: {}", log);
+            glDeleteShader(shader);
+            return 0;
+        }
+        return shader;
+    }
+
+    static GLuint linkProgram(const char* vertexSource, const char* fragmentSource) {
+        GLuint vertex = compileShader(GL_VERTEX_SHADER, vertexSource);
+        GLuint fragment = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+        if (!vertex || !fragment) {
+            if (vertex) glDeleteShader(vertex);
+            if (fragment) glDeleteShader(fragment);
+            return 0;
+        }
+
+        GLuint linked = glCreateProgram();
+        glAttachShader(linked, vertex);
+        glAttachShader(linked, fragment);
+        glLinkProgram(linked);
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+
+        GLint ok = GL_FALSE;
+        glGetProgramiv(linked, GL_LINK_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetProgramInfoLog(linked, sizeof(log), nullptr, log);
+            std::println("Shader link error: {}", log);
+            glDeleteProgram(linked);
+            return 0;
+        }
+        return linked;
+    }
+};
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef SCENE_H
+#define SCENE_H
+#include <string>
+#include "World.h"
+
+// 文本场景格式，每行一条记录，'#'开头为注释：
+//   gravity  <magnitude> <dir_x> <dir_y>
+//   electric <magnitude> <dir_x> <dir_y>
+//   bounds   <aspect>
+//   circle   <x> <y> <radius> <mass> <charge> <movable> [vx vy]
+//   polygon  <sides> <radius> <x> <y> <mass> <charge> <movable> [vx vy]
+bool LoadScene(World& world, const std::string& path, std::string& error);
+bool SaveScene(const World& world, const std::string& path);
+
+#endif
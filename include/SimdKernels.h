@@ -0,0 +1,51 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+#include <cstddef>
+#include <cstdint>
+#include "BodyStore.h"
+
+// 运行时根据CPU特性选择的向量指令集
+enum class SimdLevel { Scalar, NEON, AVX2, AVX512 };
+
+// 两两作用力的实现方式：原有的对称标量循环，或合并的向量内核
+enum class ForceKernel { Scalar, Simd };
+
+SimdLevel DetectSimdLevel();
+bool SimdLevelSupported(SimdLevel level);
+const char* SimdLevelName(SimdLevel level);
+int SimdLevelWidth(SimdLevel level);
+
+// 库仑力的限制与标量路径一致：距离不小于0.1（1/r不超过10），力的大小不超过1000
+constexpr float COULOMB_MAX_INV_DISTANCE = 10.0f;
+constexpr float COULOMB_MAX_FORCE = 1000.0f;
+
+struct FusedForceParams {
+    float softening = 1e-3f;  // Plummer软化长度，取代 distance < 0.001f 的分支
+    bool gravity = true;
+    bool coulomb = true;
+};
+
+// 引力与库仑力合并为一遍：对[begin, end)内的目标物体，一次处理一个向量宽度的目标，
+// 遍历全部源物体累加加速度。只写目标的ax/ay，可按目标区间安全地分给多个线程。
+// 库仑部分保留标量路径的最小距离与最大力限制。不检查电荷是否全为0，
+// 调用方在没有电荷时应把params.coulomb设为false（World::step每步判断一次）
+void ApplyFusedForces(BodyStore& bodies, size_t begin, size_t end, const FusedForceParams& params, SimdLevel level);
+
+// 任意排列的物体数组，例如FMM按树序重排后的副本
+struct ForceArrays {
+    const float* x;
+    const float* y;
+    const float* mass;
+    const float* charge;
+    const float* invMass;
+    const uint32_t* flags;
+    float* ax;
+    float* ay;
+};
+
+// 同一内核，但目标[begin, end)只与源[sourceBegin, sourceEnd)作用（FMM的近场）。
+// 目标与源可以是同一区间（自身配对dx = dy = 0，没有贡献）；不检查电荷是否全为0
+void ApplyFusedForcesRange(const ForceArrays& arrays, size_t begin, size_t end, size_t sourceBegin, size_t sourceEnd,
+                           const FusedForceParams& params, SimdLevel level);
+
+#endif
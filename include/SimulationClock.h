@@ -0,0 +1,67 @@
+#ifndef SIMULATION_CLOCK_H
+#define SIMULATION_CLOCK_H
+#include <cstdint>
+#include <algorithm>
+
+// 固定步长模拟时钟：累加每帧经过的时间，按固定dt拆分为若干物理步，
+// 剩余不足一步的时间作为渲染插值系数alpha
+class SimulationClock {
+public:
+    explicit SimulationClock(float fixedDt = 1.0f / 120.0f, int maxSubsteps = 8)
+        : fixedDeltaTime(fixedDt), maxSubsteps(maxSubsteps) {}
+
+    // 返回本帧需要执行的固定步数；超过上限的部分直接丢弃，避免越算越慢的死循环
+    int advance(float frameTime) {
+        accumulator += std::max(frameTime, 0.0f);
+
+        int steps = static_cast<int>(accumulator / fixedDeltaTime);
+        if (steps > maxSubsteps) {
+            droppedTime += accumulator - maxSubsteps * fixedDeltaTime;
+            steps = maxSubsteps;
+            accumulator = static_cast<float>(steps) * fixedDeltaTime;
+        }
+
+        accumulator -= static_cast<float>(steps) * fixedDeltaTime;
+        stepCount += static_cast<uint64_t>(steps);
+        lastSteps = steps;
+        return steps;
+    }
+
+    float getAlpha() const { return std::clamp(accumulator / fixedDeltaTime, 0.0f, 1.0f); }
+
+    float getFixedDeltaTime() const { return fixedDeltaTime; }
+    void setFixedDeltaTime(float dt) { fixedDeltaTime = std::max(dt, 1e-5f); }
+
+    int getMaxSubsteps() const { return maxSubsteps; }
+    void setMaxSubsteps(int steps) { maxSubsteps = std::max(steps, 1); }
+
+    int getLastSteps() const { return lastSteps; }
+    uint64_t getStepCount() const { return stepCount; }
+    double getDroppedTime() const { return droppedTime; }
+    float getAccumulator() const { return accumulator; }
+
+    // 从快照恢复时钟状态
+    void restore(float accumulatedTime, uint64_t steps, double dropped) {
+        accumulator = std::max(accumulatedTime, 0.0f);
+        stepCount = steps;
+        droppedTime = dropped;
+        lastSteps = 0;
+    }
+
+    void reset() {
+        accumulator = 0.0f;
+        stepCount = 0;
+        lastSteps = 0;
+        droppedTime = 0.0;
+    }
+
+private:
+    float fixedDeltaTime;
+    int maxSubsteps;
+    float accumulator = 0.0f;
+    uint64_t stepCount = 0;
+    int lastSteps = 0;
+    double droppedTime = 0.0;
+};
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef SIMULATION_THREAD_H
+#define SIMULATION_THREAD_H
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <map>
+#include <utility>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "World.h"
+#include "Journal.h"
+#include "BarnesHut.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+
+// 界面发给模拟线程的请求：World类命令经日志执行（录制时写入），其余为快照、日志与精度报告等操作
+enum class SimulationRequest : uint32_t {
+    World,
+    SaveSnapshot,      // path
+    LoadSnapshot,      // path
+    StartRecording,
+    StopRecording,     // path，停止并写出日志
+    AccuracyReport,
+};
+
+struct SimulationCommand {
+    SimulationRequest request = SimulationRequest::World;
+    WorldCommand command { CommandType::ClearWorld };
+    char path[260] = {};
+    // 按物体下标操作的命令所依据的帧的layoutRevision；执行时物体排列已经改变则丢弃
+    uint64_t layoutRevision = 0;
+};
+
+// 命令是否按下标指定物体，以及执行后是否改变物体的排列（下标）
+bool CommandTargetsBody(CommandType type);
+bool CommandChangesLayout(CommandType type);
+
+// 一个绘制实例：上一步与当前步的位置，界面按插值系数在着色器中混合
+struct RenderInstance {
+    float prevX, prevY;
+    float x, y, radius;
+    uint32_t color;  // RGBA8，低字节为R
+
+    static constexpr uint32_t CIRCLE_COLOR = 0xFFFFFFFFu;
+    static constexpr uint32_t POLYGON_COLOR = 0xFFFF0000u;
+    // 休眠物体用暗色绘制
+    static constexpr uint32_t SLEEPING_CIRCLE_COLOR = 0xFF808080u;
+    static constexpr uint32_t SLEEPING_POLYGON_COLOR = 0xFF800000u;
+};
+
+// 同形状同分辨率的一批实例在instances中的区间
+struct RenderBatch {
+    bool isCircle;
+    int segments;
+    size_t first;
+    size_t count;
+};
+
+// 模拟线程每次步进后发布的只读状态，界面只读它而不接触World
+struct SimulationFrame {
+    BodyStore bodies;  // 物体列表与鼠标拾取用
+    std::vector<RenderInstance> instances;
+    std::vector<RenderBatch> batches;
+
+    uint64_t stepIndex = 0;
+    float alpha = 0.0f;         // 发布时的插值系数
+    double publishTime = 0.0;   // 发布时刻（steady_clock，秒）
+    WorldSettings settings {};  // 执行完已收到的命令后世界的设置
+    uint64_t revision = 0;      // 读取快照后加一，界面据此重新同步设置并取消拖拽
+    uint64_t layoutRevision = 0;  // 物体增删、清空或读取快照后加一，界面据此取消拖拽
+    SimdLevel simdLevel = SimdLevel::Scalar;
+
+    // 统计
+    int lastSteps = 0;
+    double droppedTime = 0.0;
+    float stepMilliseconds = 0.0f;  // 最近一次发布前平均每步的耗时
+    size_t pairs = 0;
+    BroadphaseStats broadphaseStats {};
+    int treeHeight = 0;
+    size_t arenaBytes = 0, arenaCapacity = 0;
+    size_t sleeping = 0, islands = 0;
+    size_t contacts = 0;
+    size_t fastBodies = 0, impacts = 0;
+    uint64_t steals = 0;
+    size_t quadTreeNodes = 0;
+    size_t fmmNodes = 0, fmmFarPairs = 0, fmmNearPairs = 0;
+    int fmmDepth = 0;
+    double meshCell = 0.0, meshCutoff = 0.0;
+    size_t meshPairs = 0;
+
+    bool recording = false;
+    size_t journalCommands = 0;
+    char snapshotStatus[320] = {};
+    char journalStatus[320] = {};
+
+    static constexpr size_t MAX_REPORTS = 5;
+    GravityAccuracyReport reports[MAX_REPORTS] = {};
+    size_t reportCount = 0;
+};
+
+// 专用的模拟线程：按真实时间乘以时间缩放推进固定步，每次步进后把状态写入三缓冲并发布。
+// 界面线程的修改经单生产者单消费者队列送来，在下一步之前按顺序执行；两边都不等待对方，
+// 界面按自己的刷新率取最新一帧，模拟线程也不受垂直同步限制。
+// World只由模拟线程访问（start之前可以直接设置），线程池因此仍只有一个提交者
+class SimulationThread {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+    static constexpr size_t PACK_GRAIN = 4096;  // 每块打包的物体数
+
+    World world;
+
+    SimulationThread() = default;
+    ~SimulationThread() { stop(); }
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    void start(float timeScale);
+    void stop();
+
+    // 界面线程：队列满时让出时间片直到有空位
+    void submit(const SimulationCommand& command);
+    // layoutRevision取自界面读取物体下标的那一帧
+    void submit(const WorldCommand& command, uint64_t layoutRevision) {
+        submit(SimulationCommand { SimulationRequest::World, command, {}, layoutRevision });
+    }
+
+    // 界面线程：取最新发布的一帧，返回是否有新帧；front在下一次acquire之前保持不变
+    bool acquire() { return frames.acquire(); }
+    const SimulationFrame& front() const { return frames.front(); }
+
+    static double now();
+
+private:
+    std::thread thread;
+    std::atomic<bool> stopping { false };
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool pending = false;  // 有新命令，受wakeMutex保护
+
+    SpscQueue<SimulationCommand, QUEUE_CAPACITY> commands;
+    TripleBuffer<SimulationFrame> frames;
+
+    // 以下只由模拟线程访问
+    CommandJournal journal;
+    float timeScale = 1.0f;
+    uint64_t revision = 0;
+    uint64_t layoutRevision = 0;
+    std::string snapshotStatus, journalStatus;
+    GravityAccuracyReport reports[SimulationFrame::MAX_REPORTS] = {};
+    size_t reportCount = 0;
+
+    // 实例打包：每批的区间、每个物体所在的批与在instances中的位置
+    std::map<std::pair<bool, int>, RenderBatch> batches;
+    std::vector<RenderBatch*> bodyBatch;
+    std::vector<uint32_t> slots;
+
+    void run();
+    bool execute();  // 执行队列中全部命令，返回是否执行了命令
+    void execute(const SimulationCommand& command);
+    void publish(double time, float stepMilliseconds);
+    void pack(SimulationFrame& frame);
+};
+
+#endif
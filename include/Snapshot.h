@@ -0,0 +1,66 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+#include "World.h"
+
+// 二进制快照：文件头保存场、求解器设置与时钟状态，随后是BodyStore的每个数组，
+// 按forEachArray的顺序各自一次性写入并按64字节对齐。读取时用mmap映射文件后直接拷贝，
+// 不做任何解析。数据按本机字节序存储，文件头中的字节序标记不符时拒绝加载。
+// 版本3起，最后一个数组之后（对齐后）存放接触求解器热启动用的ContactImpulse；
+// 版本4在文件头末尾增加了积分方法，旧文件按半隐式欧拉读取
+constexpr char SNAPSHOT_MAGIC[8] = { 'P', '2', 'D', 'S', 'N', 'A', 'P', '\0' };
+constexpr uint32_t SNAPSHOT_VERSION = 4;
+// 各版本的数组个数：版本2增加了sleepTime
+constexpr uint32_t SNAPSHOT_ARRAY_COUNTS[SNAPSHOT_VERSION] = { 15, 16, 16, 16 };
+constexpr uint32_t SNAPSHOT_ENDIAN_MARK = 0x01020304u;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endianMark;
+    uint32_t headerSize;
+    uint32_t arrayCount;
+    uint64_t bodyCount;
+
+    double gravity[3];   // magnitude, dir_x, dir_y
+    double electric[3];
+    float aspect;
+
+    uint32_t gravitySolver;
+    float barnesHutTheta;
+    uint32_t forceKernel;
+
+    float fixedDeltaTime;
+    int32_t maxSubsteps;
+    float accumulator;
+    uint32_t impulseCount;  // 版本3之前为0
+    uint64_t stepCount;
+    double droppedTime;
+    uint64_t stepIndex;  // World::stepIndex，续跑时从这里继续计数
+
+    // 版本4
+    uint32_t integrator;
+    uint32_t reserved;
+};
+
+// 版本3及以前的文件头到stepIndex为止
+constexpr size_t SNAPSHOT_V3_HEADER_SIZE = offsetof(SnapshotHeader, integrator);
+
+// 文件头之后紧跟arrayCount个数组描述
+struct SnapshotArray {
+    uint64_t offset;
+    uint32_t elementSize;
+    uint32_t reserved;
+};
+
+bool SaveSnapshot(const World& world, const std::string& path);
+bool LoadSnapshot(World& world, const std::string& path, std::string& error);
+
+// 写入任意输出流/从内存读取，供回放日志内嵌初始快照使用；path只用于错误信息
+bool WriteSnapshot(const World& world, std::ostream& out);
+bool ReadSnapshot(World& world, const unsigned char* data, size_t length, const std::string& path, std::string& error);
+
+#endif
@@ -0,0 +1,202 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+class TaskGraph;
+
+// 一个可分块执行的任务：[begin, end)按grain切成chunks块，每块调用一次invoke(target, first, last)。
+// 只保存可调用对象的地址和一个调用函数，不像std::function那样可能为捕获较多的lambda分配堆内存。
+// nextChunk与remaining在执行期间用std::atomic_ref访问
+struct PoolTask {
+    void* target = nullptr;
+    void (*invoke)(void*, size_t, size_t) = nullptr;
+    size_t begin = 0;
+    size_t end = 0;
+    size_t grain = 1;
+    size_t chunks = 0;
+    size_t nextChunk = 0;  // 下一个待领取的块，每个出队的条目领取一块
+    size_t remaining = 0;  // 尚未完成的块数，归零时任务完成
+    TaskGraph* graph = nullptr;  // 属于任务图时释放后继节点
+    uint32_t node = 0;
+
+    void reset(size_t first, size_t last, size_t chunkSize) {
+        begin = first;
+        end = std::max(first, last);
+        grain = std::max<size_t>(chunkSize, 1);
+        chunks = (end - begin + grain - 1) / grain;
+        nextChunk = 0;
+        remaining = chunks;
+    }
+};
+
+// 带依赖的任务图：节点是单个任务或分块的区间任务，precede(a, b)表示b在a完成后才开始。
+// 没有依赖关系的节点可以同时执行；图只保存可调用对象的地址，调用者保证它们在run返回前有效。
+// clear保留容量，每步重建同样形状的图不分配堆内存
+class TaskGraph {
+public:
+    using NodeId = uint32_t;
+
+    void clear() {
+        tasks.clear();
+        edges.clear();
+    }
+
+    size_t size() const { return tasks.size(); }
+
+    // 单个任务：job()
+    template <typename Job>
+    NodeId add(Job& job) {
+        PoolTask& task = push(&job);
+        task.invoke = [](void* target, size_t, size_t) { (*static_cast<Job*>(target))(); };
+        task.reset(0, 1, 1);
+        return task.node;
+    }
+
+    // 区间任务：[begin, end)按grain分块，每块调用job(first, last)，各块可被不同线程执行
+    template <typename Job>
+    NodeId addRange(size_t begin, size_t end, size_t grain, Job& job) {
+        PoolTask& task = push(&job);
+        task.invoke = [](void* target, size_t first, size_t last) { (*static_cast<Job*>(target))(first, last); };
+        task.reset(begin, end, grain);
+        return task.node;
+    }
+
+    void precede(NodeId before, NodeId after) { edges.emplace_back(before, after); }
+
+private:
+    friend class ThreadPool;
+
+    std::vector<PoolTask> tasks;
+    std::vector<std::pair<NodeId, NodeId>> edges;
+    // 运行前由edges整理出的后继表（CSR）与每个节点尚未完成的前驱数
+    std::vector<uint32_t> successorStart, successors, waiting;
+    size_t unfinished = 0;  // 尚未完成的节点数
+
+    template <typename Job>
+    PoolTask& push(Job* job) {
+        PoolTask& task = tasks.emplace_back();
+        task.target = const_cast<void*>(static_cast<const void*>(job));
+        task.graph = this;
+        task.node = static_cast<NodeId>(tasks.size() - 1);
+        return task;
+    }
+};
+
+// 工作窃取线程池，引擎各阶段共用：每个线程（调用线程为0号）有一个固定容量的Chase-Lev双端队列，
+// 自己从队尾取任务，空闲时从其它线程的队首窃取。任务在等待期间由等待的线程帮忙执行，
+// 因此任务内部可以再嵌套dispatch/parallelFor/run。线程数为1时全部在调用线程上按顺序执行，便于调试。
+// 同一时刻只允许一个外部线程向线程池提交任务
+class ThreadPool {
+public:
+    static constexpr size_t QUEUE_CAPACITY = 4096;  // 每个队列的条目数（2的幂），满时直接执行
+    static constexpr size_t CHUNKS_PER_THREAD = 4;  // parallelFor自动分块时每个线程平均的块数
+
+    explicit ThreadPool(unsigned threads = 1) { resize(threads); }
+    ~ThreadPool() { stop(); }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return slotCount; }
+
+    void resize(unsigned threads);
+
+    // 执行job(worker)，worker取遍[0, size())，返回前等待全部完成；
+    // worker是分工编号而不是线程编号，按它静态分工与使用各自的缓冲区，结果与调度顺序无关
+    template <typename Job>
+    void dispatch(Job&& job) {
+        if (slotCount == 1) {
+            job(0u);
+            return;
+        }
+        PoolTask task;
+        task.target = const_cast<void*>(static_cast<const void*>(&job));
+        task.invoke = [](void* target, size_t first, size_t) {
+            (*static_cast<std::remove_reference_t<Job>*>(target))(static_cast<unsigned>(first));
+        };
+        task.reset(0, slotCount, 1);
+        run(task);
+    }
+
+    // 把[0, count)按线程数均分，返回worker负责的区间
+    static void splitRange(size_t count, unsigned worker, unsigned workerCount, size_t& begin, size_t& end) {
+        const size_t chunk = (count + workerCount - 1) / workerCount;
+        begin = std::min(count, chunk * worker);
+        end = std::min(count, begin + chunk);
+    }
+
+    // 把[begin, end)按grain分块（0为按线程数自动分块），各块由空闲线程领取或窃取，对每块执行job(first, last)
+    template <typename Job>
+    void parallelRange(size_t begin, size_t end, size_t grain, Job&& job) {
+        if (begin >= end) return;
+        if (slotCount == 1) {
+            job(begin, end);
+            return;
+        }
+        if (grain == 0) grain = autoGrain(end - begin);
+        PoolTask task;
+        task.target = const_cast<void*>(static_cast<const void*>(&job));
+        task.invoke = [](void* target, size_t first, size_t last) {
+            (*static_cast<std::remove_reference_t<Job>*>(target))(first, last);
+        };
+        task.reset(begin, end, grain);
+        run(task);
+    }
+
+    // 对[begin, end)中的每个下标执行job(k)
+    template <typename Job>
+    void parallelFor(size_t begin, size_t end, Job&& job) {
+        parallelRange(begin, end, 0, [&](size_t first, size_t last) {
+            for (size_t k = first; k < last; k++) job(k);
+        });
+    }
+
+    // 执行任务图，返回前等待全部节点完成
+    void run(TaskGraph& graph);
+
+    // 累计被其它线程窃取执行的块数
+    uint64_t stealCount() const { return steals.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) WorkQueue {
+        alignas(64) std::atomic<int64_t> top { 0 };
+        alignas(64) std::atomic<int64_t> bottom { 0 };
+        std::atomic<PoolTask*> entries[QUEUE_CAPACITY] {};
+
+        bool push(PoolTask* task);
+        PoolTask* pop();
+        PoolTask* steal();
+    };
+
+    unsigned slotCount = 0;
+    std::unique_ptr<WorkQueue[]> queues;
+    std::vector<std::thread> workers;
+    std::atomic<uint32_t> epoch { 0 };  // 每次提交新任务加一，空闲线程在它上面等待
+    std::atomic<bool> stopping { false };
+    std::atomic<uint64_t> steals { 0 };
+
+    size_t autoGrain(size_t count) const {
+        const size_t chunks = static_cast<size_t>(slotCount) * CHUNKS_PER_THREAD;
+        return std::max<size_t>(1, (count + chunks - 1) / chunks);
+    }
+
+    unsigned currentSlot() const;
+    void run(PoolTask& task);
+    void submit(PoolTask& task, unsigned slot);
+    void execute(PoolTask* task, unsigned slot);
+    void finish(TaskGraph& graph, uint32_t node, unsigned slot);
+    PoolTask* findWork(unsigned slot);
+    void helpUntilZero(size_t& counter, unsigned slot);
+    void workerLoop(unsigned slot);
+    void stop();
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+#include <atomic>
+#include <cstdint>
+
+// 单写单读的无锁三缓冲：写者总有一个自己的后台槽位，读者总有一个自己的前台槽位，
+// 第三个槽位在两者之间交换。写者publish把写好的槽位换到中间，读者acquire把中间最新的槽位换到前台；
+// 双方都只做一次原子交换，互不等待，读者跳过的旧帧直接被覆盖。
+// 槽位的内容跨交换保留，写者可以复用其中容器的容量
+template <typename T>
+class TripleBuffer {
+public:
+    // 写者：本次要写入的槽位（内容为两次发布之前的旧数据）
+    T& back() { return slots[backIndex]; }
+
+    void publish() {
+        backIndex = shared.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // 读者：有新发布的槽位时换到前台并返回true，否则前台保持不变
+    bool acquire() {
+        if ((shared.load(std::memory_order_relaxed) & FRESH) == 0) return false;
+        frontIndex = shared.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr uint32_t INDEX_MASK = 3;
+    static constexpr uint32_t FRESH = 4;  // 中间槽位是尚未被读者取走的新数据
+
+    T slots[3];
+    std::atomic<uint32_t> shared { 1 };
+    uint32_t backIndex = 0;
+    uint32_t frontIndex = 2;
+};
+
+#endif
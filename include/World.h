@@ -0,0 +1,111 @@
+#ifndef WORLD_H
+#define WORLD_H
+#include <vector>
+#include <memory>
+#include "BodyStore.h"
+#include "Circle.h"
+#include "polygon.h"
+#include "Forces.h"
+#include "SimdKernels.h"
+#include "Fmm.h"
+#include "ParticleMesh.h"
+#include "Broadphase.h"
+#include "Collision.h"
+#include "PolygonShape.h"
+#include "ContactSolver.h"
+#include "ContinuousCollision.h"
+#include "Islands.h"
+#include "SimulationClock.h"
+#include "FrameArena.h"
+#include "Integrators.h"
+
+// 整个模拟世界：物体数据、均匀场、求解器设置与时钟，GUI与无界面运行共用
+class World {
+public:
+    BodyStore bodies;
+    std::vector<std::unique_ptr<Object>> objects;
+
+    gravitational_field gf;
+    electric_field ef;
+
+    GravitySolver gravitySolver = GravitySolver::Exact;
+    float barnesHutTheta = 0.5f;
+    QuadTree gravityTree;
+    FmmSolver fmm;
+    ParticleMeshSolver particleMesh;
+
+    // 各阶段共用的工作窃取线程池，step每步把阶段重建为stepGraph（保留容量）
+    ThreadPool pool;
+    TaskGraph stepGraph;
+    ParallelForceBuffers forceBuffers;
+
+    // 步内临时数据（配对与接触列表、CCD网格游标）的线性分配器，每步末尾整体回收；
+    // 持久的容器仍用成员vector并跨步复用容量。它不是线程安全的，只在任务图中前后有序的节点里使用
+    FrameArena frameArena;
+
+    // 两两作用力默认走合并后的SIMD内核，Scalar保留原来的对称标量实现
+    ForceKernel forceKernel = ForceKernel::Simd;
+    SimdLevel simdLevel = DetectSimdLevel();
+    FusedForceParams fusedForces;
+
+    // 通过setBroadphase切换，两者保持一致
+    BroadphaseType broadphaseType = BroadphaseType::SpatialHash;
+    std::unique_ptr<Broadphase> broadphase;
+    // 本步的候选配对与实际接触的配对（用于划分岛），从frameArena分配，步末释放
+    PairList collisionPairs { frameArena.resource() };
+    PairList contacts { frameArena.resource() };
+    size_t pairCount = 0;  // 上一步的候选配对数
+    ContactSolver contactSolver;
+    ContinuousCollision continuous;
+    BodyTree queries;
+
+    // 时间积分方法，多阶段的方法每步多次求作用力
+    Integrator integrator = Integrator::SemiImplicitEuler;
+    IntegratorScratch integratorScratch;
+
+    SleepSettings sleep;
+    IslandManager islands;
+
+    SimulationClock clock;
+    float aspect = 1.0f;
+    uint64_t stepIndex = 0;  // 已执行的固定步数
+
+    World();
+
+    Circle& addCircle(float x, float y, float radius, float mass, float charge, bool movable, int resolution = 100);
+    polygon& addPolygon(int sides, float radius, float x, float y, float mass, float charge, bool movable);
+    void removeObject(size_t index);
+    void clear();
+    // 按BodyStore中的形状标签重新生成全部物体句柄
+    void rebuildObjects();
+
+    // 线程池的线程数（含调用线程），1表示全部在调用线程上按顺序执行，便于调试
+    void setThreadCount(unsigned threads) { pool.resize(threads); }
+    unsigned getThreadCount() const { return pool.size(); }
+
+    // 类型不变时保留现有实例（排序扫掠的顺序跨帧沿用；配对在step中排序，不影响结果）
+    void setBroadphase(BroadphaseType type) {
+        if (broadphase && type == broadphaseType) return;
+        broadphaseType = type;
+        broadphase = CreateBroadphase(type);
+    }
+
+    // 射线、点与区域查询（鼠标拾取等）用的AABB树，先与当前位置增量同步
+    const BodyTree& queryTree() {
+        queries.update(bodies);
+        return queries;
+    }
+
+    // 执行一个固定步：两两作用力与积分（按积分方法交替若干次）、快速物体的连续碰撞、粗检测与接触求解（或逐对碰撞），
+    // 最后更新岛与休眠状态
+    void step(float dt);
+
+    // 均匀场与上次记录相比有变化时返回true并记下新值；step借此在改变gf/ef后唤醒全部物体，
+    // 读取快照后也调用一次，使续跑与原来的运行一致
+    bool syncFields();
+
+private:
+    float lastFields[4] = {};  // 上次记录的(gx, gy, ex, ey)
+};
+
+#endif
@@ -1,181 +1,128 @@
 #ifndef AXIOMS_H
 #define AXIOMS_H
 #include "../Dependencies/cPhysics/include/cphysics.h"
+#include "BodyStore.h"
 #include <cmath>
+#include <algorithm>
 
+// 物体只是BodyStore中某一行的句柄，供界面、绘制与窄相碰撞使用（不依赖OpenGL）
 class Object {
 
 public:
-    Object() {
-        double pos[3] = {0.0, 0.0, 0.0};
-        double vel[3] = {0.0, 0.0, 0.0};
-        double acc[3] = {0.0, 0.0, 0.0};
-        entity = new_entity("object", 1.0, 0.0, pos, vel, acc, 0.8, true, false);
-        enable_movement = true;
-    }
+    Object(BodyStore& store, float cx, float cy, float rad, bool mov, ShapeType type, uint32_t vertexCount)
+        : bodies(&store), index(store.add(cx, cy, rad, 1.0f, 0.0f, mov ? BODY_MOVABLE : 0u, type, vertexCount)) {}
+    // 绑定到已存在的一行（例如从快照恢复后重建句柄）
+    Object(BodyStore& store, size_t existing) : bodies(&store), index(existing) {}
     virtual ~Object() = default;
 
-    float get_mass() const { return static_cast<float>(entity.mass); }
+    float get_mass() const { return bodies->mass[index]; }
     const float* get_velocity() const {
         static float vel[2];
-        vel[0] = static_cast<float>(entity.velocity[0]);
-        vel[1] = static_cast<float>(entity.velocity[1]);
+        vel[0] = bodies->vx[index];
+        vel[1] = bodies->vy[index];
         return vel;
     }
     const float* get_acceleration() const {
         static float acc[2];
-        acc[0] = static_cast<float>(entity.acceleration[0]);
-        acc[1] = static_cast<float>(entity.acceleration[1]);
+        acc[0] = bodies->ax[index];
+        acc[1] = bodies->ay[index];
         return acc;
     }
 
 
-    float get_position_x() const { return static_cast<float>(entity.position[0]); }
-    float get_position_y() const { return static_cast<float>(entity.position[1]); }
+    float get_position_x() const { return bodies->x[index]; }
+    float get_position_y() const { return bodies->y[index]; }
 
-    void applyGravitationalField(const gravitational_field& field) {
-        // 使用cphysics.h中的引力场结构
-        float fx = static_cast<float>(field.magnitude * field.direction[0]);
-        float fy = static_cast<float>(field.magnitude * field.direction[1]);
-        
-        entity.acceleration[0] += fx / entity.mass;
-        entity.acceleration[1] += fy / entity.mass;
-    }
-    
+    // 外部修改物体状态时唤醒它，所在的岛在下一步随之唤醒
     void setMass(float m) {
-        entity.mass = m;
+        bodies->setMass(index, m);
+        bodies->wake(index);
     }
-    
+
     void setCharge(float c) {
-        entity.charge = c;
+        bodies->charge[index] = c;
+        bodies->wake(index);
     }
-    
-    float get_charge() const { return static_cast<float>(entity.charge); }
-    
+
+    float get_charge() const { return bodies->charge[index]; }
+
     void setPosition(float x, float y) {
-        entity.position[0] = x;
-        entity.position[1] = y;
+        bodies->x[index] = x;
+        bodies->y[index] = y;
+        bodies->wake(index);
     }
-    
+
+    // 直接移动物体（拖拽等）时同步上一步位置，避免渲染插值拖尾
+    void resetInterpolation() {
+        bodies->prevX[index] = bodies->x[index];
+        bodies->prevY[index] = bodies->y[index];
+    }
+
+    float get_render_x(float alpha) const { return bodies->renderX(index, alpha); }
+    float get_render_y(float alpha) const { return bodies->renderY(index, alpha); }
+
     void setVelocity(float vx, float vy) {
-        entity.velocity[0] = vx;
-        entity.velocity[1] = vy;
+        bodies->vx[index] = vx;
+        bodies->vy[index] = vy;
+        bodies->wake(index);
     }
-    
+
     void setAcceleration(float ax, float ay) {
-        entity.acceleration[0] = ax;
-        entity.acceleration[1] = ay;
-    }
-    
-    void applyForce(float fx, float fy) {
-        entity.acceleration[0] += fx / entity.mass;
-        entity.acceleration[1] += fy / entity.mass;
+        bodies->ax[index] = ax;
+        bodies->ay[index] = ay;
     }
 
-    void handleBoundaryCollision(float aspect = 1.0f, float restitution = 0.8f) {
-        float x_bound, y_bound;
-        if (aspect > 1.0f) {
-            x_bound = aspect;
-            y_bound = 1.0f;
-        } else {
-            x_bound = 1.0f;
-            y_bound = 1.0f / aspect;
-        }
-        
-        float left, right, top, bottom;
-        getBoundingBox(left, right, top, bottom);
-        
-        if (right > x_bound || left < -x_bound) {
-            entity.velocity[0] = -entity.velocity[0] * restitution;
-        }
-        if (top > y_bound || bottom < -y_bound) {
-            entity.velocity[1] = -entity.velocity[1] * restitution;
-        }
-        
-        constrainToBounds(x_bound, y_bound);
+    void applyForce(float fx, float fy) {
+        bodies->ax[index] += fx * bodies->invMass[index];
+        bodies->ay[index] += fy * bodies->invMass[index];
     }
 
-    void applyCoulombForce(const Object& other) {
-        if (entity.charge == 0.0 || other.entity.charge == 0.0) return;
-
-        float dx = static_cast<float>(other.entity.position[0] - entity.position[0]);
-        float dy = static_cast<float>(other.entity.position[1] - entity.position[1]);
-        float distance_sq = dx * dx + dy * dy;
-
-        const float MIN_DISTANCE_SQ = 0.01f;
-        if (distance_sq < MIN_DISTANCE_SQ) {
-            distance_sq = MIN_DISTANCE_SQ;
-        }
-        
-        float distance = sqrtf(distance_sq);
-        
-        float force_magnitude = static_cast<float>(K * entity.charge * other.entity.charge / distance_sq);
-        
-
-        const float MAX_FORCE = 1000.0f;
-        if (force_magnitude > MAX_FORCE) {
-            force_magnitude = MAX_FORCE;
-        } else if (force_magnitude < -MAX_FORCE) {
-            force_magnitude = -MAX_FORCE;
-        }
-
-        float nx = dx / distance;
-        float ny = dy / distance;
-
-        if (entity.charge * other.entity.charge > 0) {
-            force_magnitude = -force_magnitude;
-        }
-
-        float fx = force_magnitude * nx;
-        float fy = force_magnitude * ny;
-        
-        applyForce(fx, fy);
-    }
+    bool getMovementStatus() const { return bodies->isMovable(index); }
+    bool isSleeping() const { return bodies->isSleeping(index); }
 
-    void basicUpdate(float deltaTime, const gravitational_field& field, float aspect = 1.0f) {
-        if (!enable_movement) {
-            entity.acceleration[0] = 0.0;
-            entity.acceleration[1] = 0.0;
-            return;
-        }
-        
-        double savedAccX = entity.acceleration[0];
-        double savedAccY = entity.acceleration[1];
-        
-        applyGravitationalField(field);
-        
-        entity.acceleration[0] += savedAccX;
-        entity.acceleration[1] += savedAccY;
-        
-        entity.velocity[0] += entity.acceleration[0] * deltaTime;
-        entity.velocity[1] += entity.acceleration[1] * deltaTime;
-        
-        entity.position[0] += entity.velocity[0] * deltaTime;
-        entity.position[1] += entity.velocity[1] * deltaTime;
-        
-        entity.acceleration[0] = 0.0;
-        entity.acceleration[1] = 0.0;
-        
-        handleBoundaryCollision(aspect);
-    }
+    ShapeType getShapeType() const { return static_cast<ShapeType>(bodies->shape[index]); }
 
-    bool getMovementStatus() const { return enable_movement; }
-    
+    size_t getIndex() const { return index; }
+    void setIndex(size_t i) { index = i; }
 
-    Entity& getEntity() { return entity; }
-    const Entity& getEntity() const { return entity; }
+    // 圆与正多边形都以外接圆半径作为包围盒
+    void getBoundingBox(float& left, float& right, float& top, float& bottom) const {
+        const float r = bodies->radius[index];
+        left = get_position_x() - r;
+        right = get_position_x() + r;
+        top = get_position_y() + r;
+        bottom = get_position_y() - r;
+    }
 
-    virtual void update(float deltaTime, const gravitational_field& field, float aspect = 1.0f) = 0;
-    virtual void draw() = 0;
-    virtual bool checkCollision(const Object& other) const = 0;
-    virtual void resolveCollision(Object& other) = 0;
-    virtual void getBoundingBox(float& left, float& right, float& top, float& bottom) const = 0;
-    virtual void constrainToBounds(float x_bound, float y_bound) = 0;
 
-    
 protected:
-    Entity entity; // 使用cPhysics的Entity结构体存储属性
-    bool enable_movement;
+    BodyStore* bodies;
+    size_t index;
 };
 
-#endif
\ No newline at end of file
+// 与原来glOrtho相同的边界：短边为[-1, 1]
+inline void WallBounds(float aspect, float& xBound, float& yBound) {
+    if (aspect > 1.0f) {
+        xBound = aspect;
+        yBound = 1.0f;
+    } else {
+        xBound = 1.0f;
+        yBound = 1.0f / aspect;
+    }
+}
+
+// 越过边界时按恢复系数反转速度，并把位置限制在边界内
+inline void BounceOffWalls(float& x, float& y, float& vx, float& vy, float r, float xBound, float yBound,
+                           float restitution) {
+    if (x + r > xBound || x - r < -xBound) {
+        vx = -vx * restitution;
+    }
+    if (y + r > yBound || y - r < -yBound) {
+        vy = -vy * restitution;
+    }
+
+    x = std::max(-xBound + r, std::min(xBound - r, x));
+    y = std::max(-yBound + r, std::min(yBound - r, y));
+}
+
+#endif
@@ -0,0 +1,386 @@
+#include "../include/AabbTree.h"
+#include "../include/PolygonShape.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+int32_t DynamicAabbTree::allocateNode() {
+    if (freeList == NULL_NODE) {
+        nodes.push_back({});
+        freeList = static_cast<int32_t>(nodes.size() - 1);
+        nodes[freeList].parent = NULL_NODE;
+    }
+    const int32_t id = freeList;
+    freeList = nodes[id].parent;
+    nodes[id].parent = NULL_NODE;
+    nodes[id].child1 = NULL_NODE;
+    nodes[id].child2 = NULL_NODE;
+    nodes[id].height = 0;
+    return id;
+}
+
+void DynamicAabbTree::freeNode(int32_t id) {
+    nodes[id].parent = freeList;
+    nodes[id].height = -1;
+    freeList = id;
+}
+
+int32_t DynamicAabbTree::createProxy(const Aabb& fat, uint32_t body) {
+    const int32_t id = allocateNode();
+    nodes[id].box = fat;
+    nodes[id].body = body;
+    insertLeaf(id);
+    proxies++;
+    return id;
+}
+
+void DynamicAabbTree::destroyProxy(int32_t proxy) {
+    removeLeaf(proxy);
+    freeNode(proxy);
+    proxies--;
+}
+
+void DynamicAabbTree::moveProxy(int32_t proxy, const Aabb& fat) {
+    removeLeaf(proxy);
+    nodes[proxy].box = fat;
+    insertLeaf(proxy);
+}
+
+void DynamicAabbTree::clear() {
+    nodes.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+    proxies = 0;
+}
+
+void DynamicAabbTree::insertLeaf(int32_t leaf) {
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // 逐层比较：在当前节点处新建兄弟的代价，与继续下降到某个子节点的代价
+    const Aabb leafBox = nodes[leaf].box;
+    int32_t index = root;
+    while (!nodes[index].isLeaf()) {
+        const Node& node = nodes[index];
+        const float area = node.box.perimeter();
+        const float combinedArea = Aabb::merge(node.box, leafBox).perimeter();
+        const float cost = 2.0f * combinedArea;
+        // 下降时祖先的包围盒都要扩大
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](int32_t child) {
+            const Aabb merged = Aabb::merge(leafBox, nodes[child].box);
+            if (nodes[child].isLeaf()) return merged.perimeter() + inheritanceCost;
+            return merged.perimeter() - nodes[child].box.perimeter() + inheritanceCost;
+        };
+        const float cost1 = childCost(node.child1);
+        const float cost2 = childCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+    const int32_t sibling = index;
+
+    const int32_t oldParent = nodes[sibling].parent;
+    const int32_t newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = Aabb::merge(leafBox, nodes[sibling].box);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    if (oldParent == NULL_NODE) {
+        root = newParent;
+    } else if (nodes[oldParent].child1 == sibling) {
+        nodes[oldParent].child1 = newParent;
+    } else {
+        nodes[oldParent].child2 = newParent;
+    }
+
+    // 向上修正高度与包围盒，途中做旋转
+    index = nodes[leaf].parent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+        const int32_t child1 = nodes[index].child1;
+        const int32_t child2 = nodes[index].child2;
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[index].box = Aabb::merge(nodes[child1].box, nodes[child2].box);
+        index = nodes[index].parent;
+    }
+}
+
+void DynamicAabbTree::removeLeaf(int32_t leaf) {
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    const int32_t parent = nodes[leaf].parent;
+    const int32_t grandParent = nodes[parent].parent;
+    const int32_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    // 父节点被兄弟节点取代
+    freeNode(parent);
+    if (grandParent == NULL_NODE) {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        return;
+    }
+    if (nodes[grandParent].child1 == parent) {
+        nodes[grandParent].child1 = sibling;
+    } else {
+        nodes[grandParent].child2 = sibling;
+    }
+    nodes[sibling].parent = grandParent;
+
+    int32_t index = grandParent;
+    while (index != NULL_NODE) {
+        index = balance(index);
+        const int32_t child1 = nodes[index].child1;
+        const int32_t child2 = nodes[index].child2;
+        nodes[index].box = Aabb::merge(nodes[child1].box, nodes[child2].box);
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        index = nodes[index].parent;
+    }
+}
+
+// A的两个子节点B、C高度相差超过1时，把较高的子节点提升为A的位置，
+// 它较高的孩子留在下面，较矮的孩子交给A
+int32_t DynamicAabbTree::balance(int32_t iA) {
+    Node& A = nodes[iA];
+    if (A.isLeaf() || A.height < 2) return iA;
+
+    const int32_t iB = A.child1;
+    const int32_t iC = A.child2;
+    const int32_t heightDiff = nodes[iC].height - nodes[iB].height;
+
+    auto rotate = [&](int32_t iUp, int32_t iStay, bool upIsChild2) {
+        // iUp为被提升的子节点，iStay为A的另一个子节点
+        Node& up = nodes[iUp];
+        const int32_t iF = up.child1;
+        const int32_t iG = up.child2;
+
+        up.child1 = iA;
+        up.parent = A.parent;
+        A.parent = iUp;
+        if (up.parent == NULL_NODE) {
+            root = iUp;
+        } else if (nodes[up.parent].child1 == iA) {
+            nodes[up.parent].child1 = iUp;
+        } else {
+            nodes[up.parent].child2 = iUp;
+        }
+
+        const bool keepF = nodes[iF].height > nodes[iG].height;
+        const int32_t iHigh = keepF ? iF : iG;
+        const int32_t iLow = keepF ? iG : iF;
+        up.child2 = iHigh;
+        if (upIsChild2) {
+            A.child2 = iLow;
+        } else {
+            A.child1 = iLow;
+        }
+        nodes[iLow].parent = iA;
+        A.box = Aabb::merge(nodes[iStay].box, nodes[iLow].box);
+        up.box = Aabb::merge(A.box, nodes[iHigh].box);
+        A.height = 1 + std::max(nodes[iStay].height, nodes[iLow].height);
+        up.height = 1 + std::max(A.height, nodes[iHigh].height);
+        return iUp;
+    };
+
+    if (heightDiff > 1) return rotate(iC, iB, true);
+    if (heightDiff < -1) return rotate(iB, iC, false);
+    return iA;
+}
+
+bool DynamicAabbTree::RayHitsBox(const Aabb& box, float ox, float oy, float dx, float dy, float maxT) {
+    float t0 = 0.0f, t1 = maxT;
+    auto slab = [&](float origin, float delta, float lo, float hi) {
+        if (std::fabs(delta) < 1e-12f) return origin >= lo && origin <= hi;
+        float a = (lo - origin) / delta;
+        float b = (hi - origin) / delta;
+        if (a > b) std::swap(a, b);
+        t0 = std::max(t0, a);
+        t1 = std::min(t1, b);
+        return t0 <= t1;
+    };
+    return slab(ox, dx, box.minX, box.maxX) && slab(oy, dy, box.minY, box.maxY);
+}
+
+namespace {
+
+// 点到物体形状边界的有符号距离，内部为负
+float SignedDistance(const BodyStore& bodies, uint32_t i, float px, float py) {
+    const float dx = px - bodies.x[i];
+    const float dy = py - bodies.y[i];
+    if (bodies.shape[i] != SHAPE_POLYGON) {
+        return std::sqrt(dx * dx + dy * dy) - bodies.radius[i];
+    }
+
+    PolygonVertices vertices;
+    GetPolygonVertices(bodies, i, vertices);
+    const uint32_t count = vertices.size();
+    float maxSeparation = std::numeric_limits<float>::lowest();
+    for (uint32_t k = 0; k < count; k++) {
+        maxSeparation = std::max(maxSeparation, (px - vertices.x[k]) * vertices.shape->nx[k] +
+                                                (py - vertices.y[k]) * vertices.shape->ny[k]);
+    }
+    if (maxSeparation <= 0.0f) return maxSeparation;
+
+    float bestSq = std::numeric_limits<float>::max();
+    for (uint32_t k = 0; k < count; k++) {
+        const uint32_t next = k + 1 == count ? 0 : k + 1;
+        const float ex = vertices.x[next] - vertices.x[k];
+        const float ey = vertices.y[next] - vertices.y[k];
+        const float t = std::clamp(((px - vertices.x[k]) * ex + (py - vertices.y[k]) * ey) / (ex * ex + ey * ey),
+                                   0.0f, 1.0f);
+        const float cx = px - (vertices.x[k] + t * ex);
+        const float cy = py - (vertices.y[k] + t * ey);
+        bestSq = std::min(bestSq, cx * cx + cy * cy);
+    }
+    return std::sqrt(bestSq);
+}
+
+// 射线与物体形状的首个交点；起点在形状内部时不算命中
+bool RayShape(const BodyStore& bodies, uint32_t i, float ox, float oy, float dx, float dy, float maxT,
+              float& t, float& nx, float& ny) {
+    if (bodies.shape[i] != SHAPE_POLYGON) {
+        const float px = ox - bodies.x[i];
+        const float py = oy - bodies.y[i];
+        const float r = bodies.radius[i];
+        const float a = dx * dx + dy * dy;
+        const float b = px * dx + py * dy;
+        const float c = px * px + py * py - r * r;
+        const float discriminant = b * b - a * c;
+        if (c < 0.0f || b > 0.0f || discriminant < 0.0f || a == 0.0f) return false;
+        t = (-b - std::sqrt(discriminant)) / a;
+        if (t > maxT) return false;
+        // 小半径时命中点的舍入误差相对较大，法线单独归一化
+        nx = px + t * dx;
+        ny = py + t * dy;
+        const float length = std::sqrt(nx * nx + ny * ny);
+        nx = length > 0.0f ? nx / length : 0.0f;
+        ny = length > 0.0f ? ny / length : 1.0f;
+        return true;
+    }
+
+    // 凸多边形逐边裁剪（Cyrus-Beck），进入参数取最大的那条边
+    PolygonVertices vertices;
+    GetPolygonVertices(bodies, i, vertices);
+    float enter = 0.0f, exit = maxT;
+    int32_t enterEdge = -1;
+    for (uint32_t k = 0; k < vertices.size(); k++) {
+        const float enx = vertices.shape->nx[k];
+        const float eny = vertices.shape->ny[k];
+        const float numerator = (vertices.x[k] - ox) * enx + (vertices.y[k] - oy) * eny;
+        const float denominator = dx * enx + dy * eny;
+        if (denominator == 0.0f) {
+            if (numerator < 0.0f) return false;
+            continue;
+        }
+        const float edgeT = numerator / denominator;
+        if (denominator < 0.0f && edgeT > enter) {
+            enter = edgeT;
+            enterEdge = static_cast<int32_t>(k);
+        } else if (denominator > 0.0f && edgeT < exit) {
+            exit = edgeT;
+        }
+        if (exit < enter) return false;
+    }
+    if (enterEdge < 0) return false;
+    t = enter;
+    nx = vertices.shape->nx[enterEdge];
+    ny = vertices.shape->ny[enterEdge];
+    return true;
+}
+
+}
+
+Aabb BodyTree::fatBox(const BodyStore& bodies, size_t i) const {
+    const float r = bodies.radius[i];
+    const float margin = r * marginRatio;
+    Aabb box { bodies.x[i] - r - margin, bodies.y[i] - r - margin, bodies.x[i] + r + margin, bodies.y[i] + r + margin };
+    // 沿本步位移方向延伸，下一步大概率仍在盒内
+    const float dx = bodies.x[i] - bodies.prevX[i];
+    const float dy = bodies.y[i] - bodies.prevY[i];
+    (dx < 0.0f ? box.minX : box.maxX) += dx;
+    (dy < 0.0f ? box.minY : box.maxY) += dy;
+    return box;
+}
+
+void BodyTree::update(const BodyStore& bodies) {
+    const size_t n = bodies.size();
+    reinserted = 0;
+    while (leafOf.size() > n) {
+        aabbTree.destroyProxy(leafOf.back());
+        leafOf.pop_back();
+    }
+    while (leafOf.size() < n) {
+        const size_t i = leafOf.size();
+        leafOf.push_back(aabbTree.createProxy(fatBox(bodies, i), static_cast<uint32_t>(i)));
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        const float r = bodies.radius[i];
+        const Aabb tight { bodies.x[i] - r, bodies.y[i] - r, bodies.x[i] + r, bodies.y[i] + r };
+        if (aabbTree.fatAabb(leafOf[i]).contains(tight)) continue;
+        aabbTree.moveProxy(leafOf[i], fatBox(bodies, i));
+        reinserted++;
+    }
+}
+
+void BodyTree::clear() {
+    aabbTree.clear();
+    leafOf.clear();
+    reinserted = 0;
+}
+
+void BodyTree::queryPoint(const BodyStore& bodies, float x, float y, std::vector<uint32_t>& out) const {
+    out.clear();
+    aabbTree.query({ x, y, x, y }, [&](int32_t proxy) {
+        const uint32_t i = aabbTree.body(proxy);
+        if (SignedDistance(bodies, i, x, y) <= 0.0f) out.push_back(i);
+        return true;
+    });
+}
+
+void BodyTree::queryRegion(const Aabb& region, std::vector<uint32_t>& out) const {
+    out.clear();
+    aabbTree.query(region, [&](int32_t proxy) {
+        out.push_back(aabbTree.body(proxy));
+        return true;
+    });
+}
+
+bool BodyTree::rayCast(const BodyStore& bodies, float ox, float oy, float dx, float dy, float maxT,
+                       RayHit& hit) const {
+    bool found = false;
+    aabbTree.rayCast(ox, oy, dx, dy, maxT, [&](int32_t proxy, float limit) {
+        const uint32_t i = aabbTree.body(proxy);
+        float t, nx, ny;
+        if (!RayShape(bodies, i, ox, oy, dx, dy, limit, t, nx, ny)) return limit;
+        hit = { i, t, nx, ny };
+        found = true;
+        return t;
+    });
+    return found;
+}
+
+int BodyTree::pick(const BodyStore& bodies, float x, float y, float tolerance) const {
+    int best = -1;
+    float bestDistance = tolerance;
+    aabbTree.query({ x - tolerance, y - tolerance, x + tolerance, y + tolerance }, [&](int32_t proxy) {
+        const uint32_t i = aabbTree.body(proxy);
+        const float distance = SignedDistance(bodies, i, x, y);
+        if (distance <= bestDistance) {
+            bestDistance = distance;
+            best = static_cast<int>(i);
+        }
+        return true;
+    });
+    return best;
+}
@@ -0,0 +1,97 @@
+#include "../include/AllocationCounter.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+std::atomic<uint64_t> allocationCount { 0 };
+thread_local uint64_t threadAllocationCount = 0;
+}
+
+bool HeapAllocationCountingEnabled() {
+#ifdef PHYSICS2D_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t HeapAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t ThreadHeapAllocationCount() {
+    return threadAllocationCount;
+}
+
+#ifdef PHYSICS2D_COUNT_ALLOCATIONS
+
+// 替换全局的分配函数：计数后交给malloc / 对齐分配
+namespace {
+
+void* CountedAllocate(std::size_t size, std::size_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    threadAllocationCount++;
+    if (size == 0) size = 1;
+    void* p = nullptr;
+#ifdef _WIN32
+    p = alignment > alignof(std::max_align_t) ? _aligned_malloc(size, alignment) : std::malloc(size);
+#else
+    if (alignment > alignof(std::max_align_t)) {
+        if (posix_memalign(&p, alignment, size) != 0) p = nullptr;
+    } else {
+        p = std::malloc(size);
+    }
+#endif
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void CountedFree(void* p, std::size_t alignment) {
+#ifdef _WIN32
+    if (alignment > alignof(std::max_align_t)) {
+        _aligned_free(p);
+        return;
+    }
+#endif
+    (void)alignment;
+    std::free(p);
+}
+
+}
+
+void* operator new(std::size_t size) { return CountedAllocate(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size) { return CountedAllocate(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try { return CountedAllocate(size, alignof(std::max_align_t)); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try { return CountedAllocate(size, alignof(std::max_align_t)); } catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept { CountedFree(p, alignof(std::max_align_t)); }
+void operator delete[](void* p) noexcept { CountedFree(p, alignof(std::max_align_t)); }
+void operator delete(void* p, std::size_t) noexcept { CountedFree(p, alignof(std::max_align_t)); }
+void operator delete[](void* p, std::size_t) noexcept { CountedFree(p, alignof(std::max_align_t)); }
+void operator delete(void* p, std::align_val_t alignment) noexcept { CountedFree(p, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* p, std::align_val_t alignment) noexcept { CountedFree(p, static_cast<std::size_t>(alignment)); }
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept {
+    CountedFree(p, static_cast<std::size_t>(alignment));
+}
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept {
+    CountedFree(p, static_cast<std::size_t>(alignment));
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept { CountedFree(p, alignof(std::max_align_t)); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { CountedFree(p, alignof(std::max_align_t)); }
+
+#endif
@@ -0,0 +1,319 @@
+#include "../include/Collision.h"
+#include "../include/axioms.h"
+#include "../include/PolygonShape.h"
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+constexpr float RESTITUTION = 0.8f;
+
+// 不可移动物体按质量无穷大处理
+float EffectiveInvMass(const BodyStore& bodies, uint32_t i) {
+    return bodies.isMovable(i) ? bodies.invMass[i] : 0.0f;
+}
+
+// 沿法线(由a指向b)施加恢复系数冲量，两物体已分离时不处理
+void ApplyNormalImpulse(BodyStore& bodies, uint32_t a, uint32_t b, float nx, float ny) {
+    const float wa = EffectiveInvMass(bodies, a);
+    const float wb = EffectiveInvMass(bodies, b);
+    if (wa + wb == 0.0f) return;
+
+    const float dvx = bodies.vx[b] - bodies.vx[a];
+    const float dvy = bodies.vy[b] - bodies.vy[a];
+    const float velocityAlongNormal = dvx * nx + dvy * ny;
+    if (velocityAlongNormal > 0) return;
+
+    const float j = -(1 + RESTITUTION) * velocityAlongNormal / (wa + wb);
+    const float impulseX = j * nx;
+    const float impulseY = j * ny;
+
+    bodies.vx[a] -= impulseX * wa;
+    bodies.vy[a] -= impulseY * wa;
+    bodies.vx[b] += impulseX * wb;
+    bodies.vy[b] += impulseY * wb;
+}
+
+// 外接圆相交；对圆即精确结果，对多边形是生成顶点前的快速排除
+bool BoundingCirclesOverlap(const BodyStore& bodies, uint32_t a, uint32_t b) {
+    const float dx = bodies.x[a] - bodies.x[b];
+    const float dy = bodies.y[a] - bodies.y[b];
+    const float radiusSum = bodies.radius[a] + bodies.radius[b];
+    return dx * dx + dy * dy < radiusSum * radiusSum;
+}
+
+bool TestCircleCircle(const BodyStore& bodies, uint32_t a, uint32_t b) {
+    return BoundingCirclesOverlap(bodies, a, b);
+}
+
+// 圆心到任一条边的距离不超过半径即相交
+bool TestPolygonCircle(const BodyStore& bodies, uint32_t poly, uint32_t circle) {
+    if (!BoundingCirclesOverlap(bodies, poly, circle)) return false;
+
+    PolygonVertices vertices;
+    GetPolygonVertices(bodies, poly, vertices);
+
+    const float circleX = bodies.x[circle];
+    const float circleY = bodies.y[circle];
+    const float radius = bodies.radius[circle];
+
+    const uint32_t count = vertices.size();
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t j = i + 1 == count ? 0 : i + 1;
+        const float edgeX = vertices.x[j] - vertices.x[i];
+        const float edgeY = vertices.y[j] - vertices.y[i];
+
+        const float edgeLengthSquared = edgeX * edgeX + edgeY * edgeY;
+        if (edgeLengthSquared == 0) continue;
+
+        const float t = std::clamp(((circleX - vertices.x[i]) * edgeX + (circleY - vertices.y[i]) * edgeY) /
+                                   edgeLengthSquared, 0.0f, 1.0f);
+
+        const float dx = circleX - (vertices.x[i] + t * edgeX);
+        const float dy = circleY - (vertices.y[i] + t * edgeY);
+        if (dx * dx + dy * dy <= radius * radius) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TestCirclePolygon(const BodyStore& bodies, uint32_t circle, uint32_t poly) {
+    return TestPolygonCircle(bodies, poly, circle);
+}
+
+// 以owner的各条边法线为分离轴，任一轴上投影不重叠即分离；法线取自形状表
+bool HasSeparatingAxis(const PolygonVertices& owner, const PolygonVertices& other) {
+    for (uint32_t i = 0; i < owner.size(); i++) {
+        const float normalX = owner.shape->nx[i];
+        const float normalY = owner.shape->ny[i];
+
+        float min1 = std::numeric_limits<float>::max();
+        float max1 = std::numeric_limits<float>::lowest();
+        float min2 = std::numeric_limits<float>::max();
+        float max2 = std::numeric_limits<float>::lowest();
+
+        for (uint32_t k = 0; k < owner.size(); k++) {
+            const float projection = owner.x[k] * normalX + owner.y[k] * normalY;
+            min1 = std::min(min1, projection);
+            max1 = std::max(max1, projection);
+        }
+        for (uint32_t k = 0; k < other.size(); k++) {
+            const float projection = other.x[k] * normalX + other.y[k] * normalY;
+            min2 = std::min(min2, projection);
+            max2 = std::max(max2, projection);
+        }
+
+        if (max1 < min2 || max2 < min1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 两个多边形的边法线都要检查，结果才与顺序无关
+bool TestPolygonPolygon(const BodyStore& bodies, uint32_t a, uint32_t b) {
+    if (!BoundingCirclesOverlap(bodies, a, b)) return false;
+
+    PolygonVertices verticesA, verticesB;
+    GetPolygonVertices(bodies, a, verticesA);
+    GetPolygonVertices(bodies, b, verticesB);
+    return !HasSeparatingAxis(verticesA, verticesB) && !HasSeparatingAxis(verticesB, verticesA);
+}
+
+// 圆-圆：按逆质量比例把两者推开，再施加法向冲量
+void ResolveCircleCircle(BodyStore& bodies, uint32_t a, uint32_t b) {
+    const float dx = bodies.x[b] - bodies.x[a];
+    const float dy = bodies.y[b] - bodies.y[a];
+    const float distance = sqrtf(dx * dx + dy * dy);
+    if (distance == 0) return;
+
+    const float nx = dx / distance;
+    const float ny = dy / distance;
+
+    const float overlap = (bodies.radius[a] + bodies.radius[b]) - distance;
+    if (overlap > 0) {
+        const bool movableA = bodies.isMovable(a);
+        const bool movableB = bodies.isMovable(b);
+        const float shareA = movableA ? (movableB ? 0.5f : 1.0f) : 0.0f;
+        const float shareB = movableB ? (movableA ? 0.5f : 1.0f) : 0.0f;
+
+        bodies.x[a] -= overlap * shareA * nx;
+        bodies.y[a] -= overlap * shareA * ny;
+        bodies.x[b] += overlap * shareB * nx;
+        bodies.y[b] += overlap * shareB * ny;
+    }
+
+    ApplyNormalImpulse(bodies, a, b, nx, ny);
+}
+
+// 含多边形的配对：沿质心连线施加法向冲量
+void ResolveAlongCenters(BodyStore& bodies, uint32_t a, uint32_t b) {
+    const float dx = bodies.x[b] - bodies.x[a];
+    const float dy = bodies.y[b] - bodies.y[a];
+    const float distance = sqrtf(dx * dx + dy * dy);
+    if (distance == 0) return;
+
+    ApplyNormalImpulse(bodies, a, b, dx / distance, dy / distance);
+}
+
+bool ManifoldCircleCircle(const BodyStore& bodies, uint32_t a, uint32_t b, ContactPoint& contact) {
+    const float dx = bodies.x[b] - bodies.x[a];
+    const float dy = bodies.y[b] - bodies.y[a];
+    const float radiusSum = bodies.radius[a] + bodies.radius[b];
+    const float distanceSq = dx * dx + dy * dy;
+    if (distanceSq >= radiusSum * radiusSum) return false;
+
+    const float distance = sqrtf(distanceSq);
+    contact.feature = 0;
+    contact.nx = distance > 0.0f ? dx / distance : 0.0f;
+    contact.ny = distance > 0.0f ? dy / distance : 1.0f;
+    contact.depth = radiusSum - distance;
+    return true;
+}
+
+// 顶点按逆时针排列，边(i, i+1)的外法线与位置无关，直接查形状表
+void EdgeNormal(const PolygonVertices& vertices, uint32_t i, float& nx, float& ny) {
+    nx = vertices.shape->nx[i];
+    ny = vertices.shape->ny[i];
+}
+
+// 圆心在多边形外时取边界上最近点；在内部时取穿透最浅的边。法线由多边形指向圆
+bool ManifoldPolygonCircle(const BodyStore& bodies, uint32_t poly, uint32_t circle, ContactPoint& contact) {
+    if (!BoundingCirclesOverlap(bodies, poly, circle)) return false;
+
+    PolygonVertices vertices;
+    GetPolygonVertices(bodies, poly, vertices);
+
+    const float cx = bodies.x[circle];
+    const float cy = bodies.y[circle];
+    const float radius = bodies.radius[circle];
+
+    const uint32_t count = vertices.size();
+    float maxSeparation = std::numeric_limits<float>::lowest();
+    uint32_t bestEdge = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        float nx, ny;
+        EdgeNormal(vertices, i, nx, ny);
+        const float separation = (cx - vertices.x[i]) * nx + (cy - vertices.y[i]) * ny;
+        if (separation > radius) return false;
+        if (separation > maxSeparation) {
+            maxSeparation = separation;
+            bestEdge = i;
+        }
+    }
+
+    // 圆心恰在边上时最近点距离为0，同样按穿透最浅的边处理
+    const uint32_t faceEdge = bestEdge;
+    if (maxSeparation <= 0.0f) {
+        EdgeNormal(vertices, bestEdge, contact.nx, contact.ny);
+        contact.depth = radius - maxSeparation;
+        contact.feature = bestEdge;
+        return true;
+    }
+
+    // 圆心在外：最近点可能在边上，也可能在顶点上
+    float bestDistanceSq = std::numeric_limits<float>::max();
+    float closestX = 0.0f, closestY = 0.0f;
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t j = i + 1 == count ? 0 : i + 1;
+        const float edgeX = vertices.x[j] - vertices.x[i];
+        const float edgeY = vertices.y[j] - vertices.y[i];
+        const float edgeLengthSquared = edgeX * edgeX + edgeY * edgeY;
+        if (edgeLengthSquared == 0) continue;
+
+        const float t = std::clamp(((cx - vertices.x[i]) * edgeX + (cy - vertices.y[i]) * edgeY) /
+                                   edgeLengthSquared, 0.0f, 1.0f);
+        const float px = vertices.x[i] + t * edgeX;
+        const float py = vertices.y[i] + t * edgeY;
+        const float distanceSq = (cx - px) * (cx - px) + (cy - py) * (cy - py);
+        if (distanceSq < bestDistanceSq) {
+            bestDistanceSq = distanceSq;
+            closestX = px;
+            closestY = py;
+            bestEdge = i;
+        }
+    }
+    if (bestDistanceSq > radius * radius) return false;
+    if (bestDistanceSq == 0.0f) {
+        EdgeNormal(vertices, faceEdge, contact.nx, contact.ny);
+        contact.depth = radius - maxSeparation;
+        contact.feature = faceEdge;
+        return true;
+    }
+
+    const float distance = sqrtf(bestDistanceSq);
+    contact.nx = (cx - closestX) / distance;
+    contact.ny = (cy - closestY) / distance;
+    contact.depth = radius - distance;
+    contact.feature = bestEdge;
+    return true;
+}
+
+bool ManifoldCirclePolygon(const BodyStore& bodies, uint32_t circle, uint32_t poly, ContactPoint& contact) {
+    if (!ManifoldPolygonCircle(bodies, poly, circle, contact)) return false;
+    contact.nx = -contact.nx;
+    contact.ny = -contact.ny;
+    return true;
+}
+
+// owner各条边上other的最小分离距离中的最大值，即以owner的边为参考面的分离量
+float MaxFaceSeparation(const PolygonVertices& owner, const PolygonVertices& other, uint32_t& edge) {
+    float maxSeparation = std::numeric_limits<float>::lowest();
+    for (uint32_t i = 0; i < owner.size(); i++) {
+        float nx, ny;
+        EdgeNormal(owner, i, nx, ny);
+        float minSeparation = std::numeric_limits<float>::max();
+        for (uint32_t k = 0; k < other.size(); k++) {
+            minSeparation = std::min(minSeparation, (other.x[k] - owner.x[i]) * nx + (other.y[k] - owner.y[i]) * ny);
+        }
+        if (minSeparation > maxSeparation) {
+            maxSeparation = minSeparation;
+            edge = i;
+        }
+    }
+    return maxSeparation;
+}
+
+// 分离轴取两者边法线中穿透最浅的一条；B的边编号加0x100以区分
+bool ManifoldPolygonPolygon(const BodyStore& bodies, uint32_t a, uint32_t b, ContactPoint& contact) {
+    if (!BoundingCirclesOverlap(bodies, a, b)) return false;
+
+    PolygonVertices verticesA, verticesB;
+    GetPolygonVertices(bodies, a, verticesA);
+    GetPolygonVertices(bodies, b, verticesB);
+
+    uint32_t edgeA = 0, edgeB = 0;
+    const float separationA = MaxFaceSeparation(verticesA, verticesB, edgeA);
+    if (separationA > 0.0f) return false;
+    const float separationB = MaxFaceSeparation(verticesB, verticesA, edgeB);
+    if (separationB > 0.0f) return false;
+
+    if (separationA >= separationB) {
+        EdgeNormal(verticesA, edgeA, contact.nx, contact.ny);
+        contact.depth = -separationA;
+        contact.feature = edgeA;
+    } else {
+        EdgeNormal(verticesB, edgeB, contact.nx, contact.ny);
+        contact.nx = -contact.nx;
+        contact.ny = -contact.ny;
+        contact.depth = -separationB;
+        contact.feature = 0x100u + edgeB;
+    }
+    return true;
+}
+
+// 行为第一个物体的形状，列为第二个物体的形状
+const CollisionHandler DISPATCH_TABLE[SHAPE_TYPE_COUNT][SHAPE_TYPE_COUNT] = {
+    /* SHAPE_CIRCLE  */ { { TestCircleCircle, ResolveCircleCircle, ManifoldCircleCircle },
+                          { TestCirclePolygon, ResolveAlongCenters, ManifoldCirclePolygon } },
+    /* SHAPE_POLYGON */ { { TestPolygonCircle, ResolveAlongCenters, ManifoldPolygonCircle },
+                          { TestPolygonPolygon, ResolveAlongCenters, ManifoldPolygonPolygon } },
+};
+
+}
+
+const CollisionHandler& GetCollisionHandler(uint32_t shapeA, uint32_t shapeB) {
+    return DISPATCH_TABLE[shapeA][shapeB];
+}
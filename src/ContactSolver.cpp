@@ -0,0 +1,197 @@
+#include "../include/ContactSolver.h"
+#include "../include/axioms.h"
+#include <algorithm>
+#include <tuple>
+
+namespace {
+
+bool ContactKeyLess(uint32_t a0, uint32_t b0, uint32_t f0, uint32_t a1, uint32_t b1, uint32_t f1) {
+    return std::tie(a0, b0, f0) < std::tie(a1, b1, f1);
+}
+
+float InvMass(const BodyStore& bodies, uint32_t i) {
+    return i != WALL_BODY && bodies.isMovable(i) ? bodies.invMass[i] : 0.0f;
+}
+
+// 沿法线施加冲量，a受-impulse、b受+impulse；u为真实速度或伪速度
+void ApplyImpulse(float* ux, float* uy, const ContactPoint& p, float wa, float wb, float impulse) {
+    const float jx = impulse * p.nx;
+    const float jy = impulse * p.ny;
+    if (wa > 0.0f) {
+        ux[p.a] -= jx * wa;
+        uy[p.a] -= jy * wa;
+    }
+    if (wb > 0.0f) {
+        ux[p.b] += jx * wb;
+        uy[p.b] += jy * wb;
+    }
+}
+
+}
+
+void ContactSolver::findWallContacts(const BodyStore& bodies, float aspect) {
+    wallContacts.clear();
+
+    // 距边界不足slop即视为接触
+    float xBound, yBound;
+    WallBounds(aspect, xBound, yBound);
+    const float walls[4][3] = {
+        { -1.0f, 0.0f, xBound }, { 1.0f, 0.0f, xBound }, { 0.0f, -1.0f, yBound }, { 0.0f, 1.0f, yBound },
+    };
+    SolverContact contact {};
+    for (size_t i = 0; i < bodies.size(); i++) {
+        if (!bodies.isAwake(i)) continue;
+        for (uint32_t side = 0; side < 4; side++) {
+            const float nx = walls[side][0];
+            const float ny = walls[side][1];
+            const float separation = walls[side][2] - (bodies.x[i] * nx + bodies.y[i] * ny) - bodies.radius[i];
+            if (separation < settings.slop) {
+                contact.point = { static_cast<uint32_t>(i), WALL_BODY, side, nx, ny, -separation };
+                wallContacts.push_back(contact);
+            }
+        }
+    }
+}
+
+void ContactSolver::generateContacts(const BodyStore& bodies, const PairList& pairs, ThreadPool& pool,
+                                     PairList& islandPairs, ContactList& contacts, std::pmr::memory_resource* scratch) {
+    islandPairs.clear();
+
+    // 窄相只读物体数据，按配对分块并行，结果写入各自的槽位；之后按配对顺序收集，与线程数无关
+    std::pmr::vector<ContactPoint> pairPoints(pairs.size(), scratch);
+    std::pmr::vector<PairState> pairStates(pairs.size(), scratch);
+    pool.parallelRange(0, pairs.size(), NARROWPHASE_GRAIN, [&](size_t first, size_t last) {
+        for (size_t k = first; k < last; k++) {
+            const BroadphasePair& pair = pairs[k];
+            if (!bodies.isAwake(pair.a) && !bodies.isAwake(pair.b)) {
+                pairStates[k] = bodies.isSleeping(pair.a) && bodies.isSleeping(pair.b) ? PAIR_SLEEPING : PAIR_SEPARATED;
+                continue;
+            }
+            pairStates[k] = ComputeContact(bodies, pair.a, pair.b, pairPoints[k]) ? PAIR_TOUCHING : PAIR_SEPARATED;
+        }
+    });
+
+    SolverContact contact {};
+    contacts.reserve(lastContacts);
+    for (size_t k = 0; k < pairs.size(); k++) {
+        if (pairStates[k] == PAIR_SEPARATED) continue;
+        if (pairStates[k] == PAIR_TOUCHING) {
+            contact.point = pairPoints[k];
+            contacts.push_back(contact);
+        }
+        islandPairs.push_back(pairs[k]);
+    }
+    contacts.insert(contacts.end(), wallContacts.begin(), wallContacts.end());
+
+    // 按接触编号排序，与上一步的冲量线性合并
+    std::sort(contacts.begin(), contacts.end(), [](const SolverContact& l, const SolverContact& r) {
+        return ContactKeyLess(l.point.a, l.point.b, l.point.feature, r.point.a, r.point.b, r.point.feature);
+    });
+}
+
+void ContactSolver::applyWarmStart(ContactList& contacts) {
+    size_t cached = 0;
+    for (SolverContact& c : contacts) {
+        c.normalImpulse = 0.0f;
+        if (!settings.warmStarting) continue;
+        while (cached < impulses.size() &&
+               ContactKeyLess(impulses[cached].a, impulses[cached].b, impulses[cached].feature,
+                              c.point.a, c.point.b, c.point.feature)) {
+            cached++;
+        }
+        if (cached < impulses.size() && impulses[cached].a == c.point.a && impulses[cached].b == c.point.b &&
+            impulses[cached].feature == c.point.feature) {
+            c.normalImpulse = impulses[cached].normalImpulse;
+        }
+    }
+}
+
+void ContactSolver::solve(BodyStore& bodies, const PairList& pairs, float dt, float aspect, ThreadPool& pool,
+                          PairList& islandPairs, std::pmr::memory_resource* scratch) {
+    ContactList contacts(scratch);
+    generateContacts(bodies, pairs, pool, islandPairs, contacts, scratch);
+    applyWarmStart(contacts);
+    lastContacts = contacts.size();
+
+    float* vx = bodies.vx.data();
+    float* vy = bodies.vy.data();
+    auto velocityX = [&](uint32_t i) { return i == WALL_BODY ? 0.0f : vx[i]; };
+    auto velocityY = [&](uint32_t i) { return i == WALL_BODY ? 0.0f : vy[i]; };
+
+    const bool split = settings.correction == PositionCorrection::SplitImpulse;
+    const float invDt = dt > 0.0f ? 1.0f / dt : 0.0f;
+
+    // 预处理：有效质量、反弹与位置修正偏置；反弹按施加热启动冲量之前的速度计算
+    for (SolverContact& c : contacts) {
+        const ContactPoint& p = c.point;
+        const float wa = InvMass(bodies, p.a);
+        const float wb = InvMass(bodies, p.b);
+        c.normalMass = wa + wb > 0.0f ? 1.0f / (wa + wb) : 0.0f;
+
+        const float approach = (velocityX(p.b) - velocityX(p.a)) * p.nx + (velocityY(p.b) - velocityY(p.a)) * p.ny;
+        c.velocityBias = approach < -settings.restitutionThreshold ? -settings.restitution * approach : 0.0f;
+
+        const float correction = settings.baumgarte * invDt * std::max(p.depth - settings.slop, 0.0f);
+        c.positionBias = split ? correction : 0.0f;
+        if (!split) c.velocityBias = std::max(c.velocityBias, correction);
+        c.positionImpulse = 0.0f;
+    }
+    for (const SolverContact& c : contacts) {
+        ApplyImpulse(vx, vy, c.point, InvMass(bodies, c.point.a), InvMass(bodies, c.point.b), c.normalImpulse);
+    }
+
+    for (int iteration = 0; iteration < settings.iterations; iteration++) {
+        for (SolverContact& c : contacts) {
+            const ContactPoint& p = c.point;
+            const float vn = (velocityX(p.b) - velocityX(p.a)) * p.nx + (velocityY(p.b) - velocityY(p.a)) * p.ny;
+            const float previous = c.normalImpulse;
+            c.normalImpulse = std::max(previous - c.normalMass * (vn - c.velocityBias), 0.0f);
+            ApplyImpulse(vx, vy, p, InvMass(bodies, p.a), InvMass(bodies, p.b), c.normalImpulse - previous);
+        }
+    }
+
+    correctPositions(bodies, contacts, dt);
+
+    // 求解未收敛时仍保证不穿出边界
+    float xBound, yBound;
+    WallBounds(aspect, xBound, yBound);
+    for (size_t i = 0; i < bodies.size(); i++) {
+        if (!bodies.isMovable(i)) continue;
+        const float r = bodies.radius[i];
+        bodies.x[i] = std::max(-xBound + r, std::min(xBound - r, bodies.x[i]));
+        bodies.y[i] = std::max(-yBound + r, std::min(yBound - r, bodies.y[i]));
+    }
+
+    impulses.clear();
+    impulses.reserve(contacts.size());
+    for (const SolverContact& c : contacts) {
+        impulses.push_back({ c.point.a, c.point.b, c.point.feature, c.normalImpulse });
+    }
+}
+
+// 分离冲量：伪速度只用于本步的位置修正，随后丢弃，不影响真实速度
+void ContactSolver::correctPositions(BodyStore& bodies, ContactList& contacts, float dt) {
+    if (settings.correction != PositionCorrection::SplitImpulse) return;
+
+    pseudoVx.assign(bodies.size(), 0.0f);
+    pseudoVy.assign(bodies.size(), 0.0f);
+    float* px = pseudoVx.data();
+    float* py = pseudoVy.data();
+    auto pseudoX = [&](uint32_t i) { return i == WALL_BODY ? 0.0f : px[i]; };
+    auto pseudoY = [&](uint32_t i) { return i == WALL_BODY ? 0.0f : py[i]; };
+
+    for (int iteration = 0; iteration < settings.iterations; iteration++) {
+        for (SolverContact& c : contacts) {
+            if (c.positionBias == 0.0f && c.positionImpulse == 0.0f) continue;
+            const ContactPoint& p = c.point;
+            const float vn = (pseudoX(p.b) - pseudoX(p.a)) * p.nx + (pseudoY(p.b) - pseudoY(p.a)) * p.ny;
+            const float previous = c.positionImpulse;
+            c.positionImpulse = std::max(previous - c.normalMass * (vn - c.positionBias), 0.0f);
+            ApplyImpulse(px, py, p, InvMass(bodies, p.a), InvMass(bodies, p.b), c.positionImpulse - previous);
+        }
+    }
+    for (size_t i = 0; i < bodies.size(); i++) {
+        bodies.x[i] += px[i] * dt;
+        bodies.y[i] += py[i] * dt;
+    }
+}
@@ -0,0 +1,215 @@
+#include "../include/ContinuousCollision.h"
+#include "../include/axioms.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 圆心从p沿d运动（t∈[0,1]）时与半径和为reach的静止圆的最早接触时间；起点已重叠或正在远离时不算
+bool CircleTimeOfImpact(float px, float py, float dx, float dy, float reach, float& t) {
+    const float c = px * px + py * py - reach * reach;
+    if (c <= 0.0f) return false;
+    const float b = px * dx + py * dy;
+    if (b >= 0.0f) return false;
+    const float a = dx * dx + dy * dy;
+    const float discriminant = b * b - a * c;
+    if (discriminant < 0.0f) return false;
+    t = (-b - std::sqrt(discriminant)) / a;
+    return t <= 1.0f;
+}
+
+}
+
+void ContinuousCollision::buildGrid(const BodyStore& bodies, std::pmr::memory_resource* scratch) {
+    const size_t n = bodies.size();
+    float minX = bodies.x[0], maxX = bodies.x[0];
+    float minY = bodies.y[0], maxY = bodies.y[0];
+    maxRadius = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        minX = std::min(minX, bodies.x[i]);
+        maxX = std::max(maxX, bodies.x[i]);
+        minY = std::min(minY, bodies.y[i]);
+        maxY = std::max(maxY, bodies.y[i]);
+        maxRadius = std::max(maxRadius, bodies.radius[i]);
+    }
+
+    // 格子边长至少为最大直径，同时保证格子总数与物体数相当
+    const float width = std::max(maxX - minX, 1e-6f);
+    const float height = std::max(maxY - minY, 1e-6f);
+    cellSize = std::max({ 2.0f * maxRadius, std::sqrt(width * height / static_cast<float>(n)), 1e-6f });
+    originX = minX;
+    originY = minY;
+    columns = static_cast<int32_t>(width / cellSize) + 1;
+    rows = static_cast<int32_t>(height / cellSize) + 1;
+
+    const size_t cells = static_cast<size_t>(columns) * rows;
+    cellStart.assign(cells + 1, 0);
+    cellOf.resize(n);
+    cellBodies.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        const int32_t cx = std::min(static_cast<int32_t>((bodies.x[i] - originX) / cellSize), columns - 1);
+        const int32_t cy = std::min(static_cast<int32_t>((bodies.y[i] - originY) / cellSize), rows - 1);
+        cellOf[i] = static_cast<uint32_t>(cy * columns + cx);
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (size_t c = 0; c < cells; c++) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    std::pmr::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1, scratch);
+    for (size_t i = 0; i < n; i++) {
+        cellBodies[fill[cellOf[i]]++] = static_cast<uint32_t>(i);
+    }
+}
+
+bool ContinuousCollision::sweepBodies(const BodyStore& bodies, uint32_t i, float sx, float sy, float ex, float ey,
+                                      float& toi, uint32_t& hit) const {
+    const float reach = bodies.radius[i] + maxRadius;
+    auto cellIndex = [&](float value, float origin, int32_t count) {
+        return std::clamp(static_cast<int32_t>(std::floor((value - origin) / cellSize)), 0, count - 1);
+    };
+    const int32_t y0 = cellIndex(std::min(sy, ey) - reach, originY, rows);
+    const int32_t y1 = cellIndex(std::max(sy, ey) + reach, originY, rows);
+    const float dx = ex - sx;
+    const float dy = ey - sy;
+
+    // 逐行只访问线段加宽reach后覆盖的格子，而不是整个包围盒；按运动方向逐行推进，
+    // 某一行最早可能的时刻已晚于已找到的碰撞时即可停止
+    bool found = false;
+    const int32_t rowStep = dy < 0.0f ? -1 : 1;
+    const int32_t rowCount = y1 - y0 + 1;
+    for (int32_t row = 0; row < rowCount; row++) {
+        const int32_t cy = rowStep > 0 ? y0 + row : y1 - row;
+        float t0 = 0.0f, t1 = 1.0f;
+        if (std::fabs(dy) > 1e-12f) {
+            const float rowMin = originY + cy * cellSize - reach;
+            const float rowMax = originY + (cy + 1) * cellSize + reach;
+            t0 = (rowMin - sy) / dy;
+            t1 = (rowMax - sy) / dy;
+            if (t0 > t1) std::swap(t0, t1);
+            t0 = std::max(t0, 0.0f);
+            t1 = std::min(t1, 1.0f);
+            if (t0 > toi) break;
+            if (t0 > t1) continue;
+        }
+        const int32_t x0 = cellIndex(sx + std::min(dx * t0, dx * t1) - reach, originX, columns);
+        const int32_t x1 = cellIndex(sx + std::max(dx * t0, dx * t1) + reach, originX, columns);
+        for (int32_t cx = x0; cx <= x1; cx++) {
+            const uint32_t cell = static_cast<uint32_t>(cy * columns + cx);
+            for (uint32_t e = cellStart[cell]; e < cellStart[cell + 1]; e++) {
+                const uint32_t j = cellBodies[e];
+                if (j == i) continue;
+                float t;
+                if (CircleTimeOfImpact(sx - bodies.x[j], sy - bodies.y[j], dx, dy,
+                                       bodies.radius[i] + bodies.radius[j], t) && t < toi) {
+                    toi = t;
+                    hit = j;
+                    found = true;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+void ContinuousCollision::apply(BodyStore& bodies, float dt, float aspect, float restitution,
+                                std::pmr::memory_resource* scratch) {
+    fast.clear();
+    impacts = 0;
+    if (!settings.enabled || bodies.empty()) return;
+
+    for (size_t i = 0; i < bodies.size(); i++) {
+        if (!bodies.isAwake(i)) continue;
+        const float dx = bodies.x[i] - bodies.prevX[i];
+        const float dy = bodies.y[i] - bodies.prevY[i];
+        const float limit = settings.motionThreshold * bodies.radius[i];
+        if (dx * dx + dy * dy > limit * limit) fast.push_back(static_cast<uint32_t>(i));
+    }
+    if (fast.empty()) return;
+
+    buildGrid(bodies, scratch);
+
+    float xBound, yBound;
+    WallBounds(aspect, xBound, yBound);
+    constexpr uint32_t NO_HIT = UINT32_MAX;
+
+    for (const uint32_t i : fast) {
+        const float r = bodies.radius[i];
+        const float wi = bodies.invMass[i];
+        float sx = bodies.prevX[i], sy = bodies.prevY[i];
+        float ex = bodies.x[i], ey = bodies.y[i];
+        float remaining = dt;
+
+        for (int substep = 0; substep < settings.maxSubsteps; substep++) {
+            const float dx = ex - sx;
+            const float dy = ey - sy;
+            float toi = 1.0f;
+            uint32_t hit = NO_HIT;
+            float nx = 0.0f, ny = 0.0f;  // 由被撞物体指向i
+
+            // 边界：线段越过边界的时刻
+            auto wall = [&](float start, float delta, float limit, float sign, float wallNx, float wallNy) {
+                if (delta * sign <= 0.0f) return;
+                const float t = std::max((limit - start) / delta, 0.0f);
+                if ((start + delta) * sign > limit * sign && t < toi) {
+                    toi = t;
+                    hit = NO_HIT - 1;
+                    nx = wallNx;
+                    ny = wallNy;
+                }
+            };
+            wall(sx, dx, xBound - r, 1.0f, -1.0f, 0.0f);
+            wall(sx, dx, -xBound + r, -1.0f, 1.0f, 0.0f);
+            wall(sy, dy, yBound - r, 1.0f, 0.0f, -1.0f);
+            wall(sy, dy, -yBound + r, -1.0f, 0.0f, 1.0f);
+
+            uint32_t body = NO_HIT;
+            if (sweepBodies(bodies, i, sx, sy, ex, ey, toi, body)) hit = body;
+            if (hit == NO_HIT) break;
+
+            // 退回到碰撞位置
+            sx += dx * toi;
+            sy += dy * toi;
+            remaining *= 1.0f - toi;
+            impacts++;
+
+            float wj = 0.0f;
+            float vjx = 0.0f, vjy = 0.0f;
+            if (hit == body) {
+                const float cx = sx - bodies.x[hit];
+                const float cy = sy - bodies.y[hit];
+                const float length = std::sqrt(cx * cx + cy * cy);
+                nx = length > 0.0f ? cx / length : 0.0f;
+                ny = length > 0.0f ? cy / length : 1.0f;
+                if (bodies.isMovable(hit)) {
+                    wj = bodies.invMass[hit];
+                    bodies.wake(hit);
+                }
+                vjx = bodies.vx[hit];
+                vjy = bodies.vy[hit];
+            }
+
+            const float vn = (bodies.vx[i] - vjx) * nx + (bodies.vy[i] - vjy) * ny;
+            if (vn < 0.0f && wi + wj > 0.0f) {
+                const float impulse = -(1.0f + restitution) * vn / (wi + wj);
+                bodies.vx[i] += impulse * wi * nx;
+                bodies.vy[i] += impulse * wi * ny;
+                if (wj > 0.0f) {
+                    bodies.vx[hit] -= impulse * wj * nx;
+                    bodies.vy[hit] -= impulse * wj * ny;
+                }
+            }
+
+            // 子步用完时停在碰撞位置，剩余的位移舍去
+            if (substep + 1 == settings.maxSubsteps) {
+                ex = sx;
+                ey = sy;
+                break;
+            }
+            ex = sx + bodies.vx[i] * remaining;
+            ey = sy + bodies.vy[i] * remaining;
+        }
+
+        bodies.x[i] = ex;
+        bodies.y[i] = ey;
+    }
+}
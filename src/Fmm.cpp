@@ -0,0 +1,451 @@
+#include "../include/Fmm.h"
+#include "../include/SimdKernels.h"
+#include "../include/axioms.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr int MAX_TERMS = (FmmSolver::MAX_ORDER + 1) * (FmmSolver::MAX_ORDER + 2) / 2;
+
+// 多重指标(a, b)在三角形数组中的位置，同一阶n = a + b的项相邻
+inline int TermIndex(int a, int b) {
+    const int n = a + b;
+    return n * (n + 1) / 2 + b;
+}
+
+inline int TermCount(int p) {
+    return (p + 1) * (p + 2) / 2;
+}
+
+// out(a, b) = dx^a · dy^b / (a! b!)，a + b <= p
+void ScaledPowers(double dx, double dy, int p, double* out) {
+    out[0] = 1.0;
+    for (int n = 1; n <= p; n++) {
+        const int row = n * (n + 1) / 2;
+        const int previous = (n - 1) * n / 2;
+        for (int b = 0; b < n; b++) {
+            out[row + b] = out[previous + b] * dx / (n - b);
+        }
+        out[row + n] = out[previous + n - 1] * dy / n;
+    }
+}
+
+// out(a, b) = ∂x^a ∂y^b (1/|R|)，R = (x, y)，a + b <= p。McMurchie-Davidson递推：
+// R(n)(0,0) = (-1)^n (2n-1)!! / |R|^(2n+1)，R(n)(a,b) = (a-1)·R(n+1)(a-2,b) + x·R(n+1)(a-1,b)，y方向同理，所求为R(0)
+void InverseDistanceDerivatives(double x, double y, int p, double* out) {
+    double g[FmmSolver::MAX_ORDER + 1];
+    const double invRSq = 1.0 / (x * x + y * y);
+    g[0] = std::sqrt(invRSq);
+    for (int n = 0; n < p; n++) {
+        g[n + 1] = -(2 * n + 1) * g[n] * invRSq;
+    }
+
+    double layers[2][MAX_TERMS];
+    double* next = layers[0];
+    double* current = layers[1];
+    for (int n = p; n >= 0; n--) {
+        if (n == 0) current = out;
+        current[0] = g[n];
+        if (p - n >= 1) {
+            current[1] = x * next[0];
+            current[2] = y * next[0];
+        }
+        // 第s阶：a >= 1的项由x方向递推，(0, s)由y方向递推；上一层的第s-1、s-2阶分别从r1、r2开始
+        for (int s = 2; s <= p - n; s++) {
+            const int row = s * (s + 1) / 2;
+            const int r1 = (s - 1) * s / 2;
+            const int r2 = (s - 2) * (s - 1) / 2;
+            for (int b = 0; b < s - 1; b++) {
+                current[row + b] = x * next[r1 + b] + (s - b - 1) * next[r2 + b];
+            }
+            current[row + s - 1] = x * next[r1 + s - 1];
+            current[row + s] = y * next[r1 + s - 1] + (s - 1) * next[r2 + s - 2];
+        }
+        std::swap(current, next);
+    }
+}
+
+// 多极展开平移到新中心：M'(a, b) += Σ M(k, l) · T(a-k, b-l)，T为平移量的ScaledPowers
+void TranslateMultipole(const double* m, const double* t, int p, double* out) {
+    for (int n = 0; n <= p; n++) {
+        for (int b = 0; b <= n; b++) {
+            const int a = n - b;
+            double sum = 0.0;
+            for (int k = 0; k <= a; k++) {
+                for (int l = 0; l <= b; l++) {
+                    sum += m[TermIndex(k, l)] * t[TermIndex(a - k, b - l)];
+                }
+            }
+            out[TermIndex(a, b)] += sum;
+        }
+    }
+}
+
+// 局部展开平移到新中心：L'(k, l) += Σ L(k+u, l+v) · T(u, v)。
+// 固定T的阶s时，L的下标落在第n+s阶的连续一段
+void TranslateLocal(const double* local, const double* t, int p, double* out) {
+    for (int n = 0; n <= p; n++) {
+        const int row = n * (n + 1) / 2;
+        for (int l = 0; l <= n; l++) {
+            double sum = 0.0;
+            for (int s = 0; s <= p - n; s++) {
+                const double* source = local + (n + s) * (n + s + 1) / 2 + l;
+                const double* shift = t + s * (s + 1) / 2;
+                for (int v = 0; v <= s; v++) {
+                    sum += source[v] * shift[v];
+                }
+            }
+            out[row + l] += sum;
+        }
+    }
+}
+
+// 多极展开转为局部展开：L(k, l) += Σ M(a, b) · D(a+k, b+l)，a + b + k + l <= p。
+// 固定局部展开的阶n与多极展开的项(a, b)时，L的第n阶整段与D的第n+a+b阶中连续的一段相乘累加，
+// 最内层循环的各项互不依赖
+void MultipoleToLocal(const double* m, const double* d, int p, double* out) {
+    for (int n = 0; n <= p; n++) {
+        double* local = out + n * (n + 1) / 2;
+        for (int s = 0; s <= p - n; s++) {
+            const double* source = m + s * (s + 1) / 2;
+            const double* derivative = d + (n + s) * (n + s + 1) / 2;
+            for (int b = 0; b <= s; b++) {
+                const double weight = source[b];
+                for (int l = 0; l <= n; l++) {
+                    local[l] += weight * derivative[b + l];
+                }
+            }
+        }
+    }
+}
+
+// 局部展开在偏移t处的梯度，t为偏移量的ScaledPowers（阶数p - 1）
+void LocalGradient(const double* local, const double* t, int p, double& gx, double& gy) {
+    gx = 0.0;
+    gy = 0.0;
+    for (int n = 0; n < p; n++) {
+        for (int l = 0; l <= n; l++) {
+            const int k = n - l;
+            gx += local[TermIndex(k + 1, l)] * t[TermIndex(k, l)];
+            gy += local[TermIndex(k, l + 1)] * t[TermIndex(k, l)];
+        }
+    }
+}
+
+}
+
+void FmmSolver::BuildCsr(const std::vector<std::pair<uint32_t, uint32_t>>& pairs, size_t targets,
+                         std::vector<uint32_t>& start, std::vector<uint32_t>& source) {
+    // 计数排序，同一目标的来源保持遍历时的顺序
+    start.assign(targets + 1, 0);
+    for (const auto& [target, from] : pairs) {
+        start[target + 1]++;
+    }
+    for (size_t t = 0; t < targets; t++) {
+        start[t + 1] += start[t];
+    }
+    source.resize(pairs.size());
+    for (const auto& [target, from] : pairs) {
+        source[start[target]++] = from;
+    }
+    for (size_t t = targets; t > 0; t--) {
+        start[t] = start[t - 1];
+    }
+    start[0] = 0;
+}
+
+void FmmSolver::build(const BodyStore& bodies) {
+    const size_t n = bodies.size();
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < n; i++) {
+        minX = std::min(minX, bodies.x[i]);
+        minY = std::min(minY, bodies.y[i]);
+        maxX = std::max(maxX, bodies.x[i]);
+        maxY = std::max(maxY, bodies.y[i]);
+    }
+
+    order.resize(n);
+    scratch.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+
+    // 均匀树：所有叶子在同一层，层数使平均每个叶子约有leafCapacity个物体
+    const size_t capacity = static_cast<size_t>(std::max(1, settings.leafCapacity));
+    int uniformLevel = 0;
+    while (!settings.adaptive && uniformLevel < MAX_DEPTH && (capacity << (2 * uniformLevel)) < n) {
+        uniformLevel++;
+    }
+
+    nodes.clear();
+    leaves.clear();
+    levelStart.clear();
+    const double halfSize = 0.5 * std::max(maxX - minX, maxY - minY) + 1e-4;
+    nodes.push_back({ 0.5 * (static_cast<double>(minX) + maxX), 0.5 * (static_cast<double>(minY) + maxY), halfSize,
+                      0.0, 0, static_cast<uint32_t>(n), -1, 0, -1, 0 });
+
+    // 广度优先细分，同一层的格子在nodes中连续
+    for (size_t k = 0; k < nodes.size(); k++) {
+        const Node node = nodes[k];
+        if (static_cast<size_t>(node.level) >= levelStart.size()) {
+            levelStart.push_back(static_cast<uint32_t>(k));
+        }
+        const bool split = settings.adaptive ? node.count > capacity : node.level < uniformLevel;
+        if (!split || node.level >= MAX_DEPTH || node.count <= 1) {
+            leaves.push_back(static_cast<uint32_t>(k));
+            continue;
+        }
+
+        // 按象限稳定地重排物体区间：0左下，1右下，2左上，3右上
+        uint32_t quadrantCount[4] = {};
+        auto quadrant = [&](uint32_t body) {
+            return (bodies.x[body] >= node.cx ? 1 : 0) + (bodies.y[body] >= node.cy ? 2 : 0);
+        };
+        for (uint32_t s = node.begin; s < node.begin + node.count; s++) {
+            quadrantCount[quadrant(order[s])]++;
+        }
+        uint32_t offset[4];
+        offset[0] = node.begin;
+        for (int q = 1; q < 4; q++) {
+            offset[q] = offset[q - 1] + quadrantCount[q - 1];
+        }
+        const uint32_t childBegin[4] = { offset[0], offset[1], offset[2], offset[3] };
+        for (uint32_t s = node.begin; s < node.begin + node.count; s++) {
+            scratch[offset[quadrant(order[s])]++] = order[s];
+        }
+        std::copy(scratch.begin() + node.begin, scratch.begin() + node.begin + node.count, order.begin() + node.begin);
+
+        const double h = 0.5 * node.halfSize;
+        nodes[k].firstChild = static_cast<int32_t>(nodes.size());
+        for (int q = 0; q < 4; q++) {
+            if (quadrantCount[q] == 0) continue;
+            const double cx = node.cx + ((q & 1) ? h : -h);
+            const double cy = node.cy + ((q & 2) ? h : -h);
+            nodes.push_back({ cx, cy, h, 0.0, childBegin[q], quadrantCount[q], -1, 0, static_cast<int32_t>(k),
+                              node.level + 1 });
+            nodes[k].childCount++;
+        }
+    }
+    levelStart.push_back(static_cast<uint32_t>(nodes.size()));
+
+    for (std::vector<float>* array : { &px, &py, &pm, &pq, &pInvMass, &pax, &pay }) {
+        array->resize(n);
+    }
+    pFlags.resize(n);
+    for (size_t s = 0; s < n; s++) {
+        const uint32_t i = order[s];
+        px[s] = bodies.x[i];
+        py[s] = bodies.y[i];
+        pm[s] = bodies.mass[i];
+        pq[s] = bodies.charge[i];
+        pInvMass[s] = bodies.invMass[i];
+        pFlags[s] = bodies.flags[i];
+    }
+}
+
+void FmmSolver::upwardPass(ThreadPool& pool, bool gravity, bool coulomb) {
+    const int p = settings.order;
+    massMultipole.resize(nodes.size() * terms);
+    chargeMultipole.resize(nodes.size() * terms);
+
+    // 从最深一层往上，同一层的格子互不依赖
+    for (size_t level = levelStart.size() - 1; level-- > 0;) {
+        pool.parallelFor(levelStart[level], levelStart[level + 1], [&](size_t k) {
+            Node& node = nodes[k];
+            double* mass = massMultipole.data() + k * terms;
+            double* charge = chargeMultipole.data() + k * terms;
+            std::fill(mass, mass + terms, 0.0);
+            std::fill(charge, charge + terms, 0.0);
+            double t[MAX_TERMS];
+
+            if (node.firstChild < 0) {
+                // P2M：M(a, b) = Σ s·(c - r)^(a,b) / (a! b!)
+                double radiusSq = 0.0;
+                for (uint32_t s = node.begin; s < node.begin + node.count; s++) {
+                    const double dx = node.cx - px[s];
+                    const double dy = node.cy - py[s];
+                    radiusSq = std::max(radiusSq, dx * dx + dy * dy);
+                    ScaledPowers(dx, dy, p, t);
+                    for (int j = 0; j < terms; j++) {
+                        if (gravity) mass[j] += pm[s] * t[j];
+                        if (coulomb) charge[j] += pq[s] * t[j];
+                    }
+                }
+                node.radius = std::sqrt(radiusSq);
+                return;
+            }
+
+            // M2M：平移量为父中心 - 子中心
+            node.radius = 0.0;
+            for (int32_t c = node.firstChild; c < node.firstChild + node.childCount; c++) {
+                const Node& child = nodes[c];
+                const double dx = node.cx - child.cx;
+                const double dy = node.cy - child.cy;
+                node.radius = std::max(node.radius, std::sqrt(dx * dx + dy * dy) + child.radius);
+                ScaledPowers(dx, dy, p, t);
+                if (gravity) TranslateMultipole(massMultipole.data() + c * terms, t, p, mass);
+                if (coulomb) TranslateMultipole(chargeMultipole.data() + c * terms, t, p, charge);
+            }
+        });
+    }
+}
+
+void FmmSolver::buildInteractions(double minSeparation) {
+    farPairs.clear();
+    nearPairs.clear();
+    traversal.clear();
+    traversal.push_back({ 0, 0 });
+
+    const double theta = settings.theta;
+    while (!traversal.empty()) {
+        const auto [ia, ib] = traversal.back();
+        traversal.pop_back();
+        const Node& a = nodes[ia];
+
+        if (ia == ib) {
+            // 格子与自身：叶子直接求和，否则拆成子格子之间（含各自与自身）的配对
+            if (a.firstChild < 0) {
+                nearPairs.push_back({ ia, ia });
+                continue;
+            }
+            for (int32_t c1 = a.firstChild; c1 < a.firstChild + a.childCount; c1++) {
+                for (int32_t c2 = c1; c2 < a.firstChild + a.childCount; c2++) {
+                    traversal.push_back({ static_cast<uint32_t>(c1), static_cast<uint32_t>(c2) });
+                }
+            }
+            continue;
+        }
+
+        const Node& b = nodes[ib];
+        const double dx = a.cx - b.cx;
+        const double dy = a.cy - b.cy;
+        const double distance = std::sqrt(dx * dx + dy * dy);
+        const double reach = a.radius + b.radius;
+        if (reach <= theta * distance && distance - reach >= minSeparation) {
+            farPairs.push_back({ ia, ib });
+            farPairs.push_back({ ib, ia });
+        } else if (a.firstChild < 0 && b.firstChild < 0) {
+            nearPairs.push_back({ ia, ib });
+            nearPairs.push_back({ ib, ia });
+        } else if (b.firstChild < 0 || (a.firstChild >= 0 && a.radius >= b.radius)) {
+            for (int32_t c = a.firstChild; c < a.firstChild + a.childCount; c++) {
+                traversal.push_back({ static_cast<uint32_t>(c), ib });
+            }
+        } else {
+            for (int32_t c = b.firstChild; c < b.firstChild + b.childCount; c++) {
+                traversal.push_back({ ia, static_cast<uint32_t>(c) });
+            }
+        }
+    }
+
+    BuildCsr(farPairs, nodes.size(), farStart, farSource);
+    BuildCsr(nearPairs, nodes.size(), nearStart, nearSource);
+}
+
+void FmmSolver::downwardPass(ThreadPool& pool, bool gravity, bool coulomb) {
+    const int p = settings.order;
+    massLocal.resize(nodes.size() * terms);
+    chargeLocal.resize(nodes.size() * terms);
+
+    // 从根往下：先接收父格子平移下来的局部展开（L2L），再加上远处格子的多极展开（M2L）
+    for (size_t level = 0; level + 1 < levelStart.size(); level++) {
+        pool.parallelFor(levelStart[level], levelStart[level + 1], [&](size_t k) {
+            const Node& node = nodes[k];
+            double* mass = massLocal.data() + k * terms;
+            double* charge = chargeLocal.data() + k * terms;
+            std::fill(mass, mass + terms, 0.0);
+            std::fill(charge, charge + terms, 0.0);
+            double t[MAX_TERMS];
+
+            if (node.parent >= 0) {
+                const Node& parent = nodes[node.parent];
+                ScaledPowers(node.cx - parent.cx, node.cy - parent.cy, p, t);
+                if (gravity) TranslateLocal(massLocal.data() + node.parent * terms, t, p, mass);
+                if (coulomb) TranslateLocal(chargeLocal.data() + node.parent * terms, t, p, charge);
+            }
+            for (uint32_t f = farStart[k]; f < farStart[k + 1]; f++) {
+                const uint32_t s = farSource[f];
+                InverseDistanceDerivatives(node.cx - nodes[s].cx, node.cy - nodes[s].cy, p, t);
+                if (gravity) MultipoleToLocal(massMultipole.data() + s * terms, t, p, mass);
+                if (coulomb) MultipoleToLocal(chargeMultipole.data() + s * terms, t, p, charge);
+            }
+        });
+    }
+}
+
+void FmmSolver::evaluate(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params, SimdLevel level) {
+    const int p = settings.order;
+    const ForceArrays arrays { px.data(), py.data(), pm.data(), pq.data(), pInvMass.data(), pFlags.data(),
+                               pax.data(), pay.data() };
+
+    pool.parallelFor(0, leaves.size(), [&](size_t leafIndex) {
+        const uint32_t k = leaves[leafIndex];
+        const Node& node = nodes[k];
+        const uint32_t end = node.begin + node.count;
+
+        // P2P：叶子内的物体与近场各叶子的物体，用合并内核逐段累加
+        std::fill(pax.begin() + node.begin, pax.begin() + end, 0.0f);
+        std::fill(pay.begin() + node.begin, pay.begin() + end, 0.0f);
+        for (uint32_t e = nearStart[k]; e < nearStart[k + 1]; e++) {
+            const Node& source = nodes[nearSource[e]];
+            ApplyFusedForcesRange(arrays, node.begin, end, source.begin, source.begin + source.count, params, level);
+        }
+
+        // L2P：a = G·∇Ψm - K·q/m·∇Ψq，Ψ为1/r势
+        const double* mass = massLocal.data() + k * terms;
+        const double* charge = chargeLocal.data() + k * terms;
+        double t[MAX_TERMS];
+        for (uint32_t s = node.begin; s < end; s++) {
+            const uint32_t i = order[s];
+            if (!bodies.isAwake(i)) continue;
+
+            double farX = 0.0, farY = 0.0;
+            ScaledPowers(px[s] - node.cx, py[s] - node.cy, p - 1, t);
+            if (params.gravity) {
+                double gx, gy;
+                LocalGradient(mass, t, p, gx, gy);
+                farX += G * gx;
+                farY += G * gy;
+            }
+            if (params.coulomb && pq[s] != 0.0f) {
+                double gx, gy;
+                LocalGradient(charge, t, p, gx, gy);
+                const double scale = K * pq[s] * pInvMass[s];
+                farX -= scale * gx;
+                farY -= scale * gy;
+            }
+            bodies.ax[i] += static_cast<float>(farX) + pax[s];
+            bodies.ay[i] += static_cast<float>(farY) + pay[s];
+        }
+    });
+}
+
+void FmmSolver::apply(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params, SimdLevel level) {
+    if (bodies.size() < 2) return;
+
+    // 库仑力被限制的距离：1/r的上限，以及最大电荷量之间的力达到上限的距离
+    float maxCharge = 0.0f;
+    for (float q : bodies.charge) {
+        maxCharge = std::max(maxCharge, std::fabs(q));
+    }
+    FusedForceParams kernels = params;
+    kernels.coulomb = params.coulomb && maxCharge > 0.0f;
+    if (!kernels.gravity && !kernels.coulomb) return;
+    const double minSeparation = kernels.coulomb
+        ? std::max(1.0 / COULOMB_MAX_INV_DISTANCE, std::sqrt(K * maxCharge * maxCharge / COULOMB_MAX_FORCE))
+        : 0.0;
+
+    settings.order = std::clamp(settings.order, 1, MAX_ORDER);
+    terms = TermCount(settings.order);
+
+    build(bodies);
+    upwardPass(pool, kernels.gravity, kernels.coulomb);
+    buildInteractions(minSeparation);
+    downwardPass(pool, kernels.gravity, kernels.coulomb);
+    evaluate(bodies, pool, kernels, level);
+}
@@ -0,0 +1,202 @@
+#include "../include/Forces.h"
+#include <cmath>
+#include <algorithm>
+
+void ApplyUniversalGravitation(BodyStore& bodies) {
+    const size_t n = bodies.size();
+    const float* x = bodies.x.data();
+    const float* y = bodies.y.data();
+    const float* mass = bodies.mass.data();
+    const uint32_t* flags = bodies.flags.data();
+    float* ax = bodies.ax.data();
+    float* ay = bodies.ay.data();
+
+    for (size_t i = 0; i < n; i++) {
+        const bool movableI = (flags[i] & BODY_MOVABLE) != 0;
+        float axi = 0.0f;
+        float ayi = 0.0f;
+        for (size_t j = i + 1; j < n; j++) {
+            const float dx = x[j] - x[i];
+            const float dy = y[j] - y[i];
+
+            const float distance = sqrtf(dx * dx + dy * dy);
+            
+            if (distance < 0.001f) continue;
+            
+            // G / r^3，乘以对方质量即得加速度分量
+            const float scale = G / (distance * distance * distance);
+            
+            if (movableI) {
+                axi += scale * mass[j] * dx;
+                ayi += scale * mass[j] * dy;
+            }
+            if (flags[j] & BODY_MOVABLE) {
+                ax[j] -= scale * mass[i] * dx;
+                ay[j] -= scale * mass[i] * dy;
+            }
+        }
+        ax[i] += axi;
+        ay[i] += ayi;
+    }
+}
+
+void ApplyBarnesHutRange(BodyStore& bodies, const QuadTree& tree, float theta, size_t begin, size_t end) {
+    end = std::min(end, bodies.size());
+    for (size_t i = begin; i < end; i++) {
+        if (!bodies.isAwake(i)) continue;
+
+        float fx, fy;
+        tree.computeForce(static_cast<int>(i), bodies.x[i], bodies.y[i], bodies.mass[i], theta, fx, fy);
+        bodies.ax[i] += fx * bodies.invMass[i];
+        bodies.ay[i] += fy * bodies.invMass[i];
+    }
+}
+
+void ApplyCoulombForce(BodyStore& bodies) {
+    const size_t n = bodies.size();
+    const float* x = bodies.x.data();
+    const float* y = bodies.y.data();
+    const float* charge = bodies.charge.data();
+    const float* invMass = bodies.invMass.data();
+    const uint32_t* flags = bodies.flags.data();
+    float* ax = bodies.ax.data();
+    float* ay = bodies.ay.data();
+
+    const float MIN_DISTANCE_SQ = 0.01f;
+    const float MAX_FORCE = 1000.0f;
+
+    for (size_t i = 0; i < n; i++) {
+        if (charge[i] == 0.0f) continue;
+        for (size_t j = i + 1; j < n; j++) {
+            if (charge[j] == 0.0f) continue;
+
+            const float dx = x[j] - x[i];
+            const float dy = y[j] - y[i];
+            const float distance_sq = std::max(dx * dx + dy * dy, MIN_DISTANCE_SQ);
+            const float distance = sqrtf(distance_sq);
+
+            // 同号为正（互斥），异号为负（相吸）
+            float force_magnitude = static_cast<float>(K * charge[i] * charge[j] / distance_sq);
+            force_magnitude = std::clamp(force_magnitude, -MAX_FORCE, MAX_FORCE);
+
+            const float fx = force_magnitude * dx / distance;
+            const float fy = force_magnitude * dy / distance;
+
+            if (flags[i] & BODY_MOVABLE) {
+                ax[i] -= fx * invMass[i];
+                ay[i] -= fy * invMass[i];
+            }
+            if (flags[j] & BODY_MOVABLE) {
+                ax[j] += fx * invMass[j];
+                ay[j] += fy * invMass[j];
+            }
+        }
+    }
+}
+
+namespace {
+
+constexpr size_t PAIR_TILE = 128;
+// 累加缓冲区的组数，与线程数无关；块按编号轮流分给各组，组内按块编号顺序累加
+constexpr size_t PAIR_GROUPS = 16;
+
+// 计算一个块内所有配对的作用力，diagonal表示i、j来自同一块，只取j > i
+void AccumulateTile(const BodyStore& bodies, size_t i0, size_t i1, size_t j0, size_t j1, bool diagonal,
+                    bool gravity, bool coulomb, float* accX, float* accY) {
+    const float* x = bodies.x.data();
+    const float* y = bodies.y.data();
+    const float* mass = bodies.mass.data();
+    const float* invMass = bodies.invMass.data();
+    const float* charge = bodies.charge.data();
+
+    const float MIN_DISTANCE_SQ = 0.01f;
+    const float MAX_FORCE = 1000.0f;
+
+    for (size_t i = i0; i < i1; i++) {
+        const float xi = x[i];
+        const float yi = y[i];
+        float axi = 0.0f;
+        float ayi = 0.0f;
+
+        for (size_t j = diagonal ? i + 1 : j0; j < j1; j++) {
+            const float dx = x[j] - xi;
+            const float dy = y[j] - yi;
+            const float distanceSq = dx * dx + dy * dy;
+
+            if (gravity) {
+                const float distance = sqrtf(distanceSq);
+                if (distance >= 0.001f) {
+                    const float scale = G / (distance * distance * distance);
+                    axi += scale * mass[j] * dx;
+                    ayi += scale * mass[j] * dy;
+                    accX[j] -= scale * mass[i] * dx;
+                    accY[j] -= scale * mass[i] * dy;
+                }
+            }
+
+            if (coulomb && charge[i] != 0.0f && charge[j] != 0.0f) {
+                const float clampedSq = std::max(distanceSq, MIN_DISTANCE_SQ);
+                const float distance = sqrtf(clampedSq);
+                float forceMagnitude = static_cast<float>(K * charge[i] * charge[j] / clampedSq);
+                forceMagnitude = std::clamp(forceMagnitude, -MAX_FORCE, MAX_FORCE);
+
+                const float fx = forceMagnitude * dx / distance;
+                const float fy = forceMagnitude * dy / distance;
+                axi -= fx * invMass[i];
+                ayi -= fy * invMass[i];
+                accX[j] += fx * invMass[j];
+                accY[j] += fy * invMass[j];
+            }
+        }
+
+        accX[i] += axi;
+        accY[i] += ayi;
+    }
+}
+
+}
+
+void ApplyPairwiseForcesParallel(BodyStore& bodies, ThreadPool& pool, ParallelForceBuffers& buffers,
+                                 bool gravity, bool coulomb) {
+    const size_t n = bodies.size();
+    if (n < 2 || (!gravity && !coulomb)) return;
+
+    buffers.ax.resize(PAIR_GROUPS);
+    buffers.ay.resize(PAIR_GROUPS);
+    const size_t blocks = (n + PAIR_TILE - 1) / PAIR_TILE;
+
+    pool.parallelRange(0, PAIR_GROUPS, 1, [&](size_t first, size_t last) {
+        for (size_t g = first; g < last; g++) {
+            buffers.ax[g].assign(n, 0.0f);
+            buffers.ay[g].assign(n, 0.0f);
+            float* accX = buffers.ax[g].data();
+            float* accY = buffers.ay[g].data();
+
+            size_t tile = 0;
+            for (size_t bi = 0; bi < blocks; bi++) {
+                for (size_t bj = bi; bj < blocks; bj++, tile++) {
+                    if (tile % PAIR_GROUPS != g) continue;
+                    const size_t i0 = bi * PAIR_TILE;
+                    const size_t j0 = bj * PAIR_TILE;
+                    AccumulateTile(bodies, i0, std::min(n, i0 + PAIR_TILE), j0, std::min(n, j0 + PAIR_TILE),
+                                   bi == bj, gravity, coulomb, accX, accY);
+                }
+            }
+        }
+    });
+
+    // 按组编号顺序归约，只作用于可移动物体
+    pool.parallelRange(0, n, 0, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (!bodies.isMovable(i)) continue;
+            float sumX = 0.0f;
+            float sumY = 0.0f;
+            for (size_t k = 0; k < PAIR_GROUPS; k++) {
+                sumX += buffers.ax[k][i];
+                sumY += buffers.ay[k][i];
+            }
+            bodies.ax[i] += sumX;
+            bodies.ay[i] += sumY;
+        }
+    });
+}
@@ -0,0 +1,23 @@
+#include "../include/FrameArena.h"
+#include <algorithm>
+
+void FrameArena::allocate(size_t bytes) {
+    monotonic.reset();
+    buffer = std::make_unique<std::byte[]>(bytes);
+    capacityBytes = bytes;
+    monotonic.emplace(buffer.get(), capacityBytes, &overflow);
+}
+
+void FrameArena::reset() {
+    lastBytes = usedBytes;
+    usedBytes = 0;
+    if (overflow.bytes == 0) {
+        // 回到缓冲区开头，不访问堆
+        monotonic->release();
+        return;
+    }
+    // 本帧超出了缓冲区：按本帧的总量再留一半余量重新分配，只在用量增长时发生
+    const size_t needed = capacityBytes + overflow.bytes;
+    overflow.bytes = 0;
+    allocate(std::max(needed + needed / 2, capacityBytes * 2));
+}
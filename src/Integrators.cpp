@@ -0,0 +1,268 @@
+#include "../include/Integrators.h"
+#include "../include/axioms.h"
+#include "../include/SimdKernels.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+// 辛方法统一写成漂移-踢交替的系数表：起始漂移drift[0]·dt，第k次求力后踢kick[k]·dt、再漂移drift[k + 1]·dt
+struct SplittingScheme {
+    int stages;
+    float drift[4];
+    float kick[3];
+};
+
+// Yoshida (1990)：w1 = 1/(2 - 2^(1/3))，w0 = -2^(1/3)·w1
+constexpr double YOSHIDA_W1 = 1.3512071919596578;
+constexpr double YOSHIDA_W0 = -1.7024143839193153;
+
+constexpr SplittingScheme EULER_SCHEME { 1, { 0.0f, 1.0f }, { 1.0f } };
+constexpr SplittingScheme LEAPFROG_SCHEME { 1, { 0.5f, 0.5f }, { 1.0f } };
+constexpr SplittingScheme YOSHIDA_SCHEME {
+    3,
+    { static_cast<float>(YOSHIDA_W1 / 2), static_cast<float>((YOSHIDA_W0 + YOSHIDA_W1) / 2),
+      static_cast<float>((YOSHIDA_W0 + YOSHIDA_W1) / 2), static_cast<float>(YOSHIDA_W1 / 2) },
+    { static_cast<float>(YOSHIDA_W1), static_cast<float>(YOSHIDA_W0), static_cast<float>(YOSHIDA_W1) },
+};
+
+// RK4各阶段导数的权重，以及下一阶段状态相对步初的时间比例
+constexpr float RK4_WEIGHT[4] = { 1.0f, 2.0f, 2.0f, 1.0f };
+constexpr float RK4_NEXT[3] = { 0.5f, 0.5f, 1.0f };
+
+const SplittingScheme& SchemeFor(Integrator integrator) {
+    switch (integrator) {
+        case Integrator::Leapfrog: return LEAPFROG_SCHEME;
+        case Integrator::Yoshida4: return YOSHIDA_SCHEME;
+        default: return EULER_SCHEME;
+    }
+}
+
+bool Integrates(const uint32_t* flags, size_t i) {
+    return (flags[i] & (BODY_MOVABLE | BODY_SLEEPING)) == BODY_MOVABLE;
+}
+
+void Drift(BodyStore& store, float step, size_t begin, size_t end) {
+    float* x = store.x.data();
+    float* y = store.y.data();
+    const float* vx = store.vx.data();
+    const float* vy = store.vy.data();
+    const uint32_t* flags = store.flags.data();
+    for (size_t i = begin; i < end; i++) {
+        if (!Integrates(flags, i)) continue;
+        x[i] += vx[i] * step;
+        y[i] += vy[i] * step;
+    }
+}
+
+// 半隐式欧拉的系数为(踢1, 漂移1)：先用整步的加速度更新速度，再用新速度更新位置
+void KickDrift(BodyStore& store, const IntegrationParams& params, float kick, float drift, bool last,
+               size_t begin, size_t end) {
+    float xBound, yBound;
+    WallBounds(params.aspect, xBound, yBound);
+
+    float* x = store.x.data();
+    float* y = store.y.data();
+    float* vx = store.vx.data();
+    float* vy = store.vy.data();
+    float* ax = store.ax.data();
+    float* ay = store.ay.data();
+    const float* invMass = store.invMass.data();
+    const float* charge = store.charge.data();
+    const float* radius = store.radius.data();
+    const uint32_t* flags = store.flags.data();
+
+    for (size_t i = begin; i < end; i++) {
+        if (!Integrates(flags, i)) {
+            ax[i] = 0.0f;
+            ay[i] = 0.0f;
+            continue;
+        }
+
+        const float accX = ax[i] + params.gx + charge[i] * params.ex * invMass[i];
+        const float accY = ay[i] + params.gy + charge[i] * params.ey * invMass[i];
+
+        vx[i] += accX * kick;
+        vy[i] += accY * kick;
+
+        x[i] += vx[i] * drift;
+        y[i] += vy[i] * drift;
+
+        ax[i] = 0.0f;
+        ay[i] = 0.0f;
+
+        if (last && params.walls) {
+            BounceOffWalls(x[i], y[i], vx[i], vy[i], radius[i], xBound, yBound, params.restitution);
+        }
+    }
+}
+
+void Rk4Begin(BodyStore& store, IntegratorScratch& s, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        s.x0[i] = store.x[i];
+        s.y0[i] = store.y[i];
+        s.vx0[i] = store.vx[i];
+        s.vy0[i] = store.vy[i];
+        s.sumX[i] = 0.0f;
+        s.sumY[i] = 0.0f;
+        s.sumVx[i] = 0.0f;
+        s.sumVy[i] = 0.0f;
+    }
+}
+
+// 当前状态的导数为(v, a)：累加到加权和，再由步初状态走到下一阶段；最后一个阶段用加权和完成整步
+void Rk4Stage(BodyStore& store, IntegratorScratch& s, const IntegrationParams& params, int stage,
+              size_t begin, size_t end) {
+    float xBound, yBound;
+    WallBounds(params.aspect, xBound, yBound);
+
+    float* x = store.x.data();
+    float* y = store.y.data();
+    float* vx = store.vx.data();
+    float* vy = store.vy.data();
+    float* ax = store.ax.data();
+    float* ay = store.ay.data();
+    const float* invMass = store.invMass.data();
+    const float* charge = store.charge.data();
+    const float* radius = store.radius.data();
+    const uint32_t* flags = store.flags.data();
+    const float weight = RK4_WEIGHT[stage];
+    const bool last = stage == 3;
+
+    for (size_t i = begin; i < end; i++) {
+        if (!Integrates(flags, i)) {
+            ax[i] = 0.0f;
+            ay[i] = 0.0f;
+            continue;
+        }
+
+        const float accX = ax[i] + params.gx + charge[i] * params.ex * invMass[i];
+        const float accY = ay[i] + params.gy + charge[i] * params.ey * invMass[i];
+        s.sumX[i] += weight * vx[i];
+        s.sumY[i] += weight * vy[i];
+        s.sumVx[i] += weight * accX;
+        s.sumVy[i] += weight * accY;
+
+        if (!last) {
+            const float h = RK4_NEXT[stage] * params.dt;
+            x[i] = s.x0[i] + h * vx[i];
+            y[i] = s.y0[i] + h * vy[i];
+            vx[i] = s.vx0[i] + h * accX;
+            vy[i] = s.vy0[i] + h * accY;
+        } else {
+            const float h = params.dt / 6.0f;
+            x[i] = s.x0[i] + h * s.sumX[i];
+            y[i] = s.y0[i] + h * s.sumY[i];
+            vx[i] = s.vx0[i] + h * s.sumVx[i];
+            vy[i] = s.vy0[i] + h * s.sumVy[i];
+        }
+
+        ax[i] = 0.0f;
+        ay[i] = 0.0f;
+
+        if (last && params.walls) {
+            BounceOffWalls(x[i], y[i], vx[i], vy[i], radius[i], xBound, yBound, params.restitution);
+        }
+    }
+}
+
+}
+
+const char* IntegratorName(Integrator integrator) {
+    switch (integrator) {
+        case Integrator::Leapfrog: return "leapfrog";
+        case Integrator::Yoshida4: return "yoshida4";
+        case Integrator::Rk4: return "rk4";
+        default: return "euler";
+    }
+}
+
+int IntegratorStages(Integrator integrator) {
+    return integrator == Integrator::Rk4 ? 4 : SchemeFor(integrator).stages;
+}
+
+bool IntegratorHasBegin(Integrator integrator) {
+    return integrator == Integrator::Rk4 || SchemeFor(integrator).drift[0] != 0.0f;
+}
+
+IntegrationParams MakeIntegrationParams(float dt, const gravitational_field& gfield, const electric_field& efield,
+                                        float aspect, float restitution, bool walls) {
+    IntegrationParams params;
+    params.dt = dt;
+    params.gx = static_cast<float>(gfield.magnitude * gfield.direction[0]);
+    params.gy = static_cast<float>(gfield.magnitude * gfield.direction[1]);
+    params.ex = static_cast<float>(efield.magnitude * efield.direction[0]);
+    params.ey = static_cast<float>(efield.magnitude * efield.direction[1]);
+    params.aspect = aspect;
+    params.restitution = restitution;
+    params.walls = walls;
+    return params;
+}
+
+void IntegratorScratch::prepare(Integrator integrator, size_t count) {
+    if (integrator != Integrator::Rk4) return;
+    for (AlignedVector<float>* array : { &x0, &y0, &vx0, &vy0, &sumX, &sumY, &sumVx, &sumVy }) {
+        array->resize(count);
+    }
+}
+
+void BeginIntegrationRange(Integrator integrator, BodyStore& store, IntegratorScratch& scratch,
+                           const IntegrationParams& params, size_t begin, size_t end) {
+    end = std::min(end, store.size());
+    if (integrator == Integrator::Rk4) {
+        Rk4Begin(store, scratch, begin, end);
+        return;
+    }
+    const float drift = SchemeFor(integrator).drift[0];
+    if (drift != 0.0f) Drift(store, drift * params.dt, begin, end);
+}
+
+void IntegrationStageRange(Integrator integrator, int stage, BodyStore& store, IntegratorScratch& scratch,
+                           const IntegrationParams& params, size_t begin, size_t end) {
+    end = std::min(end, store.size());
+    if (integrator == Integrator::Rk4) {
+        Rk4Stage(store, scratch, params, stage, begin, end);
+        return;
+    }
+    const SplittingScheme& scheme = SchemeFor(integrator);
+    KickDrift(store, params, scheme.kick[stage] * params.dt, scheme.drift[stage + 1] * params.dt,
+              stage + 1 == scheme.stages, begin, end);
+}
+
+EnergyReport MeasureEnergy(const BodyStore& bodies, const gravitational_field& gfield,
+                           const electric_field& efield, float softening) {
+    const double gx = gfield.magnitude * gfield.direction[0];
+    const double gy = gfield.magnitude * gfield.direction[1];
+    const double ex = efield.magnitude * efield.direction[0];
+    const double ey = efield.magnitude * efield.direction[1];
+    const double softeningSq = static_cast<double>(softening) * softening;
+    // 内核把库仑距离限制在不小于它，更近时力不再增大，势能按恒力线性延长
+    const double minDistance = 1.0 / COULOMB_MAX_INV_DISTANCE;
+
+    EnergyReport report;
+    const size_t n = bodies.size();
+    for (size_t i = 0; i < n; i++) {
+        const double m = bodies.mass[i];
+        const double q = bodies.charge[i];
+        if (bodies.isMovable(i)) {
+            const double vx = bodies.vx[i];
+            const double vy = bodies.vy[i];
+            report.kinetic += 0.5 * m * (vx * vx + vy * vy);
+        }
+        report.potential -= m * (gx * bodies.x[i] + gy * bodies.y[i]) + q * (ex * bodies.x[i] + ey * bodies.y[i]);
+
+        for (size_t j = i + 1; j < n; j++) {
+            const double dx = static_cast<double>(bodies.x[j]) - bodies.x[i];
+            const double dy = static_cast<double>(bodies.y[j]) - bodies.y[i];
+            const double r2 = dx * dx + dy * dy;
+            report.potential -= G * m * bodies.mass[j] / std::sqrt(r2 + softeningSq);
+
+            const double qq = K * q * bodies.charge[j];
+            if (qq == 0.0) continue;
+            const double r = std::sqrt(r2);
+            report.potential += r >= minDistance ? qq / r
+                                                 : qq / minDistance + qq / (minDistance * minDistance) * (minDistance - r);
+        }
+    }
+    return report;
+}
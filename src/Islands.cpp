@@ -0,0 +1,63 @@
+#include "../include/Islands.h"
+#include <algorithm>
+
+void IslandManager::update(BodyStore& bodies, const PairList& contacts,
+                           const SleepSettings& settings, float dt) {
+    const size_t n = bodies.size();
+    islands = 0;
+    sleeping = 0;
+
+    if (!settings.enabled) {
+        for (size_t i = 0; i < n; i++) {
+            if (bodies.isSleeping(i)) bodies.wake(i);
+        }
+        return;
+    }
+
+    // 用本步的位移而不是速度判断：停在边界上的物体每步都被场加速再反弹，
+    // 速度始终约为g·dt，但位置被边界夹住几乎不动
+    const float maxStep = settings.velocityThreshold * dt;
+    const float maxStepSq = maxStep * maxStep;
+    for (size_t i = 0; i < n; i++) {
+        if (!bodies.isAwake(i)) continue;
+        const float dx = bodies.x[i] - bodies.prevX[i];
+        const float dy = bodies.y[i] - bodies.prevY[i];
+        bodies.sleepTime[i] = dx * dx + dy * dy < maxStepSq ? bodies.sleepTime[i] + dt : 0.0f;
+    }
+
+    parent.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        parent[i] = static_cast<uint32_t>(i);
+    }
+    for (const BroadphasePair& pair : contacts) {
+        if (!bodies.isMovable(pair.a) || !bodies.isMovable(pair.b)) continue;
+        const uint32_t rootA = find(pair.a);
+        const uint32_t rootB = find(pair.b);
+        if (rootA != rootB) parent[std::max(rootA, rootB)] = std::min(rootA, rootB);
+    }
+
+    islandSleepTime.assign(n, settings.timeToSleep);
+    for (size_t i = 0; i < n; i++) {
+        if (!bodies.isMovable(i)) continue;
+        const uint32_t root = find(static_cast<uint32_t>(i));
+        if (root == i) islands++;
+        // 已休眠的物体不再计时，视为满足条件
+        if (!bodies.isSleeping(i)) {
+            islandSleepTime[root] = std::min(islandSleepTime[root], bodies.sleepTime[i]);
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        if (!bodies.isMovable(i)) continue;
+        if (islandSleepTime[find(static_cast<uint32_t>(i))] >= settings.timeToSleep) {
+            if (!bodies.isSleeping(i)) {
+                bodies.flags[i] |= BODY_SLEEPING;
+                bodies.vx[i] = 0.0f;
+                bodies.vy[i] = 0.0f;
+            }
+            sleeping++;
+        } else if (bodies.isSleeping(i)) {
+            bodies.wake(i);
+        }
+    }
+}
@@ -0,0 +1,378 @@
+#include "../include/Journal.h"
+#include "../include/Snapshot.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+void ExecuteCommand(World& world, const WorldCommand& command) {
+    const double* v = command.values;
+    const size_t body = command.body;
+    const bool validBody = body < world.bodies.size();
+
+    switch (command.type) {
+        case CommandType::AddCircle:
+            world.addCircle(static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2]),
+                            static_cast<float>(v[3]), static_cast<float>(v[4]), v[5] != 0.0,
+                            static_cast<int>(command.body));
+            break;
+        case CommandType::AddPolygon:
+            if (command.body >= 3 && command.body <= MAX_POLYGON_SIDES) {
+                world.addPolygon(static_cast<int>(command.body), static_cast<float>(v[2]), static_cast<float>(v[0]),
+                                 static_cast<float>(v[1]), static_cast<float>(v[3]), static_cast<float>(v[4]),
+                                 v[5] != 0.0);
+            }
+            break;
+        case CommandType::RemoveObject:
+            if (validBody) world.removeObject(body);
+            break;
+        case CommandType::ClearWorld:
+            // 不用World::clear：步数保持不变，日志中后续命令的步号才对得上；
+            // 接触缓存按物体下标匹配，新物体会复用这些下标，必须一起清掉
+            world.objects.clear();
+            world.bodies.clear();
+            world.contactSolver.reset();
+            break;
+        case CommandType::SetPosition:
+            if (validBody) {
+                world.objects[body]->setPosition(static_cast<float>(v[0]), static_cast<float>(v[1]));
+                world.objects[body]->resetInterpolation();
+            }
+            break;
+        case CommandType::SetVelocity:
+            if (validBody) world.objects[body]->setVelocity(static_cast<float>(v[0]), static_cast<float>(v[1]));
+            break;
+        case CommandType::SetMass:
+            if (validBody && v[0] > 0.0) world.objects[body]->setMass(static_cast<float>(v[0]));
+            break;
+        case CommandType::SetCharge:
+            if (validBody) world.objects[body]->setCharge(static_cast<float>(v[0]));
+            break;
+        case CommandType::SetGravityField:
+            world.gf.magnitude = v[0];
+            world.gf.direction[0] = v[1];
+            world.gf.direction[1] = v[2];
+            world.gf.direction[2] = 0.0;
+            break;
+        case CommandType::SetElectricField:
+            world.ef.magnitude = v[0];
+            world.ef.direction[0] = v[1];
+            world.ef.direction[1] = v[2];
+            world.ef.direction[2] = 0.0;
+            break;
+        case CommandType::SetBounds:
+            if (v[0] > 0.0) world.aspect = static_cast<float>(v[0]);
+            break;
+        case CommandType::SetTimeScale:
+            break;
+        case CommandType::SetFixedStep:
+            world.clock.setFixedDeltaTime(static_cast<float>(v[0]));
+            break;
+        case CommandType::SetMaxSubsteps:
+            world.clock.setMaxSubsteps(static_cast<int>(command.body));
+            break;
+        case CommandType::SetGravitySolver:
+            world.gravitySolver = command.body <= static_cast<uint32_t>(GravitySolver::ParticleMesh)
+                ? static_cast<GravitySolver>(command.body) : GravitySolver::Exact;
+            break;
+        case CommandType::SetBarnesHutTheta:
+            world.barnesHutTheta = static_cast<float>(v[0]);
+            break;
+        case CommandType::SetForceKernel:
+            world.forceKernel = command.body == static_cast<uint32_t>(ForceKernel::Scalar)
+                ? ForceKernel::Scalar : ForceKernel::Simd;
+            break;
+        case CommandType::SetThreadCount:
+            world.setThreadCount(command.body);
+            break;
+        case CommandType::SetSleeping:
+            world.sleep.enabled = command.body != 0;
+            world.sleep.velocityThreshold = static_cast<float>(v[0]);
+            world.sleep.timeToSleep = static_cast<float>(v[1]);
+            break;
+        case CommandType::SetContactSolver: {
+            ContactSolverSettings& solver = world.contactSolver.settings;
+            solver.enabled = command.body != 0;
+            solver.iterations = std::max(1, static_cast<int>(v[0]));
+            solver.correction = v[1] == static_cast<double>(PositionCorrection::Baumgarte)
+                ? PositionCorrection::Baumgarte : PositionCorrection::SplitImpulse;
+            solver.restitution = static_cast<float>(v[2]);
+            solver.baumgarte = static_cast<float>(v[3]);
+            solver.slop = static_cast<float>(v[4]);
+            solver.warmStarting = v[5] != 0.0;
+            break;
+        }
+        case CommandType::SetContinuousCollision:
+            world.continuous.settings.enabled = command.body != 0;
+            world.continuous.settings.motionThreshold = static_cast<float>(v[0]);
+            world.continuous.settings.maxSubsteps = std::max(1, static_cast<int>(v[1]));
+            break;
+        case CommandType::SetBroadphase:
+            if (command.body <= static_cast<uint32_t>(BroadphaseType::AabbTree)) {
+                world.setBroadphase(static_cast<BroadphaseType>(command.body));
+            }
+            break;
+        case CommandType::SetFmm:
+            world.fmm.settings.order = std::clamp(static_cast<int>(command.body), 1, FmmSolver::MAX_ORDER);
+            world.fmm.settings.theta = static_cast<float>(v[0]);
+            world.fmm.settings.leafCapacity = std::max(1, static_cast<int>(v[1]));
+            world.fmm.settings.adaptive = v[2] != 0.0;
+            break;
+        case CommandType::SetParticleMesh:
+            world.particleMesh.settings.gridSize = std::clamp(static_cast<int>(command.body),
+                                                              ParticleMeshSolver::MIN_GRID, ParticleMeshSolver::MAX_GRID);
+            world.particleMesh.settings.p3m = v[0] != 0.0;
+            world.particleMesh.settings.splitCells = static_cast<float>(v[1]);
+            // 旧日志没有这一项（为0），即TSC
+            world.particleMesh.settings.assignment = v[2] == static_cast<double>(MeshAssignment::Cic)
+                ? MeshAssignment::Cic : MeshAssignment::Tsc;
+            break;
+        case CommandType::SetIntegrator:
+            world.integrator = command.body < static_cast<uint32_t>(INTEGRATOR_COUNT)
+                ? static_cast<Integrator>(command.body) : Integrator::SemiImplicitEuler;
+            break;
+    }
+}
+
+uint64_t HashWorldState(const World& world) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+    world.bodies.forEachArray([&](const auto& array) { mix(array.data(), array.size() * sizeof(array[0])); });
+    mix(&world.stepIndex, sizeof(world.stepIndex));
+    return hash;
+}
+
+WorldCommand ContactSolverCommand(const ContactSolverSettings& solver) {
+    return { CommandType::SetContactSolver, solver.enabled ? 1u : 0u,
+             { static_cast<double>(solver.iterations), static_cast<double>(solver.correction), solver.restitution,
+               solver.baumgarte, solver.slop, solver.warmStarting ? 1.0 : 0.0 } };
+}
+
+WorldCommand ContinuousCollisionCommand(const ContinuousCollisionSettings& continuous) {
+    return { CommandType::SetContinuousCollision, continuous.enabled ? 1u : 0u,
+             { continuous.motionThreshold, static_cast<double>(continuous.maxSubsteps) } };
+}
+
+WorldCommand FmmCommand(const FmmSettings& fmm) {
+    return { CommandType::SetFmm, static_cast<uint32_t>(fmm.order),
+             { fmm.theta, static_cast<double>(fmm.leafCapacity), fmm.adaptive ? 1.0 : 0.0 } };
+}
+
+WorldCommand ParticleMeshCommand(const ParticleMeshSettings& mesh) {
+    return { CommandType::SetParticleMesh, static_cast<uint32_t>(mesh.gridSize),
+             { mesh.p3m ? 1.0 : 0.0, mesh.splitCells, static_cast<double>(mesh.assignment) } };
+}
+
+WorldSettings ReadWorldSettings(const World& world, float timeScale) {
+    WorldSettings s {};
+    s.gravity[0] = world.gf.magnitude;
+    s.gravity[1] = world.gf.direction[0];
+    s.gravity[2] = world.gf.direction[1];
+    s.electric[0] = world.ef.magnitude;
+    s.electric[1] = world.ef.direction[0];
+    s.electric[2] = world.ef.direction[1];
+    s.aspect = world.aspect;
+    s.fixedDeltaTime = world.clock.getFixedDeltaTime();
+    s.maxSubsteps = world.clock.getMaxSubsteps();
+    s.gravitySolver = world.gravitySolver;
+    s.barnesHutTheta = world.barnesHutTheta;
+    s.forceKernel = world.forceKernel;
+    s.threadCount = world.getThreadCount();
+    s.timeScale = timeScale;
+    s.sleep = world.sleep;
+    s.contactSolver = world.contactSolver.settings;
+    s.continuous = world.continuous.settings;
+    s.broadphase = world.broadphaseType;
+    s.fmm = world.fmm.settings;
+    s.particleMesh = world.particleMesh.settings;
+    s.integrator = world.integrator;
+    return s;
+}
+
+size_t DiffWorldSettings(const WorldSettings& from, const WorldSettings& to, WorldCommand* out) {
+    size_t count = 0;
+    auto emit = [&](CommandType type, uint32_t body, std::initializer_list<double> values) {
+        WorldCommand command { type, body };
+        std::copy(values.begin(), values.end(), command.values);
+        out[count++] = command;
+    };
+
+    if (std::memcmp(to.gravity, from.gravity, sizeof(to.gravity)) != 0) {
+        emit(CommandType::SetGravityField, 0, { to.gravity[0], to.gravity[1], to.gravity[2] });
+    }
+    if (std::memcmp(to.electric, from.electric, sizeof(to.electric)) != 0) {
+        emit(CommandType::SetElectricField, 0, { to.electric[0], to.electric[1], to.electric[2] });
+    }
+    if (to.aspect != from.aspect) {
+        emit(CommandType::SetBounds, 0, { to.aspect });
+    }
+    if (to.fixedDeltaTime != from.fixedDeltaTime) {
+        emit(CommandType::SetFixedStep, 0, { to.fixedDeltaTime });
+    }
+    if (to.maxSubsteps != from.maxSubsteps) {
+        emit(CommandType::SetMaxSubsteps, static_cast<uint32_t>(to.maxSubsteps), {});
+    }
+    if (to.gravitySolver != from.gravitySolver) {
+        emit(CommandType::SetGravitySolver, static_cast<uint32_t>(to.gravitySolver), {});
+    }
+    if (to.barnesHutTheta != from.barnesHutTheta) {
+        emit(CommandType::SetBarnesHutTheta, 0, { to.barnesHutTheta });
+    }
+    if (to.forceKernel != from.forceKernel) {
+        emit(CommandType::SetForceKernel, static_cast<uint32_t>(to.forceKernel), {});
+    }
+    if (to.threadCount != from.threadCount) {
+        emit(CommandType::SetThreadCount, to.threadCount, {});
+    }
+    if (to.sleep != from.sleep) {
+        emit(CommandType::SetSleeping, to.sleep.enabled ? 1u : 0u, { to.sleep.velocityThreshold, to.sleep.timeToSleep });
+    }
+    if (to.contactSolver != from.contactSolver) {
+        out[count++] = ContactSolverCommand(to.contactSolver);
+    }
+    if (to.continuous != from.continuous) {
+        out[count++] = ContinuousCollisionCommand(to.continuous);
+    }
+    if (to.broadphase != from.broadphase) {
+        emit(CommandType::SetBroadphase, static_cast<uint32_t>(to.broadphase), {});
+    }
+    if (to.fmm != from.fmm) {
+        out[count++] = FmmCommand(to.fmm);
+    }
+    if (to.particleMesh != from.particleMesh) {
+        out[count++] = ParticleMeshCommand(to.particleMesh);
+    }
+    if (to.integrator != from.integrator) {
+        emit(CommandType::SetIntegrator, static_cast<uint32_t>(to.integrator), {});
+    }
+    if (to.timeScale != from.timeScale) {
+        emit(CommandType::SetTimeScale, 0, { to.timeScale });
+    }
+    return count;
+}
+
+void CommandJournal::start(const World& world) {
+    std::ostringstream out(std::ios::binary);
+    WriteSnapshot(world, out);
+    initialSnapshot = out.str();
+    entries.clear();
+    threadCount = world.getThreadCount();
+    simdLevel = world.simdLevel;
+    recording = true;
+
+    // 快照不保存休眠、接触求解器、连续碰撞、粗检测、FMM与PM的设置，开头先各记一条；
+    // 配对在World::step中排序，粗检测本身不影响结果，记下它只为回放时的耗时与原来相同
+    entries.push_back({ world.stepIndex, { CommandType::SetSleeping, world.sleep.enabled ? 1u : 0u,
+                                           { world.sleep.velocityThreshold, world.sleep.timeToSleep } } });
+    entries.push_back({ world.stepIndex, ContactSolverCommand(world.contactSolver.settings) });
+    entries.push_back({ world.stepIndex, ContinuousCollisionCommand(world.continuous.settings) });
+    entries.push_back({ world.stepIndex, { CommandType::SetBroadphase, static_cast<uint32_t>(world.broadphaseType) } });
+    entries.push_back({ world.stepIndex, FmmCommand(world.fmm.settings) });
+    entries.push_back({ world.stepIndex, ParticleMeshCommand(world.particleMesh.settings) });
+}
+
+void CommandJournal::submit(World& world, const WorldCommand& command) {
+    if (recording) {
+        entries.push_back({ world.stepIndex, command });
+    }
+    ExecuteCommand(world, command);
+}
+
+bool CommandJournal::save(const World& world, const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    JournalHeader header {};
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.endianMark = SNAPSHOT_ENDIAN_MARK;
+    header.threadCount = threadCount;
+    header.simdLevel = static_cast<uint32_t>(simdLevel);
+    header.snapshotSize = initialSnapshot.size();
+    header.commandCount = entries.size();
+    header.finalStepIndex = world.stepIndex;
+    header.finalHash = HashWorldState(world);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(initialSnapshot.data(), static_cast<std::streamsize>(initialSnapshot.size()));
+    file.write(reinterpret_cast<const char*>(entries.data()),
+               static_cast<std::streamsize>(entries.size() * sizeof(JournalEntry)));
+    return static_cast<bool>(file);
+}
+
+bool LoadJournal(const std::string& path, JournalData& journal, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    JournalHeader& header = journal.header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0) {
+        error = path + ": not a journal file";
+        return false;
+    }
+    if (header.endianMark != SNAPSHOT_ENDIAN_MARK || header.version != JOURNAL_VERSION) {
+        error = path + ": unsupported journal version or byte order";
+        return false;
+    }
+
+    file.seekg(0, std::ios::end);
+    const uint64_t payload = static_cast<uint64_t>(file.tellg()) - sizeof(header);
+    if (header.snapshotSize > payload ||
+        header.commandCount != (payload - header.snapshotSize) / sizeof(JournalEntry)) {
+        error = path + ": truncated journal";
+        return false;
+    }
+    file.seekg(sizeof(header));
+
+    journal.snapshot.resize(header.snapshotSize);
+    journal.entries.resize(header.commandCount);
+    file.read(reinterpret_cast<char*>(journal.snapshot.data()), static_cast<std::streamsize>(journal.snapshot.size()));
+    file.read(reinterpret_cast<char*>(journal.entries.data()),
+              static_cast<std::streamsize>(journal.entries.size() * sizeof(JournalEntry)));
+    if (!file) {
+        error = path + ": truncated journal";
+        return false;
+    }
+    return true;
+}
+
+bool ReplayJournal(World& world, const JournalData& journal, ReplayResult& result, std::string& error) {
+    if (!ReadSnapshot(world, journal.snapshot.data(), journal.snapshot.size(), "journal snapshot", error)) {
+        return false;
+    }
+
+    // 线程数与指令集会改变浮点求和顺序，必须与录制时一致
+    world.setThreadCount(journal.header.threadCount);
+    world.simdLevel = static_cast<SimdLevel>(journal.header.simdLevel);
+
+    const uint64_t startStep = world.stepIndex;
+    const auto start = std::chrono::steady_clock::now();
+
+    size_t next = 0;
+    while (world.stepIndex < journal.header.finalStepIndex) {
+        while (next < journal.entries.size() && journal.entries[next].stepIndex <= world.stepIndex) {
+            ExecuteCommand(world, journal.entries[next++].command);
+        }
+        world.step(world.clock.getFixedDeltaTime());
+    }
+    // 最后一步之后的命令（例如结束前的拖拽）同样要执行，散列才一致
+    while (next < journal.entries.size()) {
+        ExecuteCommand(world, journal.entries[next++].command);
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.steps = world.stepIndex - startStep;
+    result.finalHash = HashWorldState(world);
+    result.hashMatches = result.finalHash == journal.header.finalHash;
+    return true;
+}
@@ -0,0 +1,484 @@
+#include "../include/ParticleMesh.h"
+#include "../include/axioms.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace {
+
+constexpr int SHORT_RANGE_TABLE_SIZE = 4096;
+
+// 分配与插值合起来的平滑对光滑的核相当于加上 (方差/2)∇²：
+// TSC每次方差1/4格²，合计1/2；CIC每次1/6格²，合计1/3
+constexpr double TSC_SMOOTHING = 0.25;
+constexpr double CIC_SMOOTHING = 1.0 / 6.0;
+
+// 长程部分erf(r/rs)/r势的径向力g(r)除以r：加速度 = 源强度 · LongRangeCoefficient · (源 - 目标)
+double LongRangeCoefficient(double r, double rs) {
+    const double x = r / rs;
+    if (x < 1e-4) {
+        // r → 0 的极限 4 / (3√π rs³)
+        return 4.0 / (3.0 * std::sqrt(std::numbers::pi) * rs * rs * rs);
+    }
+    return std::erf(x) / (r * r * r) - 2.0 * std::exp(-x * x) / (std::sqrt(std::numbers::pi) * rs * r * r);
+}
+
+// 不经过std::complex的乘法，避免对NaN/Inf的特殊处理拖慢内层循环
+inline std::complex<double> Multiply(std::complex<double> a, std::complex<double> b) {
+    return { a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real() };
+}
+
+// TSC（三角形云）权重：最近的格点与两侧格点，f为以网格间距为单位的坐标；返回第一个格点
+inline int TscWeights(double f, int n, double weights[3]) {
+    const int index = std::clamp(static_cast<int>(f + 0.5), 1, n - 2);
+    const double t = std::clamp(f - index, -0.5, 0.5);
+    weights[0] = 0.5 * (0.5 - t) * (0.5 - t);
+    weights[1] = 0.75 - t * t;
+    weights[2] = 0.5 * (0.5 + t) * (0.5 + t);
+    return index - 1;
+}
+
+// CIC（云中单元）权重：左侧与右侧两个格点，weights[2]不使用；返回第一个格点
+inline int CicWeights(double f, int n, double weights[3]) {
+    const int index = std::clamp(static_cast<int>(f), 0, n - 2);
+    const double t = std::clamp(f - index, 0.0, 1.0);
+    weights[0] = 1.0 - t;
+    weights[1] = t;
+    weights[2] = 0.0;
+    return index;
+}
+
+inline int AssignmentPoints(MeshAssignment assignment) {
+    return assignment == MeshAssignment::Cic ? 2 : 3;
+}
+
+inline int AssignmentWeights(MeshAssignment assignment, double f, int n, double weights[3]) {
+    return assignment == MeshAssignment::Cic ? CicWeights(f, n, weights) : TscWeights(f, n, weights);
+}
+
+int NextPowerOfTwo(int value) {
+    int size = 1;
+    while (size < value) size <<= 1;
+    return size;
+}
+
+}
+
+size_t ParticleMeshSolver::shortRangePairCount() const {
+    size_t total = 0;
+    for (size_t pairs : workerPairs) {
+        total += pairs;
+    }
+    return total;
+}
+
+void ParticleMeshSolver::prepareTransform(int size) {
+    m = size;
+    twiddles.resize(m / 2);
+    for (int k = 0; k < m / 2; k++) {
+        const double angle = -2.0 * std::numbers::pi * k / m;
+        twiddles[k] = { std::cos(angle), std::sin(angle) };
+    }
+    int bits = 0;
+    while ((1 << bits) < m) bits++;
+    bitReverse.resize(m);
+    for (int i = 0; i < m; i++) {
+        uint32_t reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        bitReverse[i] = reversed;
+    }
+
+    const size_t cells = static_cast<size_t>(m) * m;
+    for (std::vector<Complex>* array : { &green, &grid, &spectrum, &gridY }) {
+        array->assign(cells, Complex());
+    }
+    greenSize = 0;
+}
+
+// 原地基2 FFT（长度m），反变换不做1/m缩放
+void ParticleMeshSolver::fft(Complex* data, bool inverse) const {
+    for (int i = 0; i < m; i++) {
+        const int j = static_cast<int>(bitReverse[i]);
+        if (i < j) std::swap(data[i], data[j]);
+    }
+    for (int length = 2; length <= m; length <<= 1) {
+        const int half = length / 2;
+        const int stride = m / length;
+        for (int start = 0; start < m; start += length) {
+            for (int k = 0; k < half; k++) {
+                Complex w = twiddles[k * stride];
+                if (inverse) w = std::conj(w);
+                const Complex t = Multiply(data[start + k + half], w);
+                data[start + k + half] = data[start + k] - t;
+                data[start + k] += t;
+            }
+        }
+    }
+}
+
+void ParticleMeshSolver::transform(ThreadPool& pool, std::vector<Complex>& input, std::vector<Complex>& output,
+                                   bool inverse, int inputRows, int outputRows) {
+    // 补零的行变换后仍为0，跳过
+    pool.parallelFor(0, inputRows, [&](size_t row) { fft(input.data() + row * m, inverse); });
+
+    // 按32×32的块转置，只转置需要的输出行
+    constexpr int TILE = 32;
+    const int tiles = (outputRows + TILE - 1) / TILE;
+    pool.parallelFor(0, tiles, [&](size_t tileRow) {
+        const int x0 = static_cast<int>(tileRow) * TILE;
+        for (int y0 = 0; y0 < m; y0 += TILE) {
+            for (int x = x0; x < std::min(outputRows, x0 + TILE); x++) {
+                for (int y = y0; y < std::min(m, y0 + TILE); y++) {
+                    output[static_cast<size_t>(x) * m + y] = input[static_cast<size_t>(y) * m + x];
+                }
+            }
+        }
+    });
+
+    pool.parallelFor(0, outputRows, [&](size_t row) { fft(output.data() + row * m, inverse); });
+}
+
+void ParticleMeshSolver::layout(const BodyStore& bodies) {
+    const size_t count = bodies.size();
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < count; i++) {
+        minX = std::min(minX, bodies.x[i]);
+        minY = std::min(minY, bodies.y[i]);
+        maxX = std::max(maxX, bodies.x[i]);
+        maxY = std::max(maxY, bodies.y[i]);
+    }
+
+    // 四周各留一格，TSC的3×3个格点（CIC的2×2个）都落在[0, n)内
+    const double extent = std::max({ static_cast<double>(maxX) - minX, static_cast<double>(maxY) - minY, 1e-3 });
+    h = extent / (n - 3);
+    originX = minX - h;
+    originY = minY - h;
+
+    // 按网格行计数排序
+    bodyCell.resize(count);
+    rowStart.assign(static_cast<size_t>(n) + 1, 0);
+    for (size_t i = 0; i < count; i++) {
+        const int row = std::clamp(static_cast<int>((bodies.y[i] - originY) / h + 0.5), 1, n - 2);
+        bodyCell[i] = static_cast<uint32_t>(row);
+        rowStart[row + 1]++;
+    }
+    for (int r = 0; r < n; r++) {
+        rowStart[r + 1] += rowStart[r];
+    }
+    rowBodies.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        rowBodies[rowStart[bodyCell[i]]++] = static_cast<uint32_t>(i);
+    }
+    for (int r = n; r > 0; r--) {
+        rowStart[r] = rowStart[r - 1];
+    }
+    rowStart[0] = 0;
+}
+
+void ParticleMeshSolver::buildGreen(ThreadPool& pool) {
+    // 以网格间距为长度单位建核，与物体的范围无关，只在网格尺寸或分割尺度改变时重建
+    if (greenSize == m && greenSplit == settings.splitCells && greenAssignment == settings.assignment) return;
+    greenSize = m;
+    greenSplit = settings.splitCells;
+    greenAssignment = settings.assignment;
+
+    // 力核H(u) = -f(|u|)·u，u = 目标 - 源，x、y分量放在实部与虚部；偏移超出±(n-1)格的位置不会被用到。
+    // 分配与插值各做一次平滑，平均下来相当于与方差为1/2格²（CIC为1/3格²）的核卷积，
+    // 事先减去 (1/4)∇²H（CIC为(1/6)∇²H）抵消这一偏差（拉普拉斯用相邻格点的差分）
+    const double split = settings.splitCells;
+    const double smoothing = settings.assignment == MeshAssignment::Cic ? CIC_SMOOTHING : TSC_SMOOTHING;
+    auto kernel = [split](double ux, double uy) {
+        if (ux == 0.0 && uy == 0.0) return Complex();
+        const double f = LongRangeCoefficient(std::sqrt(ux * ux + uy * uy), split);
+        return Complex(-f * ux, -f * uy);
+    };
+    pool.parallelFor(0, m, [&](size_t row) {
+        const int iy = static_cast<int>(row);
+        const double uy = iy < n ? iy : iy - m;
+        for (int ix = 0; ix < m; ix++) {
+            const double ux = ix < n ? ix : ix - m;
+            Complex value;
+            if (iy != n && ix != n) {
+                const Complex center = kernel(ux, uy);
+                const Complex laplacian = kernel(ux + 1.0, uy) + kernel(ux - 1.0, uy) + kernel(ux, uy + 1.0) +
+                                          kernel(ux, uy - 1.0) - 4.0 * center;
+                value = center - smoothing * laplacian;
+            }
+            grid[row * m + ix] = value;
+        }
+    });
+    transform(pool, grid, green, false, m, m);
+}
+
+void ParticleMeshSolver::deposit(const BodyStore& bodies, ThreadPool& pool, bool gravity) {
+    pool.parallelFor(0, m, [&](size_t row) {
+        std::fill(grid.begin() + row * m, grid.begin() + (row + 1) * m, Complex());
+    });
+
+    // 每个线程只写自己负责的网格行，处理最近行落在这些行及上下各一行的物体；
+    // 同一格点的累加顺序固定（按最近行从小到大），与线程数无关
+    const unsigned workerCount = pool.size();
+    const MeshAssignment assignment = settings.assignment;
+    const int points = AssignmentPoints(assignment);
+    pool.dispatch([&](unsigned w) {
+        size_t first, last;
+        ThreadPool::splitRange(static_cast<size_t>(n), w, workerCount, first, last);
+        if (first >= last) return;
+        const uint32_t from = rowStart[first > 0 ? first - 1 : 0];
+        const uint32_t to = rowStart[std::min(last + 1, static_cast<size_t>(n))];
+        for (uint32_t s = from; s < to; s++) {
+            const uint32_t i = rowBodies[s];
+            double wx[3], wy[3];
+            const int ix = AssignmentWeights(assignment, (bodies.x[i] - originX) / h, n, wx);
+            const int iy = AssignmentWeights(assignment, (bodies.y[i] - originY) / h, n, wy);
+            const Complex source = packed ? Complex(gravity ? bodies.mass[i] : bodies.charge[i], 0.0)
+                                          : Complex(bodies.mass[i], bodies.charge[i]);
+            for (int dy = 0; dy < points; dy++) {
+                const size_t row = static_cast<size_t>(iy + dy);
+                if (row < first || row >= last) continue;
+                Complex* cells = grid.data() + row * m + ix;
+                for (int dx = 0; dx < points; dx++) {
+                    cells[dx] += source * (wx[dx] * wy[dy]);
+                }
+            }
+        }
+    });
+}
+
+void ParticleMeshSolver::solve(ThreadPool& pool) {
+    // 密度只在前n行、前n列，场也只需要这一部分
+    transform(pool, grid, spectrum, false, n, m);
+
+    // 核的频谱Z = Hx^ + i·Hy^，Hx、Hy为实函数，由Z(k)与Z(-k)的共轭分离。
+    // 只有一种源时密度为实数，x、y方向的场合在一次反变换里（实部与虚部）；
+    // 否则x方向的场写进gridY，y方向的场写进spectrum原位，各反变换一次
+    const double scale = 1.0 / (static_cast<double>(m) * m);
+    pool.parallelFor(0, m, [&](size_t row) {
+        const size_t negativeRow = (m - row) % m;
+        for (int column = 0; column < m; column++) {
+            const size_t k = row * m + column;
+            const Complex z = green[k];
+            const Complex zNegative = std::conj(green[negativeRow * m + (m - column) % m]);
+            const Complex hx = 0.5 * scale * (z + zNegative);
+            const Complex difference = z - zNegative;
+            const Complex hy(0.5 * scale * difference.imag(), -0.5 * scale * difference.real());
+            const Complex fieldX = Multiply(spectrum[k], hx);
+            const Complex fieldY = Multiply(spectrum[k], hy);
+            if (packed) {
+                gridY[k] = { fieldX.real() - fieldY.imag(), fieldX.imag() + fieldY.real() };
+            } else {
+                gridY[k] = fieldX;
+                spectrum[k] = fieldY;
+            }
+        }
+    });
+
+    transform(pool, gridY, grid, true, m, n);
+    if (!packed) {
+        transform(pool, spectrum, gridY, true, m, n);
+    }
+}
+
+void ParticleMeshSolver::interpolate(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params) {
+    const MeshAssignment assignment = settings.assignment;
+    const int points = AssignmentPoints(assignment);
+    pool.parallelFor(0, bodies.size(), [&](size_t i) {
+        if (!bodies.isAwake(i)) return;
+        double wx[3], wy[3];
+        const int ix = AssignmentWeights(assignment, (bodies.x[i] - originX) / h, n, wx);
+        const int iy = AssignmentWeights(assignment, (bodies.y[i] - originY) / h, n, wy);
+
+        auto gather = [&](const std::vector<Complex>& field) {
+            Complex sum;
+            for (int dy = 0; dy < points; dy++) {
+                const size_t row = static_cast<size_t>(iy + dy) * m + ix;
+                for (int dx = 0; dx < points; dx++) {
+                    sum += field[row + dx] * (wx[dx] * wy[dy]);
+                }
+            }
+            return sum;
+        };
+
+        // 实部为质量产生的场，虚部为电荷产生的场
+        Complex fieldX, fieldY;
+        if (packed) {
+            const Complex field = gather(grid);
+            fieldX = params.gravity ? Complex(field.real(), 0.0) : Complex(0.0, field.real());
+            fieldY = params.gravity ? Complex(field.imag(), 0.0) : Complex(0.0, field.imag());
+        } else {
+            fieldX = gather(grid);
+            fieldY = gather(gridY);
+        }
+
+        // a = G·Am - K·q/m·Aq；场以网格间距为长度单位，换算回来除以h²
+        fieldX *= 1.0 / (h * h);
+        fieldY *= 1.0 / (h * h);
+        double ax = 0.0, ay = 0.0;
+        if (params.gravity) {
+            ax += G * fieldX.real();
+            ay += G * fieldY.real();
+        }
+        if (params.coulomb && bodies.charge[i] != 0.0f) {
+            const double charge = K * bodies.charge[i] * bodies.invMass[i];
+            ax -= charge * fieldX.imag();
+            ay -= charge * fieldY.imag();
+        }
+        bodies.ax[i] += static_cast<float>(ax);
+        bodies.ay[i] += static_cast<float>(ay);
+    });
+}
+
+void ParticleMeshSolver::shortRange(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params,
+                                    float clampDistance) {
+    // 库仑力被限制的距离都在截断半径内，限制只由直接部分处理
+    cutoffRadius = std::max(static_cast<double>(CUTOFF_SPLITS) * rs, static_cast<double>(clampDistance));
+    const float cutoffSq = static_cast<float>(cutoffRadius * cutoffRadius);
+
+    // 长程系数按r²等分制表，线性插值
+    tableStep = cutoffSq / SHORT_RANGE_TABLE_SIZE;
+    shortRangeTable.resize(SHORT_RANGE_TABLE_SIZE + 2);
+    for (int k = 0; k < SHORT_RANGE_TABLE_SIZE + 2; k++) {
+        shortRangeTable[k] = static_cast<float>(LongRangeCoefficient(std::sqrt(static_cast<double>(k) * tableStep), rs));
+    }
+
+    // 链表网格覆盖整个PM网格，格子边长不小于截断半径
+    const double span = n * h;
+    chainCells = std::clamp(static_cast<int>(span / cutoffRadius), 1, n);
+    chainSize = span / chainCells;
+    const size_t count = bodies.size();
+    const size_t cells = static_cast<size_t>(chainCells) * chainCells;
+    chainStart.assign(cells + 1, 0);
+    auto chainCoordinate = [&](float value, double origin) {
+        return std::clamp(static_cast<int>((value - origin) / chainSize), 0, chainCells - 1);
+    };
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t cell = static_cast<uint32_t>(chainCoordinate(bodies.y[i], originY) * chainCells +
+                                                    chainCoordinate(bodies.x[i], originX));
+        bodyCell[i] = cell;
+        chainStart[cell + 1]++;
+    }
+    for (size_t c = 0; c < cells; c++) {
+        chainStart[c + 1] += chainStart[c];
+    }
+    chainBodies.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        chainBodies[chainStart[bodyCell[i]]++] = static_cast<uint32_t>(i);
+    }
+    for (size_t c = cells; c > 0; c--) {
+        chainStart[c] = chainStart[c - 1];
+    }
+    chainStart[0] = 0;
+
+    // 按链表网格顺序复制源的数据，相邻格子的源在内存中连续
+    for (std::vector<float>* array : { &chainX, &chainY, &chainMass, &chainCharge }) {
+        array->resize(count);
+    }
+    for (size_t s = 0; s < count; s++) {
+        const uint32_t j = chainBodies[s];
+        chainX[s] = bodies.x[j];
+        chainY[s] = bodies.y[j];
+        chainMass[s] = bodies.mass[j];
+        chainCharge[s] = bodies.charge[j];
+    }
+
+    const float softeningSq = params.softening * params.softening;
+    const float gravityScale = params.gravity ? static_cast<float>(G) : 0.0f;
+    const float coulombScale = params.coulomb ? static_cast<float>(K) : 0.0f;
+    const float inverseStep = 1.0f / tableStep;
+    const unsigned workerCount = pool.size();
+    workerPairs.assign(workerCount, 0);
+
+    // 加上精确的两两作用（与合并内核相同的软化与限制），减去网格已算过的长程部分
+    pool.dispatch([&](unsigned w) {
+        size_t first, last;
+        ThreadPool::splitRange(cells, w, workerCount, first, last);
+        size_t pairs = 0;
+        for (size_t cell = first; cell < last; cell++) {
+            const int cx = static_cast<int>(cell % chainCells);
+            const int cy = static_cast<int>(cell / chainCells);
+            for (uint32_t t = chainStart[cell]; t < chainStart[cell + 1]; t++) {
+                const uint32_t i = chainBodies[t];
+                if (!bodies.isAwake(i)) continue;
+                const float xi = chainX[t];
+                const float yi = chainY[t];
+                const float kqi = coulombScale * bodies.charge[i];
+                const float invMassI = bodies.invMass[i];
+                float axi = 0.0f, ayi = 0.0f;
+
+                // 同一行的三个相邻格子在排序后的数组中是一段连续区间
+                const int left = std::max(0, cx - 1);
+                const int right = std::min(chainCells - 1, cx + 1);
+                for (int ny = std::max(0, cy - 1); ny <= std::min(chainCells - 1, cy + 1); ny++) {
+                    const size_t rowCell = static_cast<size_t>(ny) * chainCells;
+                    for (uint32_t s = chainStart[rowCell + left]; s < chainStart[rowCell + right + 1]; s++) {
+                        const float dx = chainX[s] - xi;
+                        const float dy = chainY[s] - yi;
+                        const float r2 = dx * dx + dy * dy;
+                        if (r2 >= cutoffSq || s == t) continue;
+                        pairs++;
+
+                        const float position = r2 * inverseStep;
+                        const int k = static_cast<int>(position);
+                        const float fraction = position - k;
+                        const float longRange = shortRangeTable[k] + fraction * (shortRangeTable[k + 1] - shortRangeTable[k]);
+
+                        const float invR = 1.0f / sqrtf(r2 + softeningSq);
+                        const float invRC = std::min(invR, COULOMB_MAX_INV_DISTANCE);
+                        const float kqq = kqi * chainCharge[s];
+                        const float force = std::clamp(kqq * invRC * invRC, -COULOMB_MAX_FORCE, COULOMB_MAX_FORCE);
+                        const float sGravity = gravityScale * chainMass[s] * (invR * invR * invR - longRange);
+                        const float sCoulomb = (force * invRC - kqq * longRange) * invMassI;
+                        axi += (sGravity - sCoulomb) * dx;
+                        ayi += (sGravity - sCoulomb) * dy;
+                    }
+                }
+                bodies.ax[i] += axi;
+                bodies.ay[i] += ayi;
+            }
+        }
+        workerPairs[w] = pairs;
+    });
+}
+
+void ParticleMeshSolver::apply(BodyStore& bodies, ThreadPool& pool, const FusedForceParams& params) {
+    if (bodies.size() < 2) return;
+
+    float maxCharge = 0.0f;
+    for (float q : bodies.charge) {
+        maxCharge = std::max(maxCharge, std::fabs(q));
+    }
+    FusedForceParams kernels = params;
+    kernels.coulomb = params.coulomb && maxCharge > 0.0f;
+    if (!kernels.gravity && !kernels.coulomb) return;
+    // 库仑力被限制的距离，与FMM相同
+    const float clampDistance = kernels.coulomb
+        ? static_cast<float>(std::max(1.0 / COULOMB_MAX_INV_DISTANCE, std::sqrt(K * maxCharge * maxCharge / COULOMB_MAX_FORCE)))
+        : 0.0f;
+
+    settings.gridSize = NextPowerOfTwo(std::clamp(settings.gridSize, MIN_GRID, MAX_GRID));
+    settings.splitCells = std::clamp(settings.splitCells, 0.5f, 4.0f);
+    n = settings.gridSize;
+    if (m != 2 * n) {
+        prepareTransform(2 * n);
+    }
+
+    packed = !(kernels.gravity && kernels.coulomb);
+    layout(bodies);
+    rs = static_cast<double>(settings.splitCells) * h;
+    buildGreen(pool);
+    deposit(bodies, pool, kernels.gravity);
+    solve(pool);
+    interpolate(bodies, pool, kernels);
+    if (settings.p3m) {
+        shortRange(bodies, pool, kernels, clampDistance);
+    } else {
+        workerPairs.clear();
+        cutoffRadius = 0.0;
+    }
+}
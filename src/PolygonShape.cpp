@@ -0,0 +1,36 @@
+#include "../include/PolygonShape.h"
+#include "../include/axioms.h"
+#include <array>
+#include <cmath>
+
+namespace {
+
+// 顶点按逆时针排列，与原先逐次生成顶点时的公式相同
+std::array<PolygonShape, MAX_POLYGON_SIDES + 1> BuildShapes() {
+    std::array<PolygonShape, MAX_POLYGON_SIDES + 1> shapes {};
+    for (uint32_t sides = 3; sides <= MAX_POLYGON_SIDES; sides++) {
+        PolygonShape& shape = shapes[sides];
+        shape.count = sides;
+        for (uint32_t k = 0; k < sides; k++) {
+            const float angle = 2.0f * PI * k / sides;
+            shape.vx[k] = cosf(angle);
+            shape.vy[k] = sinf(angle);
+        }
+        for (uint32_t k = 0; k < sides; k++) {
+            const uint32_t next = (k + 1) % sides;
+            const float nx = shape.vy[next] - shape.vy[k];
+            const float ny = -(shape.vx[next] - shape.vx[k]);
+            const float length = sqrtf(nx * nx + ny * ny);
+            shape.nx[k] = nx / length;
+            shape.ny[k] = ny / length;
+        }
+    }
+    return shapes;
+}
+
+}
+
+const PolygonShape& GetPolygonShape(uint32_t sides) {
+    static const std::array<PolygonShape, MAX_POLYGON_SIDES + 1> shapes = BuildShapes();
+    return shapes[sides];
+}
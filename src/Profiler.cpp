@@ -0,0 +1,87 @@
+#include "../include/Profiler.h"
+#include <fstream>
+#include <cstring>
+
+bool Profiler::read(uint64_t index, Event& event) const {
+    const Slot& slot = slots[index & (EVENT_CAPACITY - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != index + 1) return false;
+    event = slot.event;
+    // 拷贝期间被其他线程覆盖时序号会改变
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == index + 1;
+}
+
+size_t Profiler::zoneIndex(const char* name) {
+    for (size_t i = 0; i < zones; i++) {
+        if (zoneNames[i] == name || std::strcmp(zoneNames[i], name) == 0) return i;
+    }
+    if (zones == MAX_ZONES) return MAX_ZONES;
+    zoneNames[zones] = name;
+    return zones++;
+}
+
+void Profiler::beginFrame() {
+    const uint64_t time = now();
+    const uint64_t end = head.load(std::memory_order_acquire);
+
+    if (frameStartTime != 0) {
+        Frame& frame = frames[completedFrames % FRAME_HISTORY];
+        frame = Frame {};
+        frame.start = frameStartTime;
+        frame.end = time;
+
+        if (!freeze) frameEvents.clear();
+        const uint64_t first = std::max(frameStartIndex, end > EVENT_CAPACITY ? end - EVENT_CAPACITY : 0);
+        Event event;
+        for (uint64_t i = first; i < end; i++) {
+            if (!read(i, event)) continue;
+            const size_t zone = zoneIndex(event.name);
+            if (zone < MAX_ZONES) {
+                frame.zoneMs[zone] += static_cast<float>(event.end - event.start) * 1e-6f;
+            }
+            if (!freeze) frameEvents.push_back(event);
+        }
+        completedFrames++;
+    }
+
+    frameStartIndex = end;
+    frameStartTime = time;
+}
+
+void Profiler::zoneHistory(size_t zone, std::vector<float>& out) const {
+    const size_t count = frameCount();
+    out.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = frame(count - 1 - i).zoneMs[zone];
+    }
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) return false;
+
+    const uint64_t end = head.load(std::memory_order_acquire);
+    const uint64_t first = end > EVENT_CAPACITY ? end - EVENT_CAPACITY : 0;
+
+    std::vector<Event> events;
+    events.reserve(end - first);
+    Event event;
+    uint64_t origin = UINT64_MAX;
+    for (uint64_t i = first; i < end; i++) {
+        if (!read(i, event)) continue;
+        events.push_back(event);
+        origin = std::min(origin, event.start);
+    }
+
+    // 完整事件（ph = X），时间单位为微秒
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event& e = events[i];
+        file << (i ? ",\n" : "\n")
+             << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread
+             << ",\"ts\":" << static_cast<double>(e.start - origin) * 1e-3
+             << ",\"dur\":" << static_cast<double>(e.end - e.start) * 1e-3 << "}";
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
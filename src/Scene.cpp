@@ -0,0 +1,89 @@
+#include "../include/Scene.h"
+#include <fstream>
+#include <sstream>
+
+bool LoadScene(World& world, const std::string& path, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    world.clear();
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream in(line);
+        std::string kind;
+        if (!(in >> kind) || kind[0] == '#') continue;
+
+        bool ok = true;
+        if (kind == "gravity" || kind == "electric") {
+            double magnitude, dx, dy;
+            ok = static_cast<bool>(in >> magnitude >> dx >> dy);
+            if (ok && kind == "gravity") {
+                world.gf.magnitude = magnitude;
+                world.gf.direction[0] = dx;
+                world.gf.direction[1] = dy;
+                world.gf.direction[2] = 0.0;
+            } else if (ok) {
+                world.ef.magnitude = magnitude;
+                world.ef.direction[0] = dx;
+                world.ef.direction[1] = dy;
+                world.ef.direction[2] = 0.0;
+            }
+        } else if (kind == "bounds") {
+            ok = static_cast<bool>(in >> world.aspect) && world.aspect > 0.0f;
+        } else if (kind == "circle") {
+            float x, y, radius, mass, charge, vx = 0.0f, vy = 0.0f;
+            int movable;
+            ok = static_cast<bool>(in >> x >> y >> radius >> mass >> charge >> movable) && mass > 0.0f;
+            if (ok) {
+                in >> vx >> vy;
+                world.addCircle(x, y, radius, mass, charge, movable != 0).setVelocity(vx, vy);
+            }
+        } else if (kind == "polygon") {
+            int sides, movable;
+            float radius, x, y, mass, charge, vx = 0.0f, vy = 0.0f;
+            ok = static_cast<bool>(in >> sides >> radius >> x >> y >> mass >> charge >> movable) && sides >= 3 &&
+                 sides <= static_cast<int>(MAX_POLYGON_SIDES) && mass > 0.0f;
+            if (ok) {
+                in >> vx >> vy;
+                world.addPolygon(sides, radius, x, y, mass, charge, movable != 0).setVelocity(vx, vy);
+            }
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            error = path + ":" + std::to_string(lineNumber) + ": invalid record '" + line + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SaveScene(const World& world, const std::string& path) {
+    std::ofstream file(path);
+    if (!file) return false;
+
+    file.precision(9);
+    file << "gravity " << world.gf.magnitude << ' ' << world.gf.direction[0] << ' ' << world.gf.direction[1] << '\n';
+    file << "electric " << world.ef.magnitude << ' ' << world.ef.direction[0] << ' ' << world.ef.direction[1] << '\n';
+    file << "bounds " << world.aspect << '\n';
+
+    const BodyStore& b = world.bodies;
+    for (size_t i = 0; i < b.size(); i++) {
+        const int movable = b.isMovable(i) ? 1 : 0;
+        if (b.shape[i] == SHAPE_POLYGON) {
+            file << "polygon " << b.vertices[i] << ' ' << b.radius[i] << ' ' << b.x[i] << ' ' << b.y[i] << ' '
+                 << b.mass[i] << ' ' << b.charge[i] << ' ' << movable << ' ' << b.vx[i] << ' ' << b.vy[i] << '\n';
+        } else {
+            file << "circle " << b.x[i] << ' ' << b.y[i] << ' ' << b.radius[i] << ' ' << b.mass[i] << ' '
+                 << b.charge[i] << ' ' << movable << ' ' << b.vx[i] << ' ' << b.vy[i] << '\n';
+        }
+    }
+    return static_cast<bool>(file);
+}
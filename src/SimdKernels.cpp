@@ -0,0 +1,337 @@
+#include "../include/SimdKernels.h"
+#include "../include/axioms.h"
+#include <cmath>
+#include <algorithm>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PHYSICS2D_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON)
+#define PHYSICS2D_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// 一次取出内核需要的全部数组指针与常量
+struct KernelInput {
+    const float* x;
+    const float* y;
+    const float* mass;
+    const float* charge;
+    const float* invMass;
+    const uint32_t* flags;
+    float* ax;
+    float* ay;
+    size_t sourceBegin;  // 源物体区间，ApplyFusedForces为全部物体
+    size_t sourceEnd;
+    float softeningSq;
+    float gravityScale;  // G，不计算引力时为0
+    float coulombScale;  // K，不计算库仑力时为0
+};
+
+// 一组目标中是否有需要受力的物体（可移动且未休眠）；整组都不需要时跳过这一组
+bool AnyAwake(const uint32_t* flags, size_t count) {
+    for (size_t k = 0; k < count; k++) {
+        if ((flags[k] & (BODY_MOVABLE | BODY_SLEEPING)) == BODY_MOVABLE) return true;
+    }
+    return false;
+}
+
+// 单个目标的标量版本，向量内核的尾部与不支持SIMD的CPU都走这里
+void AccumulateTarget(const KernelInput& in, size_t i) {
+    if (!AnyAwake(in.flags + i, 1)) return;
+    const float xi = in.x[i];
+    const float yi = in.y[i];
+    const float qi = in.charge[i];
+    const float invMassI = in.invMass[i];
+    float axi = 0.0f;
+    float ayi = 0.0f;
+
+    for (size_t j = in.sourceBegin; j < in.sourceEnd; j++) {
+        const float dx = in.x[j] - xi;
+        const float dy = in.y[j] - yi;
+        const float invR = 1.0f / sqrtf(dx * dx + dy * dy + in.softeningSq);
+        const float invRC = std::min(invR, COULOMB_MAX_INV_DISTANCE);
+
+        float force = in.coulombScale * qi * in.charge[j] * invRC * invRC;
+        force = std::clamp(force, -COULOMB_MAX_FORCE, COULOMB_MAX_FORCE);
+
+        // 自身配对dx = dy = 0，不需要单独跳过
+        const float s = in.gravityScale * in.mass[j] * invR * invR * invR - force * invMassI * invRC;
+        axi += s * dx;
+        ayi += s * dy;
+    }
+
+    if (in.flags[i] & BODY_MOVABLE) {
+        in.ax[i] += axi;
+        in.ay[i] += ayi;
+    }
+}
+
+void AccumulateScalar(const KernelInput& in, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        AccumulateTarget(in, i);
+    }
+}
+
+#ifdef PHYSICS2D_SIMD_X86
+
+// 8个目标一组；rsqrt约12位精度，一次牛顿迭代后接近单精度
+__attribute__((target("avx2,fma")))
+size_t AccumulateAVX2(const KernelInput& in, size_t begin, size_t end) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 threeHalves = _mm256_set1_ps(1.5f);
+    const __m256 eps2 = _mm256_set1_ps(in.softeningSq);
+    const __m256 gScale = _mm256_set1_ps(in.gravityScale);
+    const __m256 maxInv = _mm256_set1_ps(COULOMB_MAX_INV_DISTANCE);
+    const __m256 maxForce = _mm256_set1_ps(COULOMB_MAX_FORCE);
+    const __m256 minForce = _mm256_set1_ps(-COULOMB_MAX_FORCE);
+    const __m256i movableBit = _mm256_set1_epi32(BODY_MOVABLE);
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        if (!AnyAwake(in.flags + i, 8)) continue;
+        const __m256 xi = _mm256_loadu_ps(in.x + i);
+        const __m256 yi = _mm256_loadu_ps(in.y + i);
+        // K·q_i 与 q_i/m_i 对每个目标只算一次
+        const __m256 kqi = _mm256_mul_ps(_mm256_set1_ps(in.coulombScale), _mm256_loadu_ps(in.charge + i));
+        const __m256 invMassI = _mm256_loadu_ps(in.invMass + i);
+        __m256 axi = _mm256_setzero_ps();
+        __m256 ayi = _mm256_setzero_ps();
+
+        for (size_t j = in.sourceBegin; j < in.sourceEnd; j++) {
+            const __m256 dx = _mm256_sub_ps(_mm256_set1_ps(in.x[j]), xi);
+            const __m256 dy = _mm256_sub_ps(_mm256_set1_ps(in.y[j]), yi);
+            const __m256 r2 = _mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, eps2));
+
+            __m256 invR = _mm256_rsqrt_ps(r2);
+            const __m256 hx = _mm256_mul_ps(_mm256_mul_ps(half, r2), _mm256_mul_ps(invR, invR));
+            invR = _mm256_mul_ps(invR, _mm256_sub_ps(threeHalves, hx));
+
+            const __m256 invR2 = _mm256_mul_ps(invR, invR);
+            __m256 s = _mm256_mul_ps(_mm256_mul_ps(gScale, _mm256_set1_ps(in.mass[j])), _mm256_mul_ps(invR2, invR));
+
+            const __m256 invRC = _mm256_min_ps(invR, maxInv);
+            __m256 force = _mm256_mul_ps(_mm256_mul_ps(kqi, _mm256_set1_ps(in.charge[j])), _mm256_mul_ps(invRC, invRC));
+            force = _mm256_max_ps(_mm256_min_ps(force, maxForce), minForce);
+            s = _mm256_fnmadd_ps(_mm256_mul_ps(force, invMassI), invRC, s);
+
+            axi = _mm256_fmadd_ps(s, dx, axi);
+            ayi = _mm256_fmadd_ps(s, dy, ayi);
+        }
+
+        // 只累加到可移动物体
+        const __m256i flags = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in.flags + i));
+        const __m256 movable = _mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(_mm256_and_si256(flags, movableBit), movableBit));
+        _mm256_storeu_ps(in.ax + i, _mm256_add_ps(_mm256_loadu_ps(in.ax + i), _mm256_and_ps(axi, movable)));
+        _mm256_storeu_ps(in.ay + i, _mm256_add_ps(_mm256_loadu_ps(in.ay + i), _mm256_and_ps(ayi, movable)));
+    }
+    return i;
+}
+
+// 16个目标一组；rsqrt14加一次牛顿迭代
+__attribute__((target("avx512f")))
+size_t AccumulateAVX512(const KernelInput& in, size_t begin, size_t end) {
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 threeHalves = _mm512_set1_ps(1.5f);
+    const __m512 eps2 = _mm512_set1_ps(in.softeningSq);
+    const __m512 gScale = _mm512_set1_ps(in.gravityScale);
+    const __m512 maxInv = _mm512_set1_ps(COULOMB_MAX_INV_DISTANCE);
+    const __m512 maxForce = _mm512_set1_ps(COULOMB_MAX_FORCE);
+    const __m512 minForce = _mm512_set1_ps(-COULOMB_MAX_FORCE);
+    const __m512i movableBit = _mm512_set1_epi32(BODY_MOVABLE);
+
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16) {
+        if (!AnyAwake(in.flags + i, 16)) continue;
+        const __m512 xi = _mm512_loadu_ps(in.x + i);
+        const __m512 yi = _mm512_loadu_ps(in.y + i);
+        const __m512 kqi = _mm512_mul_ps(_mm512_set1_ps(in.coulombScale), _mm512_loadu_ps(in.charge + i));
+        const __m512 invMassI = _mm512_loadu_ps(in.invMass + i);
+        __m512 axi = _mm512_setzero_ps();
+        __m512 ayi = _mm512_setzero_ps();
+
+        for (size_t j = in.sourceBegin; j < in.sourceEnd; j++) {
+            const __m512 dx = _mm512_sub_ps(_mm512_set1_ps(in.x[j]), xi);
+            const __m512 dy = _mm512_sub_ps(_mm512_set1_ps(in.y[j]), yi);
+            const __m512 r2 = _mm512_fmadd_ps(dx, dx, _mm512_fmadd_ps(dy, dy, eps2));
+
+            __m512 invR = _mm512_rsqrt14_ps(r2);
+            const __m512 hx = _mm512_mul_ps(_mm512_mul_ps(half, r2), _mm512_mul_ps(invR, invR));
+            invR = _mm512_mul_ps(invR, _mm512_sub_ps(threeHalves, hx));
+
+            const __m512 invR2 = _mm512_mul_ps(invR, invR);
+            __m512 s = _mm512_mul_ps(_mm512_mul_ps(gScale, _mm512_set1_ps(in.mass[j])), _mm512_mul_ps(invR2, invR));
+
+            const __m512 invRC = _mm512_min_ps(invR, maxInv);
+            __m512 force = _mm512_mul_ps(_mm512_mul_ps(kqi, _mm512_set1_ps(in.charge[j])), _mm512_mul_ps(invRC, invRC));
+            force = _mm512_max_ps(_mm512_min_ps(force, maxForce), minForce);
+            s = _mm512_fnmadd_ps(_mm512_mul_ps(force, invMassI), invRC, s);
+
+            axi = _mm512_fmadd_ps(s, dx, axi);
+            ayi = _mm512_fmadd_ps(s, dy, ayi);
+        }
+
+        const __m512i flags = _mm512_loadu_si512(in.flags + i);
+        const __mmask16 movable = _mm512_test_epi32_mask(flags, movableBit);
+        _mm512_storeu_ps(in.ax + i, _mm512_mask_add_ps(_mm512_loadu_ps(in.ax + i), movable, _mm512_loadu_ps(in.ax + i), axi));
+        _mm512_storeu_ps(in.ay + i, _mm512_mask_add_ps(_mm512_loadu_ps(in.ay + i), movable, _mm512_loadu_ps(in.ay + i), ayi));
+    }
+    return i;
+}
+
+#endif
+
+#ifdef PHYSICS2D_SIMD_NEON
+
+// 4个目标一组；vrsqrte只有约8位精度，做两次牛顿迭代
+size_t AccumulateNEON(const KernelInput& in, size_t begin, size_t end) {
+    const float32x4_t eps2 = vdupq_n_f32(in.softeningSq);
+    const float32x4_t gScale = vdupq_n_f32(in.gravityScale);
+    const float32x4_t maxInv = vdupq_n_f32(COULOMB_MAX_INV_DISTANCE);
+    const float32x4_t maxForce = vdupq_n_f32(COULOMB_MAX_FORCE);
+    const float32x4_t minForce = vdupq_n_f32(-COULOMB_MAX_FORCE);
+    const uint32x4_t movableBit = vdupq_n_u32(BODY_MOVABLE);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        if (!AnyAwake(in.flags + i, 4)) continue;
+        const float32x4_t xi = vld1q_f32(in.x + i);
+        const float32x4_t yi = vld1q_f32(in.y + i);
+        const float32x4_t kqi = vmulq_n_f32(vld1q_f32(in.charge + i), in.coulombScale);
+        const float32x4_t invMassI = vld1q_f32(in.invMass + i);
+        float32x4_t axi = vdupq_n_f32(0.0f);
+        float32x4_t ayi = vdupq_n_f32(0.0f);
+
+        for (size_t j = in.sourceBegin; j < in.sourceEnd; j++) {
+            const float32x4_t dx = vsubq_f32(vdupq_n_f32(in.x[j]), xi);
+            const float32x4_t dy = vsubq_f32(vdupq_n_f32(in.y[j]), yi);
+            const float32x4_t r2 = vmlaq_f32(vmlaq_f32(eps2, dy, dy), dx, dx);
+
+            float32x4_t invR = vrsqrteq_f32(r2);
+            invR = vmulq_f32(invR, vrsqrtsq_f32(vmulq_f32(r2, invR), invR));
+            invR = vmulq_f32(invR, vrsqrtsq_f32(vmulq_f32(r2, invR), invR));
+
+            const float32x4_t invR2 = vmulq_f32(invR, invR);
+            float32x4_t s = vmulq_f32(vmulq_n_f32(gScale, in.mass[j]), vmulq_f32(invR2, invR));
+
+            const float32x4_t invRC = vminq_f32(invR, maxInv);
+            float32x4_t force = vmulq_f32(vmulq_n_f32(kqi, in.charge[j]), vmulq_f32(invRC, invRC));
+            force = vmaxq_f32(vminq_f32(force, maxForce), minForce);
+            s = vmlsq_f32(s, vmulq_f32(force, invMassI), invRC);
+
+            axi = vmlaq_f32(axi, s, dx);
+            ayi = vmlaq_f32(ayi, s, dy);
+        }
+
+        const uint32x4_t movable = vtstq_u32(vld1q_u32(in.flags + i), movableBit);
+        axi = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(axi), movable));
+        ayi = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(ayi), movable));
+        vst1q_f32(in.ax + i, vaddq_f32(vld1q_f32(in.ax + i), axi));
+        vst1q_f32(in.ay + i, vaddq_f32(vld1q_f32(in.ay + i), ayi));
+    }
+    return i;
+}
+
+#endif
+
+}
+
+bool SimdLevelSupported(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Scalar: return true;
+#ifdef PHYSICS2D_SIMD_X86
+        case SimdLevel::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case SimdLevel::AVX512: return __builtin_cpu_supports("avx512f");
+#endif
+#ifdef PHYSICS2D_SIMD_NEON
+        case SimdLevel::NEON: return true;
+#endif
+        default: return false;
+    }
+}
+
+SimdLevel DetectSimdLevel() {
+    static const SimdLevel detected = [] {
+        if (SimdLevelSupported(SimdLevel::AVX512)) return SimdLevel::AVX512;
+        if (SimdLevelSupported(SimdLevel::AVX2)) return SimdLevel::AVX2;
+        if (SimdLevelSupported(SimdLevel::NEON)) return SimdLevel::NEON;
+        return SimdLevel::Scalar;
+    }();
+    return detected;
+}
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::NEON: return "NEON";
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+        default: return "Scalar";
+    }
+}
+
+int SimdLevelWidth(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::NEON: return 4;
+        case SimdLevel::AVX2: return 8;
+        case SimdLevel::AVX512: return 16;
+        default: return 1;
+    }
+}
+
+namespace {
+
+void Dispatch(const KernelInput& in, size_t begin, size_t end, SimdLevel level) {
+    // 当前CPU不支持所请求的指令集时退回标量
+    if (!SimdLevelSupported(level)) level = SimdLevel::Scalar;
+
+    size_t i = begin;
+    switch (level) {
+#ifdef PHYSICS2D_SIMD_X86
+        case SimdLevel::AVX2: i = AccumulateAVX2(in, begin, end); break;
+        case SimdLevel::AVX512: i = AccumulateAVX512(in, begin, end); break;
+#endif
+#ifdef PHYSICS2D_SIMD_NEON
+        case SimdLevel::NEON: i = AccumulateNEON(in, begin, end); break;
+#endif
+        default: break;
+    }
+    AccumulateScalar(in, i, end);
+}
+
+}
+
+void ApplyFusedForces(BodyStore& bodies, size_t begin, size_t end, const FusedForceParams& params, SimdLevel level) {
+    const size_t n = bodies.size();
+    end = std::min(end, n);
+    if (begin >= end || n < 2) return;
+
+    if (!params.gravity && !params.coulomb) return;
+
+    const KernelInput in {
+        bodies.x.data(), bodies.y.data(), bodies.mass.data(), bodies.charge.data(), bodies.invMass.data(),
+        bodies.flags.data(), bodies.ax.data(), bodies.ay.data(), 0, n,
+        params.softening * params.softening,
+        params.gravity ? static_cast<float>(G) : 0.0f,
+        params.coulomb ? static_cast<float>(K) : 0.0f,
+    };
+    Dispatch(in, begin, end, level);
+}
+
+void ApplyFusedForcesRange(const ForceArrays& arrays, size_t begin, size_t end, size_t sourceBegin, size_t sourceEnd,
+                           const FusedForceParams& params, SimdLevel level) {
+    if (begin >= end || sourceBegin >= sourceEnd || (!params.gravity && !params.coulomb)) return;
+
+    const KernelInput in {
+        arrays.x, arrays.y, arrays.mass, arrays.charge, arrays.invMass, arrays.flags, arrays.ax, arrays.ay,
+        sourceBegin, sourceEnd,
+        params.softening * params.softening,
+        params.gravity ? static_cast<float>(G) : 0.0f,
+        params.coulomb ? static_cast<float>(K) : 0.0f,
+    };
+    Dispatch(in, begin, end, level);
+}
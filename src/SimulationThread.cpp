@@ -0,0 +1,271 @@
+#include "../include/SimulationThread.h"
+#include "../include/Snapshot.h"
+#include "../include/Profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+
+namespace {
+
+constexpr double MAX_IDLE_SECONDS = 0.05;  // 暂停时也定期醒来检查退出
+
+void CopyStatus(char (&out)[320], const std::string& status) {
+    std::snprintf(out, sizeof(out), "%s", status.c_str());
+}
+
+}
+
+bool CommandTargetsBody(CommandType type) {
+    switch (type) {
+        case CommandType::RemoveObject:
+        case CommandType::SetPosition:
+        case CommandType::SetVelocity:
+        case CommandType::SetMass:
+        case CommandType::SetCharge:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool CommandChangesLayout(CommandType type) {
+    switch (type) {
+        case CommandType::AddCircle:
+        case CommandType::AddPolygon:
+        case CommandType::RemoveObject:
+        case CommandType::ClearWorld:
+            return true;
+        default:
+            return false;
+    }
+}
+
+double SimulationThread::now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SimulationThread::start(float scale) {
+    if (thread.joinable()) return;
+    timeScale = scale;
+    stopping.store(false, std::memory_order_relaxed);
+    thread = std::thread([this] { run(); });
+}
+
+void SimulationThread::stop() {
+    if (!thread.joinable()) return;
+    stopping.store(true, std::memory_order_release);
+    {
+        std::lock_guard lock(wakeMutex);
+        pending = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
+
+void SimulationThread::submit(const SimulationCommand& command) {
+    while (!commands.push(command)) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard lock(wakeMutex);
+        pending = true;
+    }
+    wake.notify_one();
+}
+
+void SimulationThread::run() {
+    double last = now();
+    float stepMilliseconds = 0.0f;
+    bool dirty = true;  // 启动后先发布一帧
+    while (!stopping.load(std::memory_order_acquire)) {
+        dirty |= execute();
+
+        const double time = now();
+        const int steps = world.clock.advance(static_cast<float>((time - last) * timeScale));
+        last = time;
+        if (steps > 0) {
+            PROFILE_ZONE("Physics");
+            for (int step = 0; step < steps; step++) {
+                world.step(world.clock.getFixedDeltaTime());
+            }
+            stepMilliseconds = static_cast<float>((now() - time) * 1e3 / steps);
+        }
+        if (steps > 0 || dirty) {
+            // 插值系数对应time时刻的累积时间，界面从publishTime起继续外推
+            publish(time, stepMilliseconds);
+            dirty = false;
+        }
+
+        // 睡到下一步到期，有新命令时提前醒来
+        double wait = MAX_IDLE_SECONDS;
+        if (timeScale > 0.0f) {
+            const double due = (world.clock.getFixedDeltaTime() - world.clock.getAccumulator()) / timeScale;
+            wait = std::clamp(due - (now() - time), 0.0, MAX_IDLE_SECONDS);
+        }
+        std::unique_lock lock(wakeMutex);
+        if (!pending && wait > 0.0) {
+            wake.wait_for(lock, std::chrono::duration<double>(wait), [this] { return pending; });
+        }
+        pending = false;
+    }
+}
+
+bool SimulationThread::execute() {
+    bool executed = false;
+    SimulationCommand command;
+    while (commands.pop(command)) {
+        execute(command);
+        executed = true;
+    }
+    return executed;
+}
+
+void SimulationThread::execute(const SimulationCommand& command) {
+    switch (command.request) {
+        case SimulationRequest::World:
+            // 界面发出命令之后物体已被增删：下标可能指向另一个物体，丢弃（也不记入日志）
+            if (CommandTargetsBody(command.command.type) && command.layoutRevision != layoutRevision) break;
+            // 时间缩放只决定每帧的步数，由这里处理；仍经日志记录
+            if (command.command.type == CommandType::SetTimeScale) {
+                timeScale = std::max(0.0f, static_cast<float>(command.command.values[0]));
+            }
+            journal.submit(world, command.command);
+            if (CommandChangesLayout(command.command.type)) layoutRevision++;
+            break;
+        case SimulationRequest::SaveSnapshot:
+            snapshotStatus = SaveSnapshot(world, command.path)
+                ? "Saved " + std::to_string(world.bodies.size()) + " bodies"
+                : std::string("Cannot write ") + command.path;
+            break;
+        case SimulationRequest::LoadSnapshot: {
+            std::string error;
+            if (LoadSnapshot(world, command.path, error)) {
+                // 整个世界被替换，录制中的日志无法继续
+                journal.stop();
+                revision++;
+                layoutRevision++;
+                snapshotStatus = "Loaded " + std::to_string(world.bodies.size()) + " bodies at step " +
+                                 std::to_string(world.stepIndex);
+            } else {
+                snapshotStatus = error;
+            }
+            break;
+        }
+        case SimulationRequest::StartRecording:
+            journal.start(world);
+            journalStatus = "Recording from step " + std::to_string(world.stepIndex);
+            break;
+        case SimulationRequest::StopRecording:
+            if (!journal.isRecording()) break;
+            journal.stop();
+            journalStatus = journal.save(world, command.path)
+                ? "Saved, replay with 2DPhysics-headless --replay " + std::string(command.path)
+                : std::string("Cannot write ") + command.path;
+            break;
+        case SimulationRequest::AccuracyReport: {
+            reportCount = 0;
+            for (float theta : { 0.3f, 0.5f, 0.7f, 1.0f, world.barnesHutTheta }) {
+                reports[reportCount++] = MeasureBarnesHutAccuracy(world.bodies, theta);
+            }
+            break;
+        }
+    }
+}
+
+void SimulationThread::publish(double time, float stepMilliseconds) {
+    PROFILE_ZONE("Publish");
+    SimulationFrame& frame = frames.back();
+    // 槽位里是两次发布之前的数据，赋值沿用已有容量
+    frame.bodies = world.bodies;
+    pack(frame);
+
+    frame.stepIndex = world.stepIndex;
+    frame.alpha = world.clock.getAlpha();
+    frame.publishTime = time;
+    frame.settings = ReadWorldSettings(world, timeScale);
+    frame.revision = revision;
+    frame.layoutRevision = layoutRevision;
+    frame.simdLevel = world.simdLevel;
+
+    frame.lastSteps = world.clock.getLastSteps();
+    frame.droppedTime = world.clock.getDroppedTime();
+    frame.stepMilliseconds = stepMilliseconds;
+    frame.pairs = world.pairCount;
+    frame.broadphaseStats = world.broadphase->stats();
+    frame.treeHeight = world.broadphaseType == BroadphaseType::AabbTree
+        ? static_cast<const AabbTreeBroadphase&>(*world.broadphase).tree().tree().height() : 0;
+    frame.arenaBytes = world.frameArena.lastFrameBytes();
+    frame.arenaCapacity = world.frameArena.capacity();
+    frame.sleeping = world.islands.sleepingCount();
+    frame.islands = world.islands.islandCount();
+    frame.contacts = world.contactSolver.contactCount();
+    frame.fastBodies = world.continuous.fastBodyCount();
+    frame.impacts = world.continuous.impactCount();
+    frame.steals = world.pool.stealCount();
+    frame.quadTreeNodes = world.gravityTree.nodeCount();
+    frame.fmmNodes = world.fmm.nodeCount();
+    frame.fmmDepth = world.fmm.depth();
+    frame.fmmFarPairs = world.fmm.farPairCount();
+    frame.fmmNearPairs = world.fmm.nearPairCount();
+    frame.meshCell = world.particleMesh.cellSize();
+    frame.meshCutoff = world.particleMesh.cutoff();
+    frame.meshPairs = world.particleMesh.shortRangePairCount();
+
+    frame.recording = journal.isRecording();
+    frame.journalCommands = journal.commandCount();
+    CopyStatus(frame.snapshotStatus, snapshotStatus);
+    CopyStatus(frame.journalStatus, journalStatus);
+    std::copy(reports, reports + reportCount, frame.reports);
+    frame.reportCount = reportCount;
+
+    frames.publish();
+}
+
+// 按(形状, 分辨率)分批：先顺序统计每批的数量与每个物体的槽位，
+// 再在线程池上分块写入两步的位置与颜色，批内顺序与物体顺序一致
+void SimulationThread::pack(SimulationFrame& frame) {
+    const BodyStore& bodies = world.bodies;
+    const size_t n = bodies.size();
+
+    for (auto& [key, batch] : batches) {
+        batch.count = 0;
+    }
+    bodyBatch.resize(n);
+    RenderBatch* current = nullptr;
+    std::pair<bool, int> currentKey {};
+    for (size_t i = 0; i < n; i++) {
+        const std::pair<bool, int> key { bodies.shape[i] == SHAPE_CIRCLE, static_cast<int>(bodies.vertices[i]) };
+        if (!current || key != currentKey) {
+            current = &batches.try_emplace(key, RenderBatch { key.first, key.second, 0, 0 }).first->second;
+            currentKey = key;
+        }
+        bodyBatch[i] = current;
+        current->count++;
+    }
+
+    frame.batches.clear();
+    size_t first = 0;
+    for (auto& [key, batch] : batches) {
+        batch.first = first;
+        first += batch.count;
+        if (batch.count > 0) frame.batches.push_back(batch);
+        batch.count = 0;
+    }
+    slots.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        RenderBatch& batch = *bodyBatch[i];
+        slots[i] = static_cast<uint32_t>(batch.first + batch.count++);
+    }
+
+    frame.instances.resize(n);
+    world.pool.parallelRange(0, n, PACK_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const bool isCircle = bodies.shape[i] == SHAPE_CIRCLE;
+            const uint32_t color = bodies.isSleeping(i)
+                ? (isCircle ? RenderInstance::SLEEPING_CIRCLE_COLOR : RenderInstance::SLEEPING_POLYGON_COLOR)
+                : (isCircle ? RenderInstance::CIRCLE_COLOR : RenderInstance::POLYGON_COLOR);
+            frame.instances[slots[i]] = { bodies.prevX[i], bodies.prevY[i], bodies.x[i], bodies.y[i],
+                                          bodies.radius[i], color };
+        }
+    });
+}
@@ -0,0 +1,276 @@
+#include "../include/Snapshot.h"
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint64_t SNAPSHOT_ALIGNMENT = 64;
+constexpr char SNAPSHOT_PADDING[SNAPSHOT_ALIGNMENT] = {};
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+// 只读映射整个文件，析构时解除映射
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (data) length = static_cast<size_t>(fileSize.QuadPart);
+#else
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data = static_cast<const unsigned char*>(mapped);
+                length = static_cast<size_t>(info.st_size);
+                madvise(mapped, length, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (data) munmap(const_cast<unsigned char*>(data), length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+
+private:
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+};
+
+}
+
+bool WriteSnapshot(const World& world, std::ostream& file) {
+    const BodyStore& bodies = world.bodies;
+    const uint64_t count = bodies.size();
+
+    SnapshotHeader header {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.endianMark = SNAPSHOT_ENDIAN_MARK;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.arrayCount = BodyStore::ARRAY_COUNT;
+    header.bodyCount = count;
+    header.gravity[0] = world.gf.magnitude;
+    header.gravity[1] = world.gf.direction[0];
+    header.gravity[2] = world.gf.direction[1];
+    header.electric[0] = world.ef.magnitude;
+    header.electric[1] = world.ef.direction[0];
+    header.electric[2] = world.ef.direction[1];
+    header.aspect = world.aspect;
+    header.gravitySolver = static_cast<uint32_t>(world.gravitySolver);
+    header.barnesHutTheta = world.barnesHutTheta;
+    header.forceKernel = static_cast<uint32_t>(world.forceKernel);
+    header.fixedDeltaTime = world.clock.getFixedDeltaTime();
+    header.maxSubsteps = world.clock.getMaxSubsteps();
+    header.accumulator = world.clock.getAccumulator();
+    header.stepCount = world.clock.getStepCount();
+    header.droppedTime = world.clock.getDroppedTime();
+    header.stepIndex = world.stepIndex;
+    header.integrator = static_cast<uint32_t>(world.integrator);
+
+    const std::vector<ContactImpulse>& impulses = world.contactSolver.cachedImpulses();
+    header.impulseCount = static_cast<uint32_t>(impulses.size());
+
+    // 先确定每个数组的偏移，再依次写出
+    std::vector<SnapshotArray> table;
+    uint64_t offset = AlignUp(sizeof(SnapshotHeader) + BodyStore::ARRAY_COUNT * sizeof(SnapshotArray));
+    bodies.forEachArray([&](const auto& array) {
+        const uint32_t elementSize = sizeof(array[0]);
+        table.push_back({ offset, elementSize, 0 });
+        offset = AlignUp(offset + count * elementSize);
+    });
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(SnapshotArray));
+
+    uint64_t written = sizeof(header) + table.size() * sizeof(SnapshotArray);
+    size_t arrayIndex = 0;
+    bodies.forEachArray([&](const auto& array) {
+        const SnapshotArray& entry = table[arrayIndex++];
+        file.write(SNAPSHOT_PADDING, static_cast<std::streamsize>(entry.offset - written));
+        file.write(reinterpret_cast<const char*>(array.data()), static_cast<std::streamsize>(count * entry.elementSize));
+        written = entry.offset + count * entry.elementSize;
+    });
+
+    file.write(SNAPSHOT_PADDING, static_cast<std::streamsize>(offset - written));
+    file.write(reinterpret_cast<const char*>(impulses.data()),
+               static_cast<std::streamsize>(impulses.size() * sizeof(ContactImpulse)));
+    return static_cast<bool>(file);
+}
+
+bool SaveSnapshot(const World& world, const std::string& path) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    return file && WriteSnapshot(world, file);
+}
+
+bool LoadSnapshot(World& world, const std::string& path, std::string& error) {
+    MappedFile file(path);
+    if (!file.data) {
+        error = "cannot open " + path;
+        return false;
+    }
+    return ReadSnapshot(world, file.data, file.length, path, error);
+}
+
+bool ReadSnapshot(World& world, const unsigned char* data, size_t length, const std::string& path, std::string& error) {
+    // 先读各版本共有的部分，确定版本后再读完整的文件头
+    SnapshotHeader header {};
+    if (length < SNAPSHOT_V3_HEADER_SIZE) {
+        error = path + ": file too small for a snapshot header";
+        return false;
+    }
+    std::memcpy(&header, data, SNAPSHOT_V3_HEADER_SIZE);
+
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        error = path + ": not a snapshot file";
+        return false;
+    }
+    if (header.endianMark != SNAPSHOT_ENDIAN_MARK) {
+        error = path + ": snapshot was written with a different byte order";
+        return false;
+    }
+    const size_t headerSize = header.version >= 4 ? sizeof(SnapshotHeader) : SNAPSHOT_V3_HEADER_SIZE;
+    if (header.version < 1 || header.version > SNAPSHOT_VERSION || header.headerSize != headerSize) {
+        error = path + ": unsupported snapshot version " + std::to_string(header.version);
+        return false;
+    }
+    if (length < headerSize) {
+        error = path + ": file too small for a snapshot header";
+        return false;
+    }
+    std::memcpy(&header, data, headerSize);
+    // 新版本只在末尾追加数组，旧文件缺少的数组读取时补零
+    if (header.arrayCount != SNAPSHOT_ARRAY_COUNTS[header.version - 1]) {
+        error = path + ": snapshot has " + std::to_string(header.arrayCount) + " arrays, expected " +
+                std::to_string(SNAPSHOT_ARRAY_COUNTS[header.version - 1]);
+        return false;
+    }
+
+    const uint64_t tableEnd = headerSize + header.arrayCount * sizeof(SnapshotArray);
+    if (length < tableEnd) {
+        error = path + ": truncated array table";
+        return false;
+    }
+    std::vector<SnapshotArray> table(header.arrayCount);
+    std::memcpy(table.data(), data + headerSize, table.size() * sizeof(SnapshotArray));
+
+    const uint64_t count = header.bodyCount;
+    bool valid = true;
+    size_t arrayIndex = 0;
+    uint64_t arraysEnd = tableEnd;
+    world.bodies.forEachArray([&](auto& array) {
+        if (arrayIndex == table.size()) return;
+        const SnapshotArray& entry = table[arrayIndex++];
+        if (entry.elementSize != sizeof(array[0]) || entry.offset < tableEnd ||
+            entry.offset > length || count > (length - entry.offset) / entry.elementSize) {
+            valid = false;
+            return;
+        }
+        arraysEnd = std::max(arraysEnd, entry.offset + count * entry.elementSize);
+    });
+    if (!valid) {
+        error = path + ": array table does not match the body layout or the file is truncated";
+        return false;
+    }
+
+    const uint64_t impulseCount = header.version >= 3 ? header.impulseCount : 0;
+    const uint64_t impulseOffset = AlignUp(arraysEnd);
+    if (impulseCount > 0 && (impulseOffset > length || impulseCount > (length - impulseOffset) / sizeof(ContactImpulse))) {
+        error = path + ": contact impulse cache is truncated";
+        return false;
+    }
+
+    // 验证全部通过后才修改世界
+    world.clear();
+    arrayIndex = 0;
+    world.bodies.forEachArray([&](auto& array) {
+        array.assign(count, {});
+        if (arrayIndex == table.size()) return;
+        std::memcpy(array.data(), data + table[arrayIndex++].offset, count * sizeof(array[0]));
+    });
+
+    // 形状标签决定窄相查表的下标，必须先检查
+    for (size_t i = 0; i < count; i++) {
+        if (world.bodies.shape[i] >= SHAPE_TYPE_COUNT ||
+            (world.bodies.shape[i] == SHAPE_POLYGON &&
+             (world.bodies.vertices[i] < 3 || world.bodies.vertices[i] > MAX_POLYGON_SIDES))) {
+            world.clear();
+            error = path + ": invalid shape for body " + std::to_string(i);
+            return false;
+        }
+    }
+    world.rebuildObjects();
+
+    std::vector<ContactImpulse> impulses(impulseCount);
+    if (impulseCount > 0) {
+        std::memcpy(impulses.data(), data + impulseOffset, impulseCount * sizeof(ContactImpulse));
+    }
+    world.contactSolver.restoreImpulses(impulses.data(), impulses.size());
+
+    world.gf.magnitude = header.gravity[0];
+    world.gf.direction[0] = header.gravity[1];
+    world.gf.direction[1] = header.gravity[2];
+    world.gf.direction[2] = 0.0;
+    world.ef.magnitude = header.electric[0];
+    world.ef.direction[0] = header.electric[1];
+    world.ef.direction[1] = header.electric[2];
+    world.ef.direction[2] = 0.0;
+    world.syncFields();
+    world.aspect = header.aspect;
+
+    world.gravitySolver = header.gravitySolver <= static_cast<uint32_t>(GravitySolver::ParticleMesh)
+        ? static_cast<GravitySolver>(header.gravitySolver) : GravitySolver::Exact;
+    world.barnesHutTheta = header.barnesHutTheta;
+    world.forceKernel = header.forceKernel == static_cast<uint32_t>(ForceKernel::Scalar)
+        ? ForceKernel::Scalar : ForceKernel::Simd;
+    // 版本4之前的文件为0，即半隐式欧拉
+    world.integrator = header.integrator < static_cast<uint32_t>(INTEGRATOR_COUNT)
+        ? static_cast<Integrator>(header.integrator) : Integrator::SemiImplicitEuler;
+
+    world.clock.setFixedDeltaTime(header.fixedDeltaTime);
+    world.clock.setMaxSubsteps(header.maxSubsteps);
+    world.clock.restore(header.accumulator, header.stepCount, header.droppedTime);
+    world.stepIndex = header.stepIndex;
+    return true;
+}
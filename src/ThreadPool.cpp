@@ -0,0 +1,203 @@
+#include "../include/ThreadPool.h"
+
+namespace {
+
+// 当前线程所属的线程池与队列编号；不属于任何线程池的线程（主线程）使用0号队列
+thread_local const ThreadPool* tlsPool = nullptr;
+thread_local unsigned tlsSlot = 0;
+
+constexpr int64_t QUEUE_MASK = static_cast<int64_t>(ThreadPool::QUEUE_CAPACITY) - 1;
+constexpr int IDLE_ROUNDS = 64;  // 找不到任务时先让出时间片的次数，之后才睡眠
+
+}
+
+// Chase-Lev双端队列（固定容量，Lê等人的C11内存序版本）：只有所有者在bottom端push/pop，
+// 其它线程在top端steal，三者只在最后一个条目上用CAS竞争。
+// 条目本身也用release/acquire读写，窃取者因此能看到提交前写入的任务内容（x86上没有额外开销）
+bool ThreadPool::WorkQueue::push(PoolTask* task) {
+    const int64_t b = bottom.load(std::memory_order_relaxed);
+    const int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= static_cast<int64_t>(QUEUE_CAPACITY)) return false;
+    entries[b & QUEUE_MASK].store(task, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return true;
+}
+
+PoolTask* ThreadPool::WorkQueue::pop() {
+    const int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    PoolTask* task = entries[b & QUEUE_MASK].load(std::memory_order_relaxed);
+    if (t == b) {
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            task = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+PoolTask* ThreadPool::WorkQueue::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+    PoolTask* task = entries[t & QUEUE_MASK].load(std::memory_order_acquire);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return task;
+}
+
+void ThreadPool::resize(unsigned threads) {
+    threads = std::max(threads, 1u);
+    if (threads == slotCount) return;
+
+    stop();
+    stopping.store(false, std::memory_order_relaxed);
+    slotCount = threads;
+    queues = std::make_unique<WorkQueue[]>(threads);
+    for (unsigned slot = 1; slot < threads; slot++) {
+        workers.emplace_back([this, slot] { workerLoop(slot); });
+    }
+}
+
+unsigned ThreadPool::currentSlot() const {
+    return tlsPool == this ? tlsSlot : 0;
+}
+
+void ThreadPool::run(PoolTask& task) {
+    const unsigned slot = currentSlot();
+    submit(task, slot);
+    helpUntilZero(task.remaining, slot);
+}
+
+void ThreadPool::run(TaskGraph& graph) {
+    const size_t nodes = graph.tasks.size();
+    if (nodes == 0) return;
+
+    // 由边表整理出后继表与前驱计数
+    graph.successorStart.assign(nodes + 1, 0);
+    graph.waiting.assign(nodes, 0);
+    for (const auto& [before, after] : graph.edges) {
+        graph.successorStart[before + 1]++;
+        graph.waiting[after]++;
+    }
+    for (size_t i = 0; i < nodes; i++) {
+        graph.successorStart[i + 1] += graph.successorStart[i];
+    }
+    graph.successors.resize(graph.edges.size());
+    for (const auto& [before, after] : graph.edges) {
+        graph.successors[graph.successorStart[before]++] = after;
+    }
+    for (size_t i = nodes; i > 0; i--) {
+        graph.successorStart[i] = graph.successorStart[i - 1];
+    }
+    graph.successorStart[0] = 0;
+    graph.unfinished = nodes;
+    for (PoolTask& task : graph.tasks) {
+        task.nextChunk = 0;
+        task.remaining = task.chunks;
+    }
+
+    // 没有前驱的节点按逆序入队，单线程时按添加顺序从队尾取出
+    const unsigned slot = currentSlot();
+    for (size_t i = nodes; i > 0; i--) {
+        if (graph.waiting[i - 1] == 0) submit(graph.tasks[i - 1], slot);
+    }
+    helpUntilZero(graph.unfinished, slot);
+}
+
+void ThreadPool::submit(PoolTask& task, unsigned slot) {
+    if (task.chunks == 0) {
+        if (task.graph) finish(*task.graph, task.node, slot);
+        return;
+    }
+    // 每个条目领取一块；队列满时直接在当前线程执行
+    for (size_t k = 0; k < task.chunks; k++) {
+        if (!queues[slot].push(&task)) execute(&task, slot);
+    }
+    epoch.fetch_add(1, std::memory_order_release);
+    epoch.notify_all();
+}
+
+void ThreadPool::execute(PoolTask* task, unsigned slot) {
+    const size_t chunk = std::atomic_ref<size_t>(task->nextChunk).fetch_add(1, std::memory_order_relaxed);
+    const size_t first = task->begin + chunk * task->grain;
+    task->invoke(task->target, first, std::min(task->end, first + task->grain));
+
+    // 任务完成后等待者可能立即销毁它，先取出所属的图
+    TaskGraph* graph = task->graph;
+    const uint32_t node = task->node;
+    if (std::atomic_ref<size_t>(task->remaining).fetch_sub(1, std::memory_order_acq_rel) == 1 && graph) {
+        finish(*graph, node, slot);
+    }
+}
+
+void ThreadPool::finish(TaskGraph& graph, uint32_t node, unsigned slot) {
+    for (uint32_t e = graph.successorStart[node]; e < graph.successorStart[node + 1]; e++) {
+        const uint32_t next = graph.successors[e];
+        if (std::atomic_ref<uint32_t>(graph.waiting[next]).fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            submit(graph.tasks[next], slot);
+        }
+    }
+    // 最后一次访问图：计数归零后run返回
+    std::atomic_ref<size_t>(graph.unfinished).fetch_sub(1, std::memory_order_acq_rel);
+}
+
+PoolTask* ThreadPool::findWork(unsigned slot) {
+    if (PoolTask* task = queues[slot].pop()) return task;
+    for (unsigned k = 1; k < slotCount; k++) {
+        if (PoolTask* task = queues[(slot + k) % slotCount].steal()) {
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::helpUntilZero(size_t& counter, unsigned slot) {
+    while (std::atomic_ref<size_t>(counter).load(std::memory_order_acquire) != 0) {
+        if (PoolTask* task = findWork(slot)) {
+            execute(task, slot);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ThreadPool::workerLoop(unsigned slot) {
+    tlsPool = this;
+    tlsSlot = slot;
+    int idle = 0;
+    while (true) {
+        // 先读epoch再找任务：找不到时若已有新提交，wait立即返回
+        const uint32_t seen = epoch.load(std::memory_order_acquire);
+        if (stopping.load(std::memory_order_acquire)) return;
+        if (PoolTask* task = findWork(slot)) {
+            execute(task, slot);
+            idle = 0;
+        } else if (++idle < IDLE_ROUNDS) {
+            std::this_thread::yield();
+        } else {
+            epoch.wait(seen, std::memory_order_acquire);
+            idle = 0;
+        }
+    }
+}
+
+void ThreadPool::stop() {
+    stopping.store(true, std::memory_order_release);
+    epoch.fetch_add(1, std::memory_order_release);
+    epoch.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+    workers.clear();
+}
@@ -0,0 +1,249 @@
+#include "../include/World.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+
+namespace {
+
+// 任务图中区间节点每块的大小：合并内核每个目标都要遍历全部源，按16个目标一组计数
+constexpr size_t FORCE_GROUPS_PER_CHUNK = 16;
+constexpr size_t BODIES_PER_CHUNK = 1024;
+
+}
+
+World::World() : broadphase(CreateBroadphase(broadphaseType)) {
+    gf.magnitude = 9.8;
+    gf.direction[0] = 0.0;
+    gf.direction[1] = -1.0;
+    gf.direction[2] = 0.0;
+
+    ef.magnitude = 0.0;
+    ef.direction[0] = 1.0;
+    ef.direction[1] = 0.0;
+    ef.direction[2] = 0.0;
+}
+
+Circle& World::addCircle(float x, float y, float radius, float mass, float charge, bool movable, int resolution) {
+    auto circle = std::make_unique<Circle>(bodies, x, y, radius, resolution, movable);
+    circle->setMass(mass);
+    circle->setCharge(charge);
+    Circle& ref = *circle;
+    objects.emplace_back(std::move(circle));
+    return ref;
+}
+
+polygon& World::addPolygon(int sides, float radius, float x, float y, float mass, float charge, bool movable) {
+    // 窄相的形状表只覆盖[3, MAX_POLYGON_SIDES]条边
+    sides = std::clamp(sides, 3, static_cast<int>(MAX_POLYGON_SIDES));
+    auto poly = std::make_unique<polygon>(bodies, sides, radius, x, y, movable);
+    poly->setMass(mass);
+    poly->setCharge(charge);
+    polygon& ref = *poly;
+    objects.emplace_back(std::move(poly));
+    return ref;
+}
+
+void World::removeObject(size_t index) {
+    // 被删除的物体可能正支撑着休眠的堆
+    bodies.remove(index);
+    bodies.wakeAll();
+    contactSolver.reset();
+    objects.erase(objects.begin() + index);
+    for (size_t i = index; i < objects.size(); i++) {
+        objects[i]->setIndex(i);
+    }
+}
+
+void World::clear() {
+    objects.clear();
+    bodies.clear();
+    contactSolver.reset();
+    stepIndex = 0;
+}
+
+void World::rebuildObjects() {
+    objects.clear();
+    contactSolver.reset();
+    objects.reserve(bodies.size());
+    for (size_t i = 0; i < bodies.size(); i++) {
+        if (bodies.shape[i] == SHAPE_POLYGON) {
+            objects.emplace_back(std::make_unique<polygon>(bodies, i));
+        } else {
+            objects.emplace_back(std::make_unique<Circle>(bodies, i));
+        }
+    }
+}
+
+bool World::syncFields() {
+    const float fields[4] = {
+        static_cast<float>(gf.magnitude * gf.direction[0]), static_cast<float>(gf.magnitude * gf.direction[1]),
+        static_cast<float>(ef.magnitude * ef.direction[0]), static_cast<float>(ef.magnitude * ef.direction[1]),
+    };
+    if (std::equal(fields, fields + 4, lastFields)) return false;
+    std::copy(fields, fields + 4, lastFields);
+    return true;
+}
+
+void World::step(float dt) {
+    PROFILE_ZONE("Step");
+    bodies.savePreviousPositions();
+
+    if (syncFields()) {
+        bodies.wakeAll();
+    }
+
+    // 各阶段是任务图中的节点，按数据依赖连接：互不依赖的节点（建树与库仑力、粗检测与边界接触）同时执行，
+    // 区间节点分块后由空闲线程领取或窃取，FMM、PM与接触求解在节点内部再嵌套并行。
+    // 每块只写自己负责的物体或槽位（标量两两力按固定的组累加），结果与线程数无关
+    const size_t n = bodies.size();
+    const bool treeGravity = gravitySolver == GravitySolver::BarnesHut;
+    FusedForceParams params = fusedForces;
+    params.gravity = !treeGravity;
+    // 电荷在一步内不变，全为0时每步只判断一次，不必在每个分块里重复扫描
+    params.coulomb = fusedForces.coulomb &&
+        std::any_of(bodies.charge.begin(), bodies.charge.end(), [](float q) { return q != 0.0f; });
+
+    auto noForces = [] {};
+    auto fmmForces = [&] {
+        // 引力与库仑力都由多极展开计算，近场仍用合并内核
+        PROFILE_ZONE("Gravity + Coulomb (FMM)");
+        fmm.apply(bodies, pool, fusedForces, simdLevel);
+    };
+    auto meshForces = [&] {
+        // 长程部分在网格上用FFT求解，P3M时近邻再直接修正
+        PROFILE_ZONE("Gravity + Coulomb (PM)");
+        particleMesh.apply(bodies, pool, fusedForces);
+    };
+    auto buildTree = [&] {
+        PROFILE_ZONE("Build quadtree");
+        gravityTree.build(bodies);
+    };
+    auto treeForces = [&](size_t first, size_t last) {
+        PROFILE_ZONE("Gravity (Barnes-Hut)");
+        ApplyBarnesHutRange(bodies, gravityTree, barnesHutTheta, first, last);
+    };
+    // 按16个目标一组分块，避免中间的块落到标量尾部
+    auto fusedChunk = [&](size_t first, size_t last) {
+        PROFILE_ZONE("Gravity + Coulomb (fused)");
+        ApplyFusedForces(bodies, first * 16, std::min(n, last * 16), params, simdLevel);
+    };
+    auto pairwiseForces = [&] {
+        PROFILE_ZONE("Pairwise forces");
+        ApplyPairwiseForcesParallel(bodies, pool, forceBuffers, !treeGravity, true);
+    };
+    const IntegrationParams integration = MakeIntegrationParams(dt, gf, ef, aspect, contactSolver.settings.restitution,
+                                                                !contactSolver.settings.enabled);
+    integratorScratch.prepare(integrator, n);
+    auto beginIntegration = [&](size_t first, size_t last) {
+        PROFILE_ZONE("Integrate");
+        BeginIntegrationRange(integrator, bodies, integratorScratch, integration, first, last);
+    };
+    auto makeStage = [&](int stage) {
+        return [&, stage](size_t first, size_t last) {
+            PROFILE_ZONE("Integrate");
+            IntegrationStageRange(integrator, stage, bodies, integratorScratch, integration, first, last);
+        };
+    };
+    decltype(makeStage(0)) integrationStages[] = { makeStage(0), makeStage(1), makeStage(2), makeStage(3) };
+    auto sweep = [&] {
+        PROFILE_ZONE("CCD");
+        continuous.apply(bodies, dt, aspect, contactSolver.settings.restitution, frameArena.resource());
+    };
+    auto findPairs = [&] {
+        PROFILE_ZONE("Broadphase");
+        // 按上一步的数量预留，arena中的列表不会反复倍增
+        collisionPairs.reserve(pairCount);
+        broadphase->findPairs(bodies, collisionPairs);
+        // 各粗检测的输出顺序不同，排序扫掠与AABB树还取决于跨帧保留的状态（快照与日志都不保存）；
+        // 按(a, b)排序后，逐对碰撞与接触求解的顺序只取决于配对本身，回放与续跑才能逐位一致
+        std::sort(collisionPairs.begin(), collisionPairs.end(), [](const BroadphasePair& l, const BroadphasePair& r) {
+            return l.a != r.a ? l.a < r.a : l.b < r.b;
+        });
+        pairCount = collisionPairs.size();
+    };
+    auto wallContacts = [&] {
+        PROFILE_ZONE("Wall contacts");
+        contactSolver.findWallContacts(bodies, aspect);
+    };
+    auto solveContacts = [&] {
+        PROFILE_ZONE("Contact Solver");
+        contacts.reserve(collisionPairs.size());
+        contactSolver.solve(bodies, collisionPairs, dt, aspect, pool, contacts, frameArena.resource());
+    };
+    auto narrowphase = [&] {
+        // 逐对碰撞会立即修改物体，必须按配对顺序执行。
+        // 两端都不需要更新（休眠或静止）的配对跳过窄相；两端都休眠时仍记为接触，保持休眠堆连成一个岛
+        PROFILE_ZONE("Narrowphase");
+        contacts.clear();
+        contacts.reserve(collisionPairs.size());
+        for (const BroadphasePair& pair : collisionPairs) {
+            if (!bodies.isAwake(pair.a) && !bodies.isAwake(pair.b)) {
+                if (bodies.isSleeping(pair.a) && bodies.isSleeping(pair.b)) contacts.push_back(pair);
+                continue;
+            }
+            if (CollidePair(bodies, pair.a, pair.b)) contacts.push_back(pair);
+        }
+    };
+    auto updateIslands = [&] {
+        PROFILE_ZONE("Islands");
+        islands.update(bodies, contacts, sleep, dt);
+    };
+
+    stepGraph.clear();
+    // 作用力：树遍历与库仑力都写ax/ay，各自对每个物体只加一次，
+    // 因此建树可以与库仑力同时进行，遍历放在两者之后，结果与先引力后库仑力相同。
+    // 每次求力接在上一个积分阶段之后（第一次可能没有前驱），返回最后一个节点
+    auto addForces = [&](const TaskGraph::NodeId* after) {
+        auto follow = [&](TaskGraph::NodeId node) {
+            if (after) stepGraph.precede(*after, node);
+            return node;
+        };
+        if (n == 0) return follow(stepGraph.add(noForces));
+        if (gravitySolver == GravitySolver::Fmm) return follow(stepGraph.add(fmmForces));
+        if (gravitySolver == GravitySolver::ParticleMesh) return follow(stepGraph.add(meshForces));
+
+        const TaskGraph::NodeId forces = follow(forceKernel == ForceKernel::Simd
+            ? stepGraph.addRange(0, (n + 15) / 16, FORCE_GROUPS_PER_CHUNK, fusedChunk)
+            : stepGraph.add(pairwiseForces));
+        if (!treeGravity) return forces;
+        const TaskGraph::NodeId tree = follow(stepGraph.add(buildTree));
+        const TaskGraph::NodeId traverse = stepGraph.addRange(0, n, BODIES_PER_CHUNK, treeForces);
+        stepGraph.precede(tree, traverse);
+        stepGraph.precede(forces, traverse);
+        return traverse;
+    };
+
+    // 积分：可选的起始阶段，之后每个阶段之前求一次作用力
+    TaskGraph::NodeId integrated = 0;
+    const bool hasBegin = IntegratorHasBegin(integrator);
+    if (hasBegin) integrated = stepGraph.addRange(0, n, BODIES_PER_CHUNK, beginIntegration);
+    for (int stage = 0; stage < IntegratorStages(integrator); stage++) {
+        const TaskGraph::NodeId forces = addForces(stage > 0 || hasBegin ? &integrated : nullptr);
+        integrated = stepGraph.addRange(0, n, BODIES_PER_CHUNK, integrationStages[stage]);
+        stepGraph.precede(forces, integrated);
+    }
+
+    const TaskGraph::NodeId swept = stepGraph.add(sweep);
+    const TaskGraph::NodeId paired = stepGraph.add(findPairs);
+    stepGraph.precede(integrated, swept);
+    stepGraph.precede(swept, paired);
+
+    TaskGraph::NodeId resolved;
+    if (contactSolver.settings.enabled) {
+        const TaskGraph::NodeId walls = stepGraph.add(wallContacts);
+        resolved = stepGraph.add(solveContacts);
+        stepGraph.precede(swept, walls);
+        stepGraph.precede(walls, resolved);
+    } else {
+        resolved = stepGraph.add(narrowphase);
+    }
+    stepGraph.precede(paired, resolved);
+    stepGraph.precede(resolved, stepGraph.add(updateIslands));
+
+    pool.run(stepGraph);
+
+    // 先交还arena中的列表（分配器相同，移动赋值直接接管空缓冲区），再整体回收
+    collisionPairs = PairList(frameArena.resource());
+    contacts = PairList(frameArena.resource());
+    frameArena.reset();
+    stepIndex++;
+}
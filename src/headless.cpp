@@ -0,0 +1,249 @@
+#include <print>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include "../include/World.h"
+#include "../include/Scene.h"
+#include "../include/Snapshot.h"
+#include "../include/Journal.h"
+#include "../include/Profiler.h"
+#include "../include/AllocationCounter.h"
+
+// 无界面批量模拟：读取场景或快照，以固定dt尽快步进N步，写出最终状态
+// 回放录制的日志，结果散列与录制时一致返回0
+static int RunReplay(const std::string& path) {
+    std::string error;
+    JournalData journal;
+    if (!LoadJournal(path, journal, error)) {
+        std::println(stderr, "Error: {}", error);
+        return 1;
+    }
+
+    const SimdLevel level = static_cast<SimdLevel>(journal.header.simdLevel);
+    if (!SimdLevelSupported(level)) {
+        std::println(stderr, "Warning: journal was recorded with {} which this CPU lacks; results will differ",
+                     SimdLevelName(level));
+    }
+
+    World world;
+    ReplayResult result;
+    if (!ReplayJournal(world, journal, result, error)) {
+        std::println(stderr, "Error: {}", error);
+        return 1;
+    }
+
+    std::println("Replayed {} steps, {} commands, {} threads, {} in {:.3f} s ({:.1f} steps/s)",
+                 result.steps, journal.entries.size(), journal.header.threadCount, SimdLevelName(level),
+                 result.seconds, result.seconds > 0.0 ? result.steps / result.seconds : 0.0);
+    std::println("Final hash {:x} {} recorded {:x}", result.finalHash,
+                 result.hashMatches ? "matches" : "DIFFERS from", journal.header.finalHash);
+    return result.hashMatches ? 0 : 2;
+}
+
+static void PrintUsage() {
+    std::println("Usage: 2DPhysics-headless (--scene <file> | --snapshot <file>) [options]");
+    std::println("       2DPhysics-headless --replay <journal>");
+    std::println("  --steps <n>            number of fixed steps to run (default 1000)");
+    std::println("  --dt <seconds>         fixed step size (default 1/120)");
+    std::println("  --snapshot <file>      resume from a binary snapshot instead of a text scene");
+    std::println("  --out <file>           write the final state as a scene file");
+    std::println("  --save-snapshot <file> write the final state as a binary snapshot");
+    std::println("  --checkpoint-every <n> also write --save-snapshot every n steps");
+    std::println("  --trace <file>         write the profiler zones of the last steps as Chrome trace JSON");
+    std::println("  --replay <journal>     re-simulate a recorded journal and verify the final state hash");
+    std::println("  --gravity <solver>     exact | barnes-hut | fmm | pm (default exact; fmm and pm also compute Coulomb forces)");
+    std::println("  --theta <value>        Barnes-Hut opening angle (default 0.5)");
+    std::println("  --fmm-order <p>        FMM expansion order (default 6)");
+    std::println("  --pm-grid <n>          particle-mesh cells per side, a power of two (default 128)");
+    std::println("  --pm-no-p3m            mesh forces only, without the short-range direct correction");
+    std::println("  --pm-cic               CIC instead of TSC mesh assignment (cheaper, less accurate)");
+    std::println("  --threads <n>          threads of the work-stealing job system (default 1)");
+    std::println("  --kernel <kind>        pairwise force kernel: simd | scalar (default simd)");
+    std::println("  --integrator <method>  euler | leapfrog | yoshida4 | rk4 (default euler)");
+    std::println("  --energy               print the total energy before and after and its relative drift");
+    std::println("  --check-allocations    count heap allocations in the second half of the steps, fail if any");
+    std::println("                         (needs a build with PHYSICS2D_COUNT_ALLOCATIONS=ON)");
+}
+
+int main(int argc, char** argv) {
+    std::string scenePath;
+    std::string snapshotPath;
+    std::string outPath;
+    std::string saveSnapshotPath;
+    std::string tracePath;
+    long long checkpointEvery = 0;
+    long long steps = 1000;
+    float dt = 1.0f / 120.0f;
+    bool checkAllocations = false;
+    bool reportEnergy = false;
+
+    World world;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "--scene" && hasValue) {
+            scenePath = argv[++i];
+        } else if (arg == "--steps" && hasValue) {
+            steps = std::atoll(argv[++i]);
+        } else if (arg == "--dt" && hasValue) {
+            dt = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--replay" && hasValue) {
+            return RunReplay(argv[++i]);
+        } else if (arg == "--snapshot" && hasValue) {
+            snapshotPath = argv[++i];
+        } else if (arg == "--out" && hasValue) {
+            outPath = argv[++i];
+        } else if (arg == "--save-snapshot" && hasValue) {
+            saveSnapshotPath = argv[++i];
+        } else if (arg == "--checkpoint-every" && hasValue) {
+            checkpointEvery = std::atoll(argv[++i]);
+        } else if (arg == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        } else if (arg == "--gravity" && hasValue) {
+            const std::string solver = argv[++i];
+            if (solver == "exact") {
+                world.gravitySolver = GravitySolver::Exact;
+            } else if (solver == "barnes-hut") {
+                world.gravitySolver = GravitySolver::BarnesHut;
+            } else if (solver == "fmm") {
+                world.gravitySolver = GravitySolver::Fmm;
+            } else if (solver == "pm") {
+                world.gravitySolver = GravitySolver::ParticleMesh;
+            } else {
+                std::println(stderr, "Unknown gravity solver: {}", solver);
+                return 1;
+            }
+        } else if (arg == "--theta" && hasValue) {
+            world.barnesHutTheta = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--fmm-order" && hasValue) {
+            world.fmm.settings.order = std::clamp(std::atoi(argv[++i]), 1, FmmSolver::MAX_ORDER);
+        } else if (arg == "--pm-grid" && hasValue) {
+            world.particleMesh.settings.gridSize = std::clamp(std::atoi(argv[++i]), ParticleMeshSolver::MIN_GRID,
+                                                              ParticleMeshSolver::MAX_GRID);
+        } else if (arg == "--pm-no-p3m") {
+            world.particleMesh.settings.p3m = false;
+        } else if (arg == "--pm-cic") {
+            world.particleMesh.settings.assignment = MeshAssignment::Cic;
+        } else if (arg == "--threads" && hasValue) {
+            world.setThreadCount(static_cast<unsigned>(std::max(1, std::atoi(argv[++i]))));
+        } else if (arg == "--kernel" && hasValue) {
+            const std::string kernel = argv[++i];
+            if (kernel == "simd") {
+                world.forceKernel = ForceKernel::Simd;
+            } else if (kernel == "scalar") {
+                world.forceKernel = ForceKernel::Scalar;
+            } else {
+                std::println(stderr, "Unknown force kernel: {}", kernel);
+                return 1;
+            }
+        } else if (arg == "--integrator" && hasValue) {
+            const std::string method = argv[++i];
+            bool found = false;
+            for (int k = 0; k < INTEGRATOR_COUNT; k++) {
+                if (method == IntegratorName(static_cast<Integrator>(k))) {
+                    world.integrator = static_cast<Integrator>(k);
+                    found = true;
+                }
+            }
+            if (!found) {
+                std::println(stderr, "Unknown integrator: {}", method);
+                return 1;
+            }
+        } else if (arg == "--energy") {
+            reportEnergy = true;
+        } else if (arg == "--check-allocations") {
+            checkAllocations = true;
+        } else if (arg == "--help" || arg == "-h") {
+            PrintUsage();
+            return 0;
+        } else {
+            std::println(stderr, "Unknown or incomplete argument: {}", arg);
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (scenePath.empty() == snapshotPath.empty() || steps < 0 || !(dt > 0.0f) ||
+        (checkpointEvery > 0 && saveSnapshotPath.empty())) {
+        PrintUsage();
+        return 1;
+    }
+
+    // 没有计数时不能报告0次分配，否则检查总会通过
+    if (checkAllocations && !HeapAllocationCountingEnabled()) {
+        std::println(stderr, "Error: --check-allocations needs a build with PHYSICS2D_COUNT_ALLOCATIONS=ON");
+        return 1;
+    }
+
+    std::string error;
+    if (!snapshotPath.empty()) {
+        // 快照中的求解器设置会覆盖命令行，续跑应与原来的运行一致
+        const auto loadStart = std::chrono::steady_clock::now();
+        if (!LoadSnapshot(world, snapshotPath, error)) {
+            std::println(stderr, "Error: {}", error);
+            return 1;
+        }
+        const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+        std::println("Loaded {} bodies at step {} in {:.1f} ms", world.bodies.size(), world.stepIndex, loadSeconds * 1e3);
+    } else if (!LoadScene(world, scenePath, error)) {
+        std::println(stderr, "Error: {}", error);
+        return 1;
+    }
+
+    // 能量在计时之外测量，O(N²)
+    const EnergyReport initialEnergy = reportEnergy
+        ? MeasureEnergy(world.bodies, world.gf, world.ef, world.fusedForces.softening) : EnergyReport {};
+
+    // 前一半步数用于预热（容器增长到稳定容量），只统计后一半world.step内的分配
+    const long long warmupSteps = steps / 2;
+    uint64_t steadyAllocations = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (long long s = 0; s < steps; s++) {
+        const uint64_t allocationsBefore = HeapAllocationCount();
+        world.step(dt);
+        if (s >= warmupSteps) steadyAllocations += HeapAllocationCount() - allocationsBefore;
+        if (checkpointEvery > 0 && (s + 1) % checkpointEvery == 0 && !SaveSnapshot(world, saveSnapshotPath)) {
+            std::println(stderr, "Error: cannot write {}", saveSnapshotPath);
+            return 1;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::println("{} bodies, {} steps in {:.3f} s ({:.1f} steps/s)",
+                 world.bodies.size(), steps, seconds, seconds > 0.0 ? steps / seconds : 0.0);
+    if (reportEnergy) {
+        const EnergyReport finalEnergy = MeasureEnergy(world.bodies, world.gf, world.ef, world.fusedForces.softening);
+        const double e0 = initialEnergy.total();
+        std::println("Energy ({}): {:.9g} -> {:.9g}, relative drift {:.3e}", IntegratorName(world.integrator), e0,
+                     finalEnergy.total(), e0 != 0.0 ? (finalEnergy.total() - e0) / std::abs(e0) : 0.0);
+    }
+    if (checkAllocations) {
+        std::println("{} heap allocations in the last {} steps", steadyAllocations, steps - warmupSteps);
+    }
+
+    if (!outPath.empty() && !SaveScene(world, outPath)) {
+        std::println(stderr, "Error: cannot write {}", outPath);
+        return 1;
+    }
+    if (!saveSnapshotPath.empty() && !SaveSnapshot(world, saveSnapshotPath)) {
+        std::println(stderr, "Error: cannot write {}", saveSnapshotPath);
+        return 1;
+    }
+    if (!tracePath.empty()) {
+#ifndef PHYSICS2D_PROFILE
+        std::println(stderr, "Warning: built without PHYSICS2D_PROFILE, the trace will be empty");
+#endif
+        if (!Profiler::instance().exportChromeTrace(tracePath)) {
+            std::println(stderr, "Error: cannot write {}", tracePath);
+            return 1;
+        }
+    }
+    if (checkAllocations && steadyAllocations > 0) {
+        return 3;
+    }
+    return 0;
+}
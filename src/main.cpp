@@ -9,8 +9,13 @@
 #include <memory>
 #include <iostream>
 #include <print>
-#include "../include/Circle.h"
-#include "../include/polygon.h"
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include "../include/SimulationThread.h"
+#include "../include/Renderer.h"
+#include "../include/Profiler.h"
+#include "../include/AllocationCounter.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
@@ -22,13 +27,17 @@
 #include "../Dependencies/cPhysics/include/cphysics.h"
 
 
-std::vector<std::unique_ptr<Object>> objList;
+// 世界只在模拟线程上步进；界面读取它发布的帧，修改经命令队列送过去
+SimulationThread simulation;
+WorldSettings settings;      // 界面编辑中的设置
+WorldSettings sentSettings;  // 已经作为命令发出的设置
+uint64_t seenRevision = 0;
+uint64_t seenLayoutRevision = 0;
+BodyTree pickTree;           // 在发布的物体副本上做鼠标拾取
 
 #ifdef _WIN32
 HICON g_windowIcon = NULL;
 #endif
-gravitational_field gf;
-electric_field ef;
 bool circleCreationMode = false;
 bool circleButtonPressed = false;
 bool mouseWasPressed = false;
@@ -44,61 +53,144 @@ float lastDragX = 0.0f;
 float lastDragY = 0.0f;
 bool showAboutWindow = false;
 
-void ApplyUniversalGravitation(std::vector<std::unique_ptr<Object>>& list) {
-    for (size_t i = 0; i < list.size(); i++) {
-        for (int j = i + 1; j < list.size(); j++) {
-            const float dx = list.at(j)->get_position_x() - list.at(i)->get_position_x();
-            const float dy = list.at(j)->get_position_y() - list.at(i)->get_position_y();
+char snapshotPath[260] = "world.snap";
+char journalPath[260] = "session.journal";
 
-            const float distance = sqrtf(dx * dx + dy * dy);
-            
-            if (distance < 0.001f) continue;
-            
-            float forceMagnitude = G * list[i]->get_mass() * list[j]->get_mass() / (distance * distance);
-            float fx = forceMagnitude * dx / distance;
-            float fy = forceMagnitude * dy / distance;
-            
-            if (list.at(i)->getMovementStatus()) {
-                list.at(i)->applyForce(fx, fy);
-            }
-            if (list.at(j)->getMovementStatus()) {
-                list.at(j)->applyForce(-fx, -fy);
+// 所有对物体的修改都经由命令执行，录制时写入日志，可在无界面模式下逐位重现。
+// 物体下标来自当前显示的帧，附上它的layoutRevision，之后物体被增删时模拟线程会丢弃这条命令
+void Submit(CommandType type, uint32_t body = 0, std::initializer_list<double> values = {}) {
+    WorldCommand command { type, body };
+    std::copy(values.begin(), values.end(), command.values);
+    simulation.submit(command, simulation.front().layoutRevision);
+}
+
+// 快照、日志与精度报告也在模拟线程上执行，结果随之后的帧发布
+void Request(SimulationRequest request, const char* path = "") {
+    SimulationCommand command { request };
+    std::snprintf(command.path, sizeof(command.path), "%s", path);
+    simulation.submit(command);
+}
+
+// 每帧界面中的临时数据从这里分配，帧末回收
+FrameArena uiArena;
+// 上一帧界面线程自己的分配数，以及同一时段其它线程（模拟线程与线程池）的分配数
+uint64_t lastFrameAllocations = 0;
+uint64_t lastFramePhysicsAllocations = 0;
+
+bool showProfilerWindow = false;
+char tracePath[260] = "frame.trace.json";
+std::string traceStatus;
+
+// 各段最近若干帧的耗时直方图，以及最近一帧按线程、嵌套层数排列的时间线
+void DrawProfilerWindow() {
+    ImGui::SetNextWindowSize(ImVec2(640, 560), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Frame Profiler", &showProfilerWindow)) {
+        ImGui::End();
+        return;
+    }
+#ifndef PHYSICS2D_PROFILE
+    ImGui::TextWrapped("Built without PHYSICS2D_PROFILE, no zones are recorded.");
+#endif
+
+    Profiler& profiler = Profiler::instance();
+    const size_t frames = profiler.frameCount();
+    if (frames == 0) {
+        ImGui::End();
+        return;
+    }
+
+    const Profiler::Frame& last = profiler.frame(0);
+    ImGui::Text("Frame: %.2f ms", static_cast<float>(last.end - last.start) * 1e-6f);
+    ImGui::SameLine();
+    ImGui::Checkbox("Freeze Timeline", &profiler.freeze);
+
+    ImGui::InputText("##TracePath", tracePath, sizeof(tracePath));
+    ImGui::SameLine();
+    if (ImGui::Button("Export Chrome Trace")) {
+        traceStatus = profiler.exportChromeTrace(tracePath) ? std::string("Wrote ") + tracePath
+                                                            : std::string("Cannot write ") + tracePath;
+    }
+    if (!traceStatus.empty()) {
+        ImGui::TextWrapped("%s", traceStatus.c_str());
+    }
+
+    if (ImGui::CollapsingHeader("Zone History", ImGuiTreeNodeFlags_DefaultOpen)) {
+        static std::vector<float> history;
+        for (size_t zone = 0; zone < profiler.zoneCount(); zone++) {
+            profiler.zoneHistory(zone, history);
+            float sum = 0.0f, peak = 0.0f;
+            for (float ms : history) {
+                sum += ms;
+                peak = std::max(peak, ms);
             }
+            char overlay[64];
+            std::snprintf(overlay, sizeof(overlay), "avg %.2f  max %.2f ms", sum / history.size(), peak);
+            ImGui::PlotHistogram(profiler.zoneName(zone), history.data(), static_cast<int>(history.size()), 0,
+                                 overlay, 0.0f, peak * 1.1f + 1e-3f, ImVec2(0, 36));
         }
     }
-}
 
-void ApplyCoulombForce(std::vector<std::unique_ptr<Object>>& list) {
-    for (size_t i = 0; i < list.size(); i++) {
-        for (size_t j = i + 1; j < list.size(); j++) {
-            if (list.at(i)->getMovementStatus()) {
-                list.at(i)->applyCoulombForce(*list[j]);
+    if (ImGui::CollapsingHeader("Timeline", ImGuiTreeNodeFlags_DefaultOpen)) {
+        const std::vector<Profiler::Event>& events = profiler.lastFrameEvents();
+        uint64_t begin = UINT64_MAX, end = 0;
+        uint32_t threads = 0;
+        for (const Profiler::Event& e : events) {
+            begin = std::min(begin, e.start);
+            end = std::max(end, e.end);
+            threads = std::max(threads, e.thread + 1);
+        }
+        // 每个线程占用的行数等于它的最大嵌套层数
+        std::pmr::vector<uint32_t> firstRow(threads + 1, 0, uiArena.resource());
+        for (const Profiler::Event& e : events) {
+            firstRow[e.thread + 1] = std::max(firstRow[e.thread + 1], e.depth + 1);
+        }
+        for (uint32_t t = 0; t < threads; t++) {
+            firstRow[t + 1] += firstRow[t];
+        }
+
+        const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float width = ImGui::GetContentRegionAvail().x;
+        const float scale = end > begin ? width / static_cast<float>(end - begin) : 0.0f;
+        ImDrawList* draw = ImGui::GetWindowDrawList();
+
+        for (const Profiler::Event& e : events) {
+            const float x0 = origin.x + static_cast<float>(e.start - begin) * scale;
+            const float x1 = std::max(x0 + 1.0f, origin.x + static_cast<float>(e.end - begin) * scale);
+            const float y0 = origin.y + (firstRow[e.thread] + e.depth) * rowHeight;
+            const ImVec2 min(x0, y0), max(x1, y0 + rowHeight - 1.0f);
+
+            const float hue = static_cast<float>(reinterpret_cast<uintptr_t>(e.name) % 97) / 97.0f;
+            draw->AddRectFilled(min, max, ImColor::HSV(hue, 0.55f, 0.75f));
+            if (x1 - x0 > ImGui::CalcTextSize(e.name).x + 4.0f) {
+                draw->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32_WHITE, e.name);
             }
-            if (list.at(j)->getMovementStatus()) {
-                list.at(j)->applyCoulombForce(*list[i]);
+            if (ImGui::IsMouseHoveringRect(min, max)) {
+                ImGui::SetTooltip("%s\n%.3f ms (thread %u)", e.name,
+                                  static_cast<float>(e.end - e.start) * 1e-6f, e.thread);
             }
         }
+        ImGui::Dummy(ImVec2(width, firstRow[threads] * rowHeight));
     }
+
+    ImGui::End();
 }
 
 int main(void)
 {
-    gf.magnitude = 9.8;
-    gf.direction[0] = 0.0;
-    gf.direction[1] = -1.0;
-    gf.direction[2] = 0.0;
-
-    ef.magnitude = 0.0;
-    ef.direction[0] = 1.0;
-    ef.direction[1] = 0.0;
-    ef.direction[2] = 0.0;
-
-
     if (!glfwInit())
         return -1;
 
 
 
+    // 实例化绘制需要OpenGL 3.3 core
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
     GLFWwindow *window = glfwCreateWindow(1920, 1200, "2D Physics", NULL, NULL);
     if (!window)
     {
@@ -134,6 +226,7 @@ int main(void)
     /* Make the window's context current */
     glfwMakeContextCurrent(window);
 
+    glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK) {
         std::println("Error");
     }
@@ -149,7 +242,7 @@ int main(void)
     ImGui::StyleColorsDark();
     
     ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 130");
+    ImGui_ImplOpenGL3_Init("#version 330");
 
     int width, height;
     glfwGetFramebufferSize(window, &width, &height);
@@ -157,21 +250,19 @@ int main(void)
     const float uiWidthPixels = 300.0f;
     const float simulationWidth = width - uiWidthPixels;
     glViewport(uiWidthPixels, 0, simulationWidth, height);
-    
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    float aspect = (float)simulationWidth / (float)height;
-    if (aspect > 1.0) {
-        glOrtho(-aspect, aspect, -1.0, 1.0, -1.0, 1.0);
-    } else {
-        glOrtho(-1.0, 1.0, -1.0/aspect, 1.0/aspect, -1.0, 1.0);
+
+    InstancedRenderer renderer;
+    if (!renderer.init()) {
+        std::println("Error: cannot create the instanced renderer");
     }
-    
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
+
+    // 模拟线程与界面线程各占一个核，线程池用其余的核
+    const unsigned hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    simulation.world.setThreadCount(std::max(1u, hardwareThreads - 1));
+    settings = sentSettings = ReadWorldSettings(simulation.world, 1.0f);
+    simulation.start(settings.timeScale);
 
     double lastTime = glfwGetTime();
-    float timeScale = 1.0f;
     bool vSyncEnabled = true;
     bool still = false;
     glfwSwapInterval(vSyncEnabled ? 1 : 0);
@@ -180,27 +271,41 @@ int main(void)
         const float uiWidthPixels = 300.0f;
         const float simulationWidth = width - uiWidthPixels;
         glViewport(uiWidthPixels, 0, simulationWidth, height);
-        
-        float aspect = (float)simulationWidth / (float)height;
-        glMatrixMode(GL_PROJECTION);
-        glLoadIdentity();
-        if (aspect > 1.0) {
-            glOrtho(-aspect, aspect, -1.0, 1.0, -1.0, 1.0);
-        } else {
-            glOrtho(-1.0, 1.0, -1.0/aspect, 1.0/aspect, -1.0, 1.0);
-        }
-        glMatrixMode(GL_MODELVIEW);
-        glLoadIdentity();
     });
 
     while (!glfwWindowShouldClose(window))
     {
+        const uint64_t frameAllocationStart = ThreadHeapAllocationCount();
+        const uint64_t processAllocationStart = HeapAllocationCount();
+        PROFILE_FRAME();
+
+        // 取模拟线程最新发布的一帧，没有新帧时沿用上一帧，不等待物理
+        if (simulation.acquire()) {
+            PROFILE_ZONE("Upload");
+            renderer.upload(simulation.front());
+        }
+        const SimulationFrame& frame = simulation.front();
+        if (frame.revision != seenRevision) {
+            // 读取了快照：设置以新世界为准，物体编号已全部改变，取消正在进行的拖拽
+            seenRevision = frame.revision;
+            settings = sentSettings = frame.settings;
+            isDragging = false;
+            draggedObjectIndex = -1;
+        }
+        if (frame.layoutRevision != seenLayoutRevision) {
+            // 物体被增删，拖拽中的下标可能已指向另一个物体
+            seenLayoutRevision = frame.layoutRevision;
+            isDragging = false;
+            draggedObjectIndex = -1;
+        }
+
+        PROFILE_ZONE_BEGIN(uiZone, "UI");
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
         
         double currentTime = glfwGetTime();
-        float deltaTime = static_cast<float>(currentTime - lastTime) * timeScale;
+        float deltaTime = static_cast<float>(currentTime - lastTime) * settings.timeScale;
         lastTime = currentTime;
         
         const float uiWidth = 300.0f;
@@ -215,16 +320,16 @@ int main(void)
         
         if (ImGui::CollapsingHeader("Gravity Field", ImGuiTreeNodeFlags_DefaultOpen)) {
             // 临时变量用于ImGui SliderFloat
-            float tempMagnitude = static_cast<float>(gf.magnitude);
-            ImGui::Text("Magnitude: %.2f m/s²", gf.magnitude);
+            float tempMagnitude = static_cast<float>(settings.gravity[0]);
+            ImGui::Text("Magnitude: %.2f m/s²", settings.gravity[0]);
             if (ImGui::SliderFloat("##GravityMagnitude", &tempMagnitude, 0.0f, 20.0f, "%.2f")) {
-                gf.magnitude = static_cast<double>(tempMagnitude);
+                settings.gravity[0] = static_cast<double>(tempMagnitude);
             }
             
             // 计算方向角度以便显示
             float directionAngle = 0.0f;
-            if (gf.direction[0] != 0.0f || gf.direction[1] != 0.0f) {
-                directionAngle = atan2f(gf.direction[1], gf.direction[0]) * 180.0f / PI;
+            if (settings.gravity[1] != 0.0f || settings.gravity[2] != 0.0f) {
+                directionAngle = atan2f(settings.gravity[2], settings.gravity[1]) * 180.0f / PI;
                 if (directionAngle < 0) directionAngle += 360.0f;
             }
             ImGui::Text("Direction: %.1f°", directionAngle);
@@ -233,9 +338,8 @@ int main(void)
             static float tempDirectionAngle = directionAngle;
             if (ImGui::SliderFloat("##GravityDirection", &tempDirectionAngle, 0.0f, 360.0f, "%.1f°")) {
                 float angleRad = tempDirectionAngle * PI / 180.0f;
-                gf.direction[0] = cosf(angleRad);
-                gf.direction[1] = sinf(angleRad);
-                gf.direction[2] = 0.0f;
+                settings.gravity[1] = cosf(angleRad);
+                settings.gravity[2] = sinf(angleRad);
             }
             
             ImGui::Text("Direction Reference:");
@@ -246,52 +350,47 @@ int main(void)
             
             ImGui::Text("Quick Direction:");
             if (ImGui::Button("Up##1")) { 
-                gf.direction[0] = 0.0f; 
-                gf.direction[1] = 1.0f; 
-                gf.direction[2] = 0.0f; 
+                settings.gravity[1] = 0.0f; 
+                settings.gravity[2] = 1.0f; 
             } ImGui::SameLine();
             if (ImGui::Button("Down##1")) { 
-                gf.direction[0] = 0.0f; 
-                gf.direction[1] = -1.0f; 
-                gf.direction[2] = 0.0f; 
+                settings.gravity[1] = 0.0f; 
+                settings.gravity[2] = -1.0f; 
             } ImGui::SameLine();
             if (ImGui::Button("Left##1")) { 
-                gf.direction[0] = -1.0f; 
-                gf.direction[1] = 0.0f; 
-                gf.direction[2] = 0.0f; 
+                settings.gravity[1] = -1.0f; 
+                settings.gravity[2] = 0.0f; 
             } ImGui::SameLine();
             if (ImGui::Button("Right##1")) { 
-                gf.direction[0] = 1.0f; 
-                gf.direction[1] = 0.0f; 
-                gf.direction[2] = 0.0f; 
+                settings.gravity[1] = 1.0f; 
+                settings.gravity[2] = 0.0f; 
             }
             
             ImGui::Text("Presets:");
             if (ImGui::Button("Zero Gravity")) {
-                gf.magnitude = 0.0f;
+                settings.gravity[0] = 0.0f;
             }
             ImGui::SameLine();
             if (ImGui::Button("Earth Gravity")) {
-                gf.magnitude = 9.8f;
-                gf.direction[0] = 0.0f;
-                gf.direction[1] = -1.0f;
-                gf.direction[2] = 0.0f;
+                settings.gravity[0] = 9.8f;
+                settings.gravity[1] = 0.0f;
+                settings.gravity[2] = -1.0f;
             }
         }
 
 
         if (ImGui::CollapsingHeader("Electric Field", ImGuiTreeNodeFlags_DefaultOpen)) {
             // 临时变量用于ImGui SliderFloat
-            float tempMagnitude = static_cast<float>(ef.magnitude);
-            ImGui::Text("Magnitude: %.2f N/C", ef.magnitude);
+            float tempMagnitude = static_cast<float>(settings.electric[0]);
+            ImGui::Text("Magnitude: %.2f N/C", settings.electric[0]);
             if (ImGui::SliderFloat("##ElectricMagnitude", &tempMagnitude, 0.0f, 20.0f, "%.2f")) {
-                ef.magnitude = static_cast<double>(tempMagnitude);
+                settings.electric[0] = static_cast<double>(tempMagnitude);
             }
 
 
             float directionAngle = 0.0f;
-            if (ef.direction[0] != 0.0f || ef.direction[1] != 0.0f) {
-                directionAngle = atan2f(ef.direction[1], ef.direction[0]) * 180.0f / PI;
+            if (settings.electric[1] != 0.0f || settings.electric[2] != 0.0f) {
+                directionAngle = atan2f(settings.electric[2], settings.electric[1]) * 180.0f / PI;
                 if (directionAngle < 0) directionAngle += 360.0f;
             }
             ImGui::Text("Direction: %.1f°", directionAngle);
@@ -300,80 +399,238 @@ int main(void)
             static float tempDirectionAngle = directionAngle;
             if (ImGui::SliderFloat("##ElectricFieldDirection", &tempDirectionAngle, 0.0f, 360.0f, "%.1f°")) {
                 float angleRad = tempDirectionAngle * PI / 180.0f;
-                ef.direction[0] = cosf(angleRad);
-                ef.direction[1] = sinf(angleRad);
-                ef.direction[2] = 0.0f;
+                settings.electric[1] = cosf(angleRad);
+                settings.electric[2] = sinf(angleRad);
             }
 
             ImGui::Text("Quick Direction:");
             if (ImGui::Button("Up##2")) { 
-                ef.direction[0] = 0.0f; 
-                ef.direction[1] = 1.0f; 
-                ef.direction[2] = 0.0f; 
+                settings.electric[1] = 0.0f; 
+                settings.electric[2] = 1.0f; 
             } ImGui::SameLine();
             if (ImGui::Button("Down##2")) { 
-                ef.direction[0] = 0.0f; 
-                ef.direction[1] = -1.0f; 
-                ef.direction[2] = 0.0f; 
+                settings.electric[1] = 0.0f; 
+                settings.electric[2] = -1.0f; 
             } ImGui::SameLine();
             if (ImGui::Button("Left##2")) { 
-                ef.direction[0] = -1.0f; 
-                ef.direction[1] = 0.0f; 
-                ef.direction[2] = 0.0f; 
+                settings.electric[1] = -1.0f; 
+                settings.electric[2] = 0.0f; 
             } ImGui::SameLine();
             if (ImGui::Button("Right##2")) { 
-                ef.direction[0] = 1.0f; 
-                ef.direction[1] = 0.0f; 
-                ef.direction[2] = 0.0f; 
+                settings.electric[1] = 1.0f; 
+                settings.electric[2] = 0.0f; 
             }
 
 
             ImGui::Text("Presets:");
             if (ImGui::Button("Zero Electric Field")) {
-                ef.magnitude = 0.0f;
+                settings.electric[0] = 0.0f;
             }
         }
 
 
 
         if (ImGui::CollapsingHeader("Object", ImGuiTreeNodeFlags_DefaultOpen)) {
-            if (ImGui::Button("Delete all objects")) { objList.erase(objList.begin(),objList.end()); }
-            ImGui::Text("Total Objects: %zu", objList.size());
+            if (ImGui::Button("Delete all objects")) { Submit(CommandType::ClearWorld); }
+            ImGui::Text("Total Objects: %zu", frame.bodies.size());
             
-            for (size_t i = 0; i < objList.size(); ++i) {
+            // 控件ID用PushID区分每一行，不再为每个标签拼接字符串
+            for (size_t i = 0; i < frame.bodies.size(); ++i) {
+                ImGui::PushID(static_cast<int>(i));
                 ImGui::Text("Obj %zu:", i + 1);
                 ImGui::SameLine();
                 
-                float currentMass = objList.at(i)->get_mass();
-                std::string massLabel = "##Mass" + std::to_string(i);
+                float currentMass = frame.bodies.mass[i];
                 ImGui::SetNextItemWidth(85.0f);
-                if (ImGui::DragFloat(massLabel.c_str(), &currentMass, 0.1f, 0.1f, 100.0f, "%.2f kg")) {
-                    objList[i]->setMass(currentMass);
+                if (ImGui::DragFloat("##Mass", &currentMass, 0.1f, 0.1f, 100.0f, "%.2f kg")) {
+                    Submit(CommandType::SetMass, static_cast<uint32_t>(i), { currentMass });
                 }
                 ImGui::SameLine();
-                float currentCharge = objList.at(i)->get_charge();
-                std::string chargeLabel = "##Charge" + std::to_string(i);
+                float currentCharge = frame.bodies.charge[i];
                 ImGui::SetNextItemWidth(80.0f);
-                if (ImGui::DragFloat(chargeLabel.c_str(), &currentCharge, 0.1f, 0.1f, 100.0f, "%.2f C")) {
-                    objList[i]->setCharge(currentCharge);
+                if (ImGui::DragFloat("##Charge", &currentCharge, 0.1f, 0.1f, 100.0f, "%.2f C")) {
+                    Submit(CommandType::SetCharge, static_cast<uint32_t>(i), { currentCharge });
                 }
 
 
                 ImGui::SameLine();
                 
-                std::string deleteButtonLabel = "X##" + std::to_string(i);
-                if (ImGui::Button(deleteButtonLabel.c_str())) {
-                    objList.erase(objList.begin() + i);
+                const bool deleteClicked = ImGui::Button("X");
+                ImGui::PopID();
+                if (deleteClicked) {
+                    Submit(CommandType::RemoveObject, static_cast<uint32_t>(i));
                     break;
                 }
             }
         }
         
+        if (ImGui::CollapsingHeader("Snapshot")) {
+            ImGui::Text("File:");
+            ImGui::InputText("##SnapshotPath", snapshotPath, sizeof(snapshotPath));
+            if (ImGui::Button("Save Snapshot")) {
+                Request(SimulationRequest::SaveSnapshot, snapshotPath);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Load Snapshot")) {
+                Request(SimulationRequest::LoadSnapshot, snapshotPath);
+            }
+            if (frame.snapshotStatus[0]) {
+                ImGui::TextWrapped("%s", frame.snapshotStatus);
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Replay Journal")) {
+            ImGui::Text("File:");
+            ImGui::InputText("##JournalPath", journalPath, sizeof(journalPath));
+            if (!frame.recording) {
+                if (ImGui::Button("Start Recording")) {
+                    Request(SimulationRequest::StartRecording);
+                }
+            } else {
+                ImGui::Text("Recording: %zu commands", frame.journalCommands);
+                if (ImGui::Button("Stop and Save")) {
+                    Request(SimulationRequest::StopRecording, journalPath);
+                }
+            }
+            if (frame.journalStatus[0]) {
+                ImGui::TextWrapped("%s", frame.journalStatus);
+            }
+        }
+
         if (ImGui::CollapsingHeader("Simulation Info")) {
             ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
             ImGui::Text("Delta Time: %.3f s", deltaTime);
-            ImGui::Text("Time Scale: %.2fx", timeScale);
-            ImGui::SliderFloat("##TimeScale", &timeScale, 0.0f, 2.0f, "%.2fx");
+
+            float stepRate = 1.0f / settings.fixedDeltaTime;
+            ImGui::Text("Fixed Step: %.1f Hz (%d steps, alpha %.2f)", stepRate, frame.lastSteps, frame.alpha);
+            if (ImGui::SliderFloat("##StepRate", &stepRate, 30.0f, 480.0f, "%.0f Hz")) {
+                settings.fixedDeltaTime = std::max(1.0f / stepRate, 1e-5f);
+            }
+            ImGui::Text("Max Substeps:");
+            ImGui::SliderInt("##MaxSubsteps", &settings.maxSubsteps, 1, 32);
+            const char* integratorNames[] = { "Semi-Implicit Euler", "Leapfrog (Verlet)", "Yoshida 4th Order", "RK4" };
+            int integratorIndex = static_cast<int>(settings.integrator);
+            ImGui::Text("Integrator: (%d force evaluations/step)", IntegratorStages(frame.settings.integrator));
+            if (ImGui::Combo("##Integrator", &integratorIndex, integratorNames, IM_ARRAYSIZE(integratorNames))) {
+                settings.integrator = static_cast<Integrator>(integratorIndex);
+            }
+            ImGui::Text("Physics Thread: step %llu, %.2f ms/step", static_cast<unsigned long long>(frame.stepIndex),
+                        frame.stepMilliseconds);
+            ImGui::Text("Dropped Time: %.2f s", frame.droppedTime);
+            ImGui::Text("Time Scale: %.2fx", settings.timeScale);
+            const char* broadphaseNames[] = { "Brute Force", "Spatial Hash", "Sweep and Prune", "AABB Tree" };
+            int broadphaseIndex = static_cast<int>(settings.broadphase);
+            ImGui::Text("Broadphase:");
+            if (ImGui::Combo("##Broadphase", &broadphaseIndex, broadphaseNames, IM_ARRAYSIZE(broadphaseNames))) {
+                settings.broadphase = static_cast<BroadphaseType>(broadphaseIndex);
+            }
+            ImGui::Text("%zu pairs from %zu box tests", frame.pairs, frame.broadphaseStats.tests);
+            if (frame.settings.broadphase == BroadphaseType::SweepAndPrune) {
+                ImGui::Text("Sort: %zu moves", frame.broadphaseStats.swaps);
+            } else if (frame.settings.broadphase == BroadphaseType::AabbTree) {
+                ImGui::Text("Tree: height %d, %zu reinserted", frame.treeHeight, frame.broadphaseStats.reinserts);
+            }
+            if (HeapAllocationCountingEnabled()) {
+                ImGui::Text("Heap Allocations: %llu UI, %llu physics last frame",
+                            static_cast<unsigned long long>(lastFrameAllocations),
+                            static_cast<unsigned long long>(lastFramePhysicsAllocations));
+            }
+            ImGui::Text("Step Arena: %zu B used, %zu KB reserved", frame.arenaBytes, frame.arenaCapacity / 1024);
+            ImGui::Text("Sleeping: %zu / %zu (%zu islands)", frame.sleeping, frame.bodies.size(), frame.islands);
+            ImGui::Checkbox("Allow Sleeping", &settings.sleep.enabled);
+            if (settings.sleep.enabled) {
+                ImGui::SliderFloat("##SleepThreshold", &settings.sleep.velocityThreshold, 0.001f, 0.2f, "rest below %.3f");
+                ImGui::SliderFloat("##SleepTime", &settings.sleep.timeToSleep, 0.1f, 3.0f, "sleep after %.1f s");
+            }
+
+            ContactSolverSettings& solver = settings.contactSolver;
+            ImGui::Checkbox("Contact Solver", &solver.enabled);
+            if (solver.enabled) {
+                ImGui::Text("Contacts: %zu", frame.contacts);
+                ImGui::SliderInt("##SolverIterations", &solver.iterations, 1, 50, "%d iterations");
+                const char* correctionNames[] = { "Baumgarte", "Split Impulse" };
+                int correctionIndex = static_cast<int>(solver.correction);
+                if (ImGui::Combo("##PositionCorrection", &correctionIndex, correctionNames, IM_ARRAYSIZE(correctionNames))) {
+                    solver.correction = static_cast<PositionCorrection>(correctionIndex);
+                }
+                ImGui::SliderFloat("##Restitution", &solver.restitution, 0.0f, 1.0f, "restitution %.2f");
+                ImGui::Checkbox("Warm Starting", &solver.warmStarting);
+            }
+            ImGui::Checkbox("Continuous Collision", &settings.continuous.enabled);
+            if (settings.continuous.enabled) {
+                ImGui::Text("Swept: %zu fast bodies, %zu impacts", frame.fastBodies, frame.impacts);
+                ImGui::SliderFloat("##CcdThreshold", &settings.continuous.motionThreshold, 0.1f, 2.0f,
+                                   "sweep above %.2f radii/step");
+            }
+            if (ImGui::Button("Frame Profiler")) {
+                showProfilerWindow = true;
+            }
+            ImGui::SliderFloat("##TimeScale", &settings.timeScale, 0.0f, 2.0f, "%.2fx");
+
+            const char* solverNames[] = { "Exact Pairwise", "Barnes-Hut", "FMM (Gravity + Coulomb)", "PM / P3M (Gravity + Coulomb)" };
+            int solverIndex = static_cast<int>(settings.gravitySolver);
+            ImGui::Text("Gravity Solver:");
+            if (ImGui::Combo("##GravitySolver", &solverIndex, solverNames, IM_ARRAYSIZE(solverNames))) {
+                settings.gravitySolver = static_cast<GravitySolver>(solverIndex);
+            }
+            const char* kernelNames[] = { "Scalar", "SIMD" };
+            int kernelIndex = static_cast<int>(settings.forceKernel);
+            ImGui::Text("Force Kernel: (%s)", SimdLevelName(frame.simdLevel));
+            if (ImGui::Combo("##ForceKernel", &kernelIndex, kernelNames, IM_ARRAYSIZE(kernelNames))) {
+                settings.forceKernel = static_cast<ForceKernel>(kernelIndex);
+            }
+            int threadCount = static_cast<int>(settings.threadCount);
+            ImGui::Text("Worker Threads: (%llu stolen)", static_cast<unsigned long long>(frame.steals));
+            if (ImGui::SliderInt("##WorkerThreads", &threadCount, 1, static_cast<int>(hardwareThreads))) {
+                settings.threadCount = static_cast<unsigned>(threadCount);
+            }
+            if (settings.gravitySolver == GravitySolver::BarnesHut) {
+                ImGui::Text("Opening Angle: %.2f", settings.barnesHutTheta);
+                ImGui::SliderFloat("##BarnesHutTheta", &settings.barnesHutTheta, 0.1f, 1.5f, "%.2f");
+                ImGui::Text("Tree Nodes: %zu", frame.quadTreeNodes);
+            }
+            if (settings.gravitySolver == GravitySolver::Fmm) {
+                FmmSettings& fmm = settings.fmm;
+                ImGui::Text("Expansion Order: %d", fmm.order);
+                ImGui::SliderInt("##FmmOrder", &fmm.order, 1, FmmSolver::MAX_ORDER);
+                ImGui::Text("Separation θ: %.2f", fmm.theta);
+                ImGui::SliderFloat("##FmmTheta", &fmm.theta, 0.2f, 0.9f, "%.2f");
+                ImGui::Text("Leaf Capacity:");
+                ImGui::SliderInt("##FmmLeaf", &fmm.leafCapacity, 1, 128);
+                ImGui::Checkbox("Adaptive Tree", &fmm.adaptive);
+                ImGui::Text("%zu cells, depth %d, %zu far / %zu near", frame.fmmNodes, frame.fmmDepth,
+                            frame.fmmFarPairs, frame.fmmNearPairs);
+            }
+            if (settings.gravitySolver == GravitySolver::ParticleMesh) {
+                ParticleMeshSettings& mesh = settings.particleMesh;
+                const char* gridNames[] = { "32", "64", "128", "256", "512", "1024" };
+                int gridIndex = 0;
+                while (gridIndex + 1 < IM_ARRAYSIZE(gridNames) && (ParticleMeshSolver::MIN_GRID << gridIndex) < mesh.gridSize) {
+                    gridIndex++;
+                }
+                ImGui::Text("Mesh Cells per Side:");
+                if (ImGui::Combo("##PmGrid", &gridIndex, gridNames, IM_ARRAYSIZE(gridNames))) {
+                    mesh.gridSize = ParticleMeshSolver::MIN_GRID << gridIndex;
+                }
+                const char* assignmentNames[] = { "TSC", "CIC" };
+                int assignmentIndex = static_cast<int>(mesh.assignment);
+                ImGui::Text("Mesh Assignment:");
+                if (ImGui::Combo("##PmAssignment", &assignmentIndex, assignmentNames, IM_ARRAYSIZE(assignmentNames))) {
+                    mesh.assignment = static_cast<MeshAssignment>(assignmentIndex);
+                }
+                ImGui::Checkbox("Short-Range Correction (P3M)", &mesh.p3m);
+                ImGui::Text("Split Scale: %.2f cells", mesh.splitCells);
+                ImGui::SliderFloat("##PmSplit", &mesh.splitCells, 0.5f, 4.0f, "%.2f");
+                ImGui::Text("cell %.4g, cutoff %.4g, %zu direct pairs", frame.meshCell, frame.meshCutoff, frame.meshPairs);
+            }
+            if (ImGui::Button("Gravity Accuracy Report")) {
+                Request(SimulationRequest::AccuracyReport);
+            }
+            for (size_t r = 0; r < frame.reportCount; r++) {
+                const GravityAccuracyReport& report = frame.reports[r];
+                ImGui::Text("θ=%.2f  rms %.2e  max %.2e  %.2f ms", report.theta,
+                            report.rmsRelativeError, report.maxRelativeError, report.treeMilliseconds);
+            }
 
 
             ImGui::Checkbox("Vertical Sync", &vSyncEnabled);
@@ -484,7 +741,11 @@ int main(void)
             
             ImGui::End();
         }
-        
+
+        if (showProfilerWindow) {
+            DrawProfilerWindow();
+        }
+        PROFILE_ZONE_END(uiZone);
 
 
         glClear(GL_COLOR_BUFFER_BIT);
@@ -496,48 +757,36 @@ int main(void)
         const float currentSimulationWidth = currentWidth - uiWidthPixels;
         float currentAspect = (float)currentSimulationWidth / (float)currentHeight;
         
-        if (!objList.empty()) {
-            ApplyUniversalGravitation(objList);
-            ApplyCoulombForce(objList);
+        // 本帧改动的设置作为命令发给模拟线程
+        settings.aspect = currentAspect;
+        WorldCommand changes[MAX_SETTINGS_COMMANDS];
+        const size_t changeCount = DiffWorldSettings(sentSettings, settings, changes);
+        for (size_t i = 0; i < changeCount; i++) {
+            simulation.submit(changes[i], frame.layoutRevision);
         }
-        
-        for (int i = 0; i < objList.size(); i++) {
-            if (objList.at(i)->getMovementStatus()) {
+        sentSettings = settings;
 
-                apply_gravitational_field(&objList.at(i)->getEntity(), &gf);
-                
-                if (ef.magnitude > 0.0f) {
-                    apply_electric_field(&objList.at(i)->getEntity(), &ef);
-                }
-                
-                objList.at(i)->update(deltaTime, gf, currentAspect);
-                
-                if (ef.magnitude > 0.0f) {
-                    Circle* circle = dynamic_cast<Circle*>(objList.at(i).get());
-                    if (circle) {
-                        circle->update(deltaTime, ef, currentAspect);
-                    }
-                }
-            }
+        // 从发布时刻按时间缩放外推插值系数，帧率与步频无关
+        const float alpha = std::clamp(frame.alpha + static_cast<float>((SimulationThread::now() - frame.publishTime) *
+                                                                        frame.settings.timeScale / frame.settings.fixedDeltaTime),
+                                       0.0f, 1.0f);
+
+        {
+            PROFILE_ZONE("Draw");
+            renderer.setAspect(currentAspect);
+            renderer.draw(alpha);
         }
-        for (size_t j = 0; j < objList.size(); j++) {
-            for (size_t k = j + 1; k < objList.size(); k++) {
-                if (objList.at(j)->checkCollision(*objList[k])) {
-                    objList.at(j)->resolveCollision(*objList[k]);
-                }
-            }
+        {
+            PROFILE_ZONE("ImGui Render");
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         }
-
-
-        for (size_t k = 0; k < objList.size(); k ++) {
-            objList.at(k)->draw();
+        {
+            PROFILE_ZONE("Swap");
+            glfwSwapBuffers(window);
         }
 
-
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        
-        glfwSwapBuffers(window);
+        PROFILE_ZONE_BEGIN(inputZone, "Input");
 
         if (!circleCreationMode) {
             const int mouseState = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT);
@@ -564,27 +813,23 @@ int main(void)
                 }
             
             if (mouseState == GLFW_PRESS && !isDragging) {
-                for (size_t i = 0; i < objList.size(); ++i) {
-                    const float dx = glX - objList.at(i)->get_position_x();
-                    const float dy = glY - objList.at(i)->get_position_y();
-                    float distance = sqrt(dx*dx + dy*dy);
-                    
-                    if (distance < 0.1f) {
-                        isDragging = true;
-                        draggedObjectIndex = i;
-                        dragOffsetX = dx;
-                        dragOffsetY = dy;
-                        objList.at(i)->setVelocity(0.0f, 0.0f);
-                        break;
-                    }
+                // 通过AABB树拾取离鼠标最近的物体，小物体在边界外一点也能抓住
+                pickTree.update(frame.bodies);
+                const int picked = pickTree.pick(frame.bodies, glX, glY, 0.02f);
+                if (picked >= 0) {
+                    isDragging = true;
+                    draggedObjectIndex = picked;
+                    dragOffsetX = glX - frame.bodies.x[picked];
+                    dragOffsetY = glY - frame.bodies.y[picked];
+                    Submit(CommandType::SetVelocity, static_cast<uint32_t>(picked), { 0.0, 0.0 });
                 }
             }
             else if (mouseState == GLFW_PRESS && isDragging && draggedObjectIndex != -1) {
                 float newX = glX - dragOffsetX;
                 float newY = glY - dragOffsetY;
                 
-                objList.at(draggedObjectIndex)->setPosition(newX, newY);
-                objList.at(draggedObjectIndex)->setVelocity(0.0f, 0.0f);
+                Submit(CommandType::SetPosition, draggedObjectIndex, { newX, newY });
+                Submit(CommandType::SetVelocity, draggedObjectIndex, { 0.0, 0.0 });
                 
                 // 只在鼠标实际移动时更新位置和时间
                 float distanceMoved = sqrt(pow(newX - lastDragX, 2) + pow(newY - lastDragY, 2));
@@ -613,15 +858,15 @@ int main(void)
                         velocityX = std::clamp(velocityX, -maxVelocity, maxVelocity);
                         velocityY = std::clamp(velocityY, -maxVelocity, maxVelocity);
                         
-                        objList.at(draggedObjectIndex)->setVelocity(velocityX, velocityY);
+                        Submit(CommandType::SetVelocity, draggedObjectIndex, { velocityX, velocityY });
                     } else {
                         // 如果只是简单点击释放，保持速度为0
-                        objList.at(draggedObjectIndex)->setVelocity(0.0f, 0.0f);
+                        Submit(CommandType::SetVelocity, draggedObjectIndex, { 0.0, 0.0 });
                     }
                 } else {
                     // 如果时间差太小，说明是简单点击，保持速度为0
                     if (draggedObjectIndex != -1) {
-                        objList.at(draggedObjectIndex)->setVelocity(0.0f, 0.0f);
+                        Submit(CommandType::SetVelocity, draggedObjectIndex, { 0.0, 0.0 });
                     }
                 }
                 
@@ -657,9 +902,7 @@ int main(void)
                     glX = adjustedMouseX / simulationWidth * 2.0f - 1.0f;
                     glY = (1.0f - mouseY / windowHeight * 2.0f) / currentAspect;
                 }
-                    objList.emplace_back(std::make_unique<Circle>(glX, glY, newCircleRadius, 100, still));
-                    objList.back()->setMass(newCircleMass);
-                    objList.back()->setCharge(newCircleCharge);
+                    Submit(CommandType::AddCircle, 100, { glX, glY, newCircleRadius, newCircleMass, newCircleCharge, still ? 1.0 : 0.0 });
                 }
             }
             
@@ -669,8 +912,15 @@ int main(void)
         }
 
         glfwPollEvents();
+        PROFILE_ZONE_END(inputZone);
+
+        uiArena.reset();
+        lastFrameAllocations = ThreadHeapAllocationCount() - frameAllocationStart;
+        lastFramePhysicsAllocations = HeapAllocationCount() - processAllocationStart - lastFrameAllocations;
     }
 
+    simulation.stop();
+    renderer.release();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();